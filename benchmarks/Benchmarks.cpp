@@ -33,4 +33,54 @@ TEST_CASE ("Boot performance")
             return plugin.getActiveEditor();
         });
     };
+
+    BENCHMARK_ADVANCED ("Time to first frame")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        // Processor and editor construction, up to the first completed paint (into an
+        // offscreen image). Teardown isn't measured, so everything is kept until the end.
+        std::vector<std::unique_ptr<ProgrammerProcessor>> plugins (size_t (meter.runs()));
+        std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors (size_t (meter.runs()));
+
+        meter.measure ([&] (int i) {
+            auto& plugin = plugins[(size_t) i];
+            auto& editor = editors[(size_t) i];
+            plugin = std::make_unique<ProgrammerProcessor>();
+            editor.reset (plugin->createEditorIfNeeded());
+            return editor->createComponentSnapshot (editor->getLocalBounds(), true, 1.0f);
+        });
+
+        for (size_t i = 0; i < plugins.size(); ++i)
+        {
+            plugins[i]->editorBeingDeleted (editors[i].get());
+            editors[i].reset();
+            plugins[i].reset();
+        }
+    };
+}
+
+TEST_CASE ("Virtual time performance")
+{
+    BENCHMARK_ADVANCED ("One minute of editor ticks and audio blocks in virtual time")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        ProgrammerProcessor plugin;
+        auto scheduler = std::make_unique<VirtualScheduler>();
+        auto& virtualTime = *scheduler;
+        plugin.setScheduler (std::move (scheduler));
+        ProgrammerEditor editor (plugin);
+
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        plugin.prepareToPlay (48000, 512);
+        virtualTime.callEvery (512.0 * 1000.0 / 48000.0, [&] {
+            plugin.processBlock (buffer, midiBuffer);
+            midiBuffer.clear();
+        });
+
+        meter.measure ([&] {
+            virtualTime.advance (60.0 * 1000.0);
+            return virtualTime.getTimeMs();
+        });
+    };
 }
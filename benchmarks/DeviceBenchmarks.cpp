@@ -0,0 +1,70 @@
+#include "../tests/helpers/test_helpers.h"
+#include "PluginProcessor.h"
+#include "ZeroCoastSimulator.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE ("0-Coast wire time")
+{
+    // Simulated time on the wire, not CPU time, so these are reported instead of benchmarked
+    SECTION ("Full program sync")
+    {
+        for (const auto useRunningStatus : { true, false })
+        {
+            ZeroCoastSimulator::Config config;
+            config.useRunningStatus = useRunningStatus;
+            ZeroCoastSimulator device (config);
+            device.processBlock (makeProgramBurst (makeSweepProgramState (1)), 512, 48000);
+            device.flush();
+
+            WARN ("Full program sync " << (useRunningStatus ? "with" : "without") << " running status: "
+                                       << device.getNumBytesReceived() << " bytes, " << device.getLastByteTimeMs() << " ms");
+        }
+    }
+
+    SECTION ("Program morph")
+    {
+        // One bar at 120 bpm (2 seconds), as processBlock sends it, plus a second to settle
+        ProgrammerProcessor plugin;
+        plugin.prepareToPlay (48000, 512);
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        ZeroCoastSimulator device;
+
+        auto to = ProgramState::defaults();
+        for (size_t i = 0; i < numParameters; ++i)
+            to[i] = static_cast<uint8_t> (parameterDefinitions[i].maxValue);
+        plugin.startMorph (ProgramState::defaults(), to, 1.0);
+
+        for (int block = 0; block < 3 * 48000 / 512; ++block)
+        {
+            plugin.processBlock (buffer, midiBuffer);
+            device.processBlock (midiBuffer, 512, 48000);
+            midiBuffer.clear();
+        }
+        device.flush();
+
+        const auto lineUsage = static_cast<double> (device.getNumBytesReceived()) * ZeroCoastSimulator::byteTimeMs / 2000.0;
+        WARN ("One bar morph: " << device.getNumCcsApplied() << " CCs, " << device.getNumBytesReceived() << " bytes, "
+                                << juce::roundToInt (lineUsage * 100.0) << "% of the line during the morph");
+        CHECK (device.getState() == to);
+    }
+}
+
+TEST_CASE ("0-Coast simulator performance")
+{
+    BENCHMARK_ADVANCED ("1000 program syncs through the simulator")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<juce::MidiBuffer> bursts;
+        for (int i = 0; i < 16; ++i)
+            bursts.push_back (makeProgramBurst (makeSweepProgramState (i)));
+
+        meter.measure ([&] {
+            ZeroCoastSimulator device;
+            for (size_t i = 0; i < 1000; ++i)
+                device.processBlock (bursts[i % bursts.size()], 960, 48000); // 20ms, one sync fits
+            return device.getNumCcsApplied();
+        });
+    };
+}
@@ -0,0 +1,52 @@
+#include "BackgroundExecutor.h"
+#include "PresetSimilarity.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE ("Background executor performance")
+{
+    // 1M presets with the scalar kernel, in 256 chunks: a CPU bound job big enough
+    // for the thread overhead not to matter
+    std::vector<ProgramState> library (1000000, ProgramState::defaults());
+    for (size_t i = 0; i < library.size(); ++i)
+        library[i][i % numParameters] = static_cast<uint8_t> (i % 128);
+    const auto target = ProgramState::defaults();
+    const auto weights = PresetSimilarity::getDefaultWeights();
+    std::vector<uint32_t> distances (library.size());
+
+    constexpr size_t numChunks = 256;
+    const auto chunkSize = library.size() / numChunks;
+
+    // Mean time should drop with the number of threads, until the cores run out.
+    // The calling thread helps too, so "1 thread" runs on two.
+    const auto numCpus = juce::SystemStats::getNumCpus();
+    for (int numThreads = 1; numThreads <= numCpus; numThreads *= 2)
+    {
+        BackgroundExecutor executor (numThreads);
+        BENCHMARK ("Scan 1M presets in " + std::to_string (numChunks) + " chunks, " + std::to_string (numThreads) + " threads")
+        {
+            executor.parallelFor (numChunks, [&] (size_t chunk) {
+                const auto start = chunk * chunkSize;
+                PresetSimilarity::computeDistances (library.data() + start, chunkSize, target, weights, distances.data() + start, PresetSimilarity::Kernel::scalar);
+            });
+            return distances.back();
+        };
+    }
+
+    // Scheduling overhead: many tiny jobs
+    BackgroundExecutor executor;
+    BENCHMARK ("Submit and run 10k empty jobs, all cores")
+    {
+        std::atomic<int> numRemaining { 10000 };
+        juce::WaitableEvent allDone;
+        for (int i = 0; i < 10000; ++i)
+        {
+            executor.submit ([&] {
+                if (--numRemaining == 0)
+                    allDone.signal();
+            });
+        }
+        allDone.wait();
+        return numRemaining.load();
+    };
+}
@@ -0,0 +1,60 @@
+#include "../tests/helpers/test_helpers.h"
+#include "ProgramExporter.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+// A big user library: random programs, named like imported preset files
+static const PresetBank& getBenchmarkBank()
+{
+    static const auto bank = [] {
+        PresetBank presets;
+        const auto states = makeRandomProgramStates (10000, 29);
+        presets.reserve (states.size());
+        for (size_t i = 0; i < states.size(); ++i)
+            presets.add ("Preset " + juce::String (i + 1).paddedLeft ('0', 5), states[i]);
+        return presets;
+    }();
+    return bank;
+}
+
+TEST_CASE ("Program export performance")
+{
+    const auto& bank = getBenchmarkBank();
+
+    // The stream is set up outside of the measurement, so this is the exporter alone
+    BENCHMARK_ADVANCED ("Export 10k presets as a MIDI file")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        juce::MemoryOutputStream stream;
+        stream.preallocate (bank.size() * (numParameters * 3 + 32) + 64);
+        meter.measure ([&] {
+            stream.reset();
+            ProgramExporter exporter (stream, ProgramExporter::Format::standardMidiFile);
+            exporter.writeBank (bank);
+            exporter.finish();
+            return stream.getDataSize();
+        });
+    };
+
+    BENCHMARK_ADVANCED ("Export 10k presets as a raw dump")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        juce::MemoryOutputStream stream;
+        stream.preallocate (bank.size() * numParameters * 3);
+        meter.measure ([&] {
+            stream.reset();
+            ProgramExporter exporter (stream, ProgramExporter::Format::rawDump);
+            exporter.writeBank (bank);
+            exporter.finish();
+            return stream.getDataSize();
+        });
+    };
+
+    // exportBank(), file system included
+    const auto file = juce::File::createTempFile (".mid");
+    BENCHMARK ("Export 10k presets to a MIDI file on disk")
+    {
+        return ProgramExporter::exportBank (bank, file, ProgramExporter::Format::standardMidiFile);
+    };
+    file.deleteFile();
+}
@@ -0,0 +1,78 @@
+#include "../tests/helpers/test_helpers.h"
+#include "PresetIndex.h"
+#include "PresetSimilarity.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+// A large random library, shared by the library benchmarks
+static const std::vector<ProgramState>& getBenchmarkLibrary()
+{
+    static const auto library = makeRandomProgramStates (100000, 42);
+    return library;
+}
+
+TEST_CASE ("Preset index performance")
+{
+    const auto& library = getBenchmarkLibrary();
+
+    BENCHMARK ("Build index of 100k presets")
+    {
+        PresetIndex index;
+        index.rebuild (library);
+        return index.size();
+    };
+
+    PresetIndex index;
+    index.rebuild (library);
+    PresetIndex::Bitmap result;
+
+    const auto discreteQuery = PresetIndex::Query()
+                                   .equals (parameterIndex (ENABLE_ARP_NAME), 1)
+                                   .equals (parameterIndex (ENABLE_LEGATO_NAME), 0)
+                                   .equals (parameterIndex (MIDI_A_CV_NAME), 3)
+                                   .equals (parameterIndex (MIDI_B_CHANNEL_NAME), 16);
+
+    const auto rangeQuery = PresetIndex::Query()
+                                .equals (parameterIndex (ENABLE_ARP_NAME), 1)
+                                .range (parameterIndex (PORTAMENTO_NAME), 13, 99)
+                                .range (parameterIndex (MIDI_A_PITCH_NAME), 40, 60);
+
+    BENCHMARK ("Filter 100k presets, 4 discrete terms")
+    {
+        index.find (discreteQuery, result);
+        return result.words.size();
+    };
+
+    BENCHMARK ("Filter 100k presets, discrete and range terms")
+    {
+        index.find (rangeQuery, result);
+        return result.words.size();
+    };
+}
+
+TEST_CASE ("Preset similarity performance")
+{
+    const auto& library = getBenchmarkLibrary();
+    const auto target = library[library.size() / 2];
+    const auto weights = PresetSimilarity::getDefaultWeights();
+    std::vector<uint32_t> distances (library.size());
+
+    // Throughput is library.size() presets per run, divide by the reported mean
+    // to get presets scanned per second
+    for (auto kernel : { PresetSimilarity::Kernel::scalar, PresetSimilarity::Kernel::ssse3, PresetSimilarity::Kernel::avx2, PresetSimilarity::Kernel::neon })
+    {
+        if (! PresetSimilarity::isKernelAvailable (kernel))
+            continue;
+
+        BENCHMARK ("Scan 100k presets, " + std::string (PresetSimilarity::getKernelName (kernel)) + " kernel")
+        {
+            PresetSimilarity::computeDistances (library.data(), library.size(), target, weights, distances.data(), kernel);
+            return distances.back();
+        };
+    }
+
+    BENCHMARK ("Find 20 most similar of 100k presets, best kernel, threaded")
+    {
+        return PresetSimilarity::findSimilar (library, target, 20).size();
+    };
+}
@@ -0,0 +1,112 @@
+/*
+ * Test client for the shared memory control ring (see source/ProgrammerShm.h).
+ *
+ * Attaches to a running 0-Programmer and sends a ramp of CC values (0..127, then
+ * wrapping) on one CC, with a fixed interval in between.
+ *
+ * Usage: ShmClient [--name /0-programmer-control] [--channel 1] [--cc 5]
+ *                  [--count 128] [--interval-ms 10]
+ *
+ * The default CC is portamento. Messages which don't fit (ring full) are retried
+ * on the next interval. Exits with 1 if the segment can't be opened, 0 otherwise.
+ */
+
+#include "ProgrammerShm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+static ProgrammerShmRing* openRing (const char* name)
+{
+#if defined(_WIN32)
+    char windowsName[256];
+    snprintf (windowsName, sizeof (windowsName), "Local\\%s", name[0] == '/' ? name + 1 : name);
+    HANDLE handle = OpenFileMappingA (FILE_MAP_ALL_ACCESS, FALSE, windowsName);
+    if (handle == NULL)
+        return NULL;
+    /* The handle stays open until the process exits */
+    return (ProgrammerShmRing*) MapViewOfFile (handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof (ProgrammerShmRing));
+#else
+    const int fd = shm_open (name, O_RDWR, 0);
+    if (fd < 0)
+        return NULL;
+    void* memory = mmap (NULL, sizeof (ProgrammerShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+    return memory == MAP_FAILED ? NULL : (ProgrammerShmRing*) memory;
+#endif
+}
+
+static void sleepMilliseconds (int milliseconds)
+{
+#if defined(_WIN32)
+    Sleep ((DWORD) milliseconds);
+#else
+    struct timespec duration;
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (long) (milliseconds % 1000) * 1000000L;
+    nanosleep (&duration, NULL);
+#endif
+}
+
+int main (int argc, char* argv[])
+{
+    const char* name = PROGRAMMER_SHM_NAME;
+    int channel = 1;
+    int cc = 5;
+    int count = 128;
+    int intervalMs = 10;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp (argv[i], "--name") == 0)
+            name = argv[i + 1];
+        else if (strcmp (argv[i], "--channel") == 0)
+            channel = atoi (argv[i + 1]);
+        else if (strcmp (argv[i], "--cc") == 0)
+            cc = atoi (argv[i + 1]);
+        else if (strcmp (argv[i], "--count") == 0)
+            count = atoi (argv[i + 1]);
+        else if (strcmp (argv[i], "--interval-ms") == 0)
+            intervalMs = atoi (argv[i + 1]);
+    }
+
+    ProgrammerShmRing* ring = openRing (name);
+    if (ring == NULL || ! programmer_shm_is_valid (ring))
+    {
+        fprintf (stderr, "Could not open %s. Is 0-Programmer running with shared memory control on?\n", name);
+        return 1;
+    }
+
+    int numSent = 0;
+    int numRetries = 0;
+    while (numSent < count)
+    {
+        ProgrammerShmMessage message;
+        message.type = PROGRAMMER_SHM_TYPE_CC;
+        message.value1 = channel;
+        message.value2 = cc;
+        message.value3 = numSent % 128;
+
+        if (programmer_shm_push (ring, &message))
+            ++numSent;
+        else
+            ++numRetries;
+
+        if (intervalMs > 0)
+            sleepMilliseconds (intervalMs);
+    }
+
+    printf ("Sent %d messages to %s (%d retries on a full ring)\n", numSent, name, numRetries);
+    return 0;
+}
@@ -0,0 +1,300 @@
+/**
+ * Soak test for the editor to processor pipeline.
+ *
+ * The message thread runs a real ProgrammerEditor, and pushes CCs at a high rate
+ * through the processor's MessageQueueProducer, like the editor does. The editor
+ * ticks on a VirtualScheduler which is advanced by one tick interval per soak tick,
+ * so its flush of the producer, widget scan and notification all run at the soak
+ * rate instead of once a second. Meanwhile a simulated audio thread calls
+ * processBlock in realtime (one block every blockSize / sampleRate seconds).
+ *
+ * Every pushed CC carries a sequence number (spread over channel, CC number and
+ * value), so the audio side can tell whether anything was lost or reordered. On
+ * every tick a widget is also moved, so the editor's own CCs go through the same
+ * path. Sequence numbers never use the program page CCs on MIDI_CHANNEL, so the
+ * editor's CCs can be told apart and are counted separately.
+ *
+ * Usage: SoakTest [--seconds 300] [--sample-rate 48000] [--block-size 256]
+ *                 [--tick-hz 1000] [--burst 18] [--metrics metrics.csv]
+ *
+ * The editor sends a burst of messages (18 = a whole program) per tick. The producer
+ * uses the spill policy, so a full queue delays messages until the next tick instead
+ * of dropping them. With --metrics, the processor metrics are appended to a CSV file
+ * at the end of the run. Exits with 1 if anything was lost or reordered, 0 otherwise.
+ *
+ * ctest runs it for 10 seconds, labelled "soak". Leave it out with ctest -LE soak.
+ */
+
+#include <PluginEditor.h>
+#include <PluginProcessor.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // 4 bits of channel, 7 bits of CC number, 7 bits of value
+    constexpr uint32_t sequenceBits = 18;
+    constexpr uint32_t sequenceMask = (1u << sequenceBits) - 1;
+
+    MidiEvent encodeSequence (uint32_t sequence)
+    {
+        return MidiEvent::controller (static_cast<int> ((sequence >> 14) & 0x0F) + 1,
+            static_cast<int> ((sequence >> 7) & 0x7F),
+            static_cast<int> (sequence & 0x7F));
+    }
+
+    uint32_t decodeSequence (const juce::MidiMessage& message)
+    {
+        return static_cast<uint32_t> (((message.getChannel() - 1) << 14) | (message.getControllerNumber() << 7) | message.getControllerValue());
+    }
+
+    // The CCs the editor sends for its widgets
+    bool isEditorCc (const juce::MidiMessage& message)
+    {
+        return message.getChannel() == MIDI_CHANNEL && findParameterIndexByCc (message.getControllerNumber()) >= 0;
+    }
+
+    // Sequence numbers skip the ones which would look like an editor CC
+    uint32_t nextSequence (uint32_t sequence)
+    {
+        do
+        {
+            sequence = (sequence + 1) & sequenceMask;
+        } while (static_cast<int> ((sequence >> 14) & 0x0F) + 1 == MIDI_CHANNEL && findParameterIndexByCc (static_cast<int> ((sequence >> 7) & 0x7F)) >= 0);
+        return sequence;
+    }
+
+    struct Options
+    {
+        double seconds = 300.0;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        int tickHz = 1000;
+        int burst = 18;
+        juce::String metricsFile;
+    };
+
+    Options parseOptions (const juce::StringArray& args)
+    {
+        Options options;
+        for (int i = 0; i + 1 < args.size(); ++i)
+        {
+            const auto& value = args[i + 1];
+            if (args[i] == "--seconds")
+                options.seconds = value.getDoubleValue();
+            else if (args[i] == "--sample-rate")
+                options.sampleRate = value.getDoubleValue();
+            else if (args[i] == "--block-size")
+                options.blockSize = value.getIntValue();
+            else if (args[i] == "--tick-hz")
+                options.tickHz = value.getIntValue();
+            else if (args[i] == "--burst")
+                options.burst = value.getIntValue();
+            else if (args[i] == "--metrics")
+                options.metricsFile = value;
+        }
+        options.blockSize = std::max (options.blockSize, 1);
+        options.tickHz = std::max (options.tickHz, 1);
+        options.burst = std::max (options.burst, 1);
+        return options;
+    }
+
+    // Latencies in microseconds, 1µs resolution up to 1s
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram() : bins (1000000 + 1) {}
+
+        void add (int64_t microseconds)
+        {
+            const auto bin = static_cast<size_t> (std::clamp<int64_t> (microseconds, 0, static_cast<int64_t> (bins.size() - 1)));
+            ++bins[bin];
+            ++count;
+            maximum = std::max (maximum, microseconds);
+        }
+
+        int64_t getPercentile (double percentile) const
+        {
+            const auto target = static_cast<uint64_t> (std::ceil (percentile / 100.0 * static_cast<double> (count)));
+            uint64_t seen = 0;
+            for (size_t bin = 0; bin < bins.size(); ++bin)
+            {
+                seen += bins[bin];
+                if (seen >= target && seen > 0)
+                    return static_cast<int64_t> (bin);
+            }
+            return maximum;
+        }
+
+        int64_t getMaximum() const { return maximum; }
+
+    private:
+        std::vector<uint64_t> bins;
+        uint64_t count = 0;
+        int64_t maximum = 0;
+    };
+}
+
+int main (int argc, char* argv[])
+{
+    // The processor's parameters need a MessageManager
+    juce::ScopedJuceInitialiser_GUI gui;
+
+    const auto options = parseOptions (juce::StringArray (argv + 1, argc - 1));
+    std::cout << "Soak test: " << options.seconds << "s, " << options.sampleRate << "Hz, "
+              << options.blockSize << " samples per block, " << options.burst << " messages per editor tick at "
+              << options.tickHz << "Hz" << std::endl;
+
+    ProgrammerProcessor processor;
+    processor.setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+    processor.prepareToPlay (options.sampleRate, options.blockSize);
+
+    // The editor ticks when the soak says so, not on a JUCE timer
+    auto virtualScheduler = std::make_unique<VirtualScheduler>();
+    auto& scheduler = *virtualScheduler;
+    processor.setScheduler (std::move (virtualScheduler));
+    processor.messageProducer->setPolicy (MessageQueueProducer::OverflowPolicy::spill);
+    ProgrammerEditor editor (processor);
+
+    // Push time of each sequence number in flight. Written by the message thread
+    // before the push, read by the audio thread after the pop.
+    std::vector<int64_t> pushTicks (sequenceMask + 1);
+    std::atomic<bool> editorDone { false };
+    size_t maxQueueDepth = 0;
+    uint64_t numPushed = 0;
+    uint64_t numWidgetEdits = 0;
+
+    const auto ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const auto endTicks = startTicks + static_cast<int64_t> (options.seconds * static_cast<double> (ticksPerSecond));
+
+    // Simulated audio thread. Keeps going until the editor is done and the queue
+    // is empty.
+    LatencyHistogram latencies;
+    uint64_t numReceived = 0;
+    uint64_t numEditorCcs = 0;
+    uint64_t numLost = 0;
+    uint64_t numReordered = 0;
+    uint64_t numBlocks = 0;
+    uint32_t expected = nextSequence (sequenceMask);
+
+    std::thread audio ([&] {
+        juce::AudioBuffer<float> buffer (2, options.blockSize);
+        juce::MidiBuffer midiBuffer;
+        const auto blockInterval = std::chrono::duration<double> (options.blockSize / options.sampleRate);
+        auto nextBlock = std::chrono::steady_clock::now();
+
+        while (! editorDone || processor.messageQueue->getNumReady() > 0)
+        {
+            processor.processBlock (buffer, midiBuffer);
+            const auto now = juce::Time::getHighResolutionTicks();
+            ++numBlocks;
+
+            for (const auto metadata : midiBuffer)
+            {
+                const auto message = metadata.getMessage();
+                if (isEditorCc (message))
+                {
+                    ++numEditorCcs;
+                    continue;
+                }
+
+                const auto sequence = decodeSequence (message);
+                if (sequence != expected)
+                {
+                    // Behind what we expect means reordered, ahead means lost
+                    const auto distance = (sequence - expected) & sequenceMask;
+                    if (distance > sequenceMask / 2)
+                    {
+                        ++numReordered;
+                        continue;
+                    }
+                    for (auto missing = expected; missing != sequence; missing = nextSequence (missing))
+                        ++numLost;
+                }
+
+                latencies.add ((now - pushTicks[sequence]) * 1000000 / ticksPerSecond);
+                expected = nextSequence (sequence);
+                ++numReceived;
+            }
+            midiBuffer.clear();
+
+            nextBlock += std::chrono::duration_cast<std::chrono::steady_clock::duration> (blockInterval);
+            std::this_thread::sleep_until (nextBlock);
+        }
+    });
+
+    // Simulated editor, on the message thread: a burst through the producer and a
+    // moved widget, then one editor tick to flush and send them
+    const auto& widgetDefinition = parameterDefinitions[0];
+    const auto tickInterval = std::chrono::microseconds (1000000 / options.tickHz);
+    auto nextTick = std::chrono::steady_clock::now();
+    auto sequence = nextSequence (sequenceMask);
+    while (juce::Time::getHighResolutionTicks() < endTicks)
+    {
+        for (int i = 0; i < options.burst; ++i)
+        {
+            pushTicks[sequence] = juce::Time::getHighResolutionTicks();
+            processor.messageProducer->push (encodeSequence (sequence));
+            sequence = nextSequence (sequence);
+            ++numPushed;
+        }
+
+        auto widgetState = editor.testGetWidgetState();
+        widgetState[0] = static_cast<uint8_t> (widgetState[0] == widgetDefinition.minValue ? widgetDefinition.maxValue : widgetDefinition.minValue);
+        editor.testSetWidgetState (widgetState);
+        ++numWidgetEdits;
+
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        maxQueueDepth = std::max (maxQueueDepth, static_cast<size_t> (processor.messageQueue->getNumReady()) + processor.messageProducer->getNumPending());
+
+        nextTick += tickInterval;
+        std::this_thread::sleep_until (nextTick);
+    }
+
+    // Whatever spilled goes out on the next ticks
+    while (processor.messageProducer->getNumPending() > 0)
+    {
+        std::this_thread::sleep_for (tickInterval);
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+    }
+    editorDone = true;
+    audio.join();
+
+    const auto elapsed = static_cast<double> (juce::Time::getHighResolutionTicks() - startTicks) / static_cast<double> (ticksPerSecond);
+    numLost += numPushed - std::min (numPushed, numReceived + numLost);
+    numLost += processor.messageProducer->getNumLost();
+    const auto numEditorCcsLost = numWidgetEdits - std::min (numWidgetEdits, numEditorCcs);
+
+    std::cout << "Blocks processed:     " << numBlocks << "\n"
+              << "Messages pushed:      " << numPushed << "\n"
+              << "Messages received:    " << numReceived << "\n"
+              << "Widget CCs sent:      " << numWidgetEdits << "\n"
+              << "Widget CCs received:  " << numEditorCcs << "\n"
+              << "Throughput:           " << static_cast<double> (numReceived + numEditorCcs) / elapsed << " messages/s\n"
+              << "Max queue depth:      " << maxQueueDepth << " (including spilled)\n"
+              << "Spilled (queue full): " << processor.messageProducer->getNumSpilled() << "\n"
+              << "Lost:                 " << numLost << "\n"
+              << "Reordered:            " << numReordered << "\n"
+              << "Latency p50:          " << latencies.getPercentile (50.0) << "us\n"
+              << "Latency p90:          " << latencies.getPercentile (90.0) << "us\n"
+              << "Latency p99:          " << latencies.getPercentile (99.0) << "us\n"
+              << "Latency p99.9:        " << latencies.getPercentile (99.9) << "us\n"
+              << "Latency max:          " << latencies.getMaximum() << "us" << std::endl;
+
+    if (options.metricsFile.isNotEmpty())
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile (options.metricsFile);
+        if (! processor.getMetricsSnapshot().appendToCsv (file))
+            std::cout << "Could not write metrics to " << file.getFullPathName() << std::endl;
+    }
+
+    if (numLost > 0 || numReordered > 0 || numEditorCcsLost > 0)
+    {
+        std::cout << "FAILED: messages were lost or reordered" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "BackgroundExecutor.h"
+#include "Trace.h"
+
+class BackgroundExecutor::Worker : public juce::Thread
+{
+public:
+    Worker (BackgroundExecutor& owner, size_t workerIndex)
+        : juce::Thread ("Background " + juce::String (workerIndex + 1)), executor (owner), index (workerIndex)
+    {
+    }
+
+    void run() override
+    {
+        current = this;
+        TRACE_THREAD_NAME ("Background Worker");
+        while (! executor.shouldStop.load())
+        {
+            if (! executor.tryRunTask (index))
+                executor.waitForTask();
+        }
+        current = nullptr;
+    }
+
+    // The worker the calling thread is, if any
+    static inline thread_local Worker* current = nullptr;
+
+    BackgroundExecutor& executor;
+    const size_t index;
+    TaskQueues ownQueues;
+};
+
+BackgroundExecutor::BackgroundExecutor (int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = juce::SystemStats::getNumCpus();
+
+    for (size_t i = 0; i < static_cast<size_t> (numThreads); ++i)
+        workers.push_back (std::make_unique<Worker> (*this, i));
+    for (auto& worker : workers)
+        worker->startThread();
+}
+
+BackgroundExecutor::~BackgroundExecutor()
+{
+    {
+        const std::lock_guard<std::mutex> lock (sleepMutex);
+        shouldStop = true;
+    }
+    wakeUp.notify_all();
+
+    // Running jobs are finished, queued ones are dropped with the workers
+    for (auto& worker : workers)
+        worker->stopThread (-1);
+}
+
+void BackgroundExecutor::submit (Job job, Priority priority, CancellationToken token, Completion onComplete)
+{
+    // Jobs submitted from a job stay with that worker
+    auto* current = Worker::current;
+    auto& target = (current != nullptr && &current->executor == this) ? current->ownQueues : sharedQueues;
+
+    {
+        const std::lock_guard<std::mutex> lock (target.mutex);
+        target.queues[static_cast<size_t> (priority)].push_back ({ std::move (job), std::move (token), std::move (onComplete) });
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock (sleepMutex);
+        ++numQueued;
+    }
+    wakeUp.notify_one();
+}
+
+bool BackgroundExecutor::tryRunTask (size_t workerIndex)
+{
+    Task task;
+    if (! popTask (workerIndex, task))
+        return false;
+
+    runTask (task);
+    return true;
+}
+
+bool BackgroundExecutor::popTask (size_t workerIndex, Task& task)
+{
+    const auto pop = [this, &task] (TaskQueues& source, size_t priority, bool newest) {
+        const std::lock_guard<std::mutex> lock (source.mutex);
+        auto& queue = source.queues[priority];
+        if (queue.empty())
+            return false;
+
+        task = std::move (newest ? queue.back() : queue.front());
+        if (newest)
+            queue.pop_back();
+        else
+            queue.pop_front();
+        --numQueued;
+        return true;
+    };
+
+    for (size_t priority = 0; priority < numPriorities; ++priority)
+    {
+        // Own queue first, newest job first. Then the shared queue in order.
+        if (pop (workers[workerIndex]->ownQueues, priority, true) || pop (sharedQueues, priority, false))
+            return true;
+
+        // Then steal the oldest job of another worker
+        for (size_t offset = 1; offset < workers.size(); ++offset)
+        {
+            if (pop (workers[(workerIndex + offset) % workers.size()]->ownQueues, priority, false))
+                return true;
+        }
+    }
+    return false;
+}
+
+void BackgroundExecutor::waitForTask()
+{
+    std::unique_lock<std::mutex> lock (sleepMutex);
+    wakeUp.wait (lock, [this] { return numQueued.load() > 0 || shouldStop.load(); });
+}
+
+void BackgroundExecutor::runTask (Task& task)
+{
+    if (! task.token.isCancelled())
+    {
+        TRACE_SCOPE ("BackgroundExecutor job");
+        task.job();
+    }
+
+    if (task.onComplete)
+    {
+        // The token is checked on the message thread, right before the call
+        juce::MessageManager::callAsync ([onComplete = std::move (task.onComplete), token = task.token] {
+            onComplete (token.isCancelled());
+        });
+    }
+}
+
+void BackgroundExecutor::parallelFor (size_t numChunks, const std::function<void (size_t chunk)>& body, Priority priority)
+{
+    if (numChunks == 0)
+        return;
+
+    // Shared with the helper jobs, which may only start after this returned. They
+    // only touch body once they got a chunk, and then this is still waiting.
+    struct State
+    {
+        size_t numChunks = 0;
+        const std::function<void (size_t)>* body = nullptr;
+        std::atomic<size_t> nextChunk { 0 };
+        std::atomic<size_t> numDone { 0 };
+        std::mutex mutex;
+        std::condition_variable allDone;
+    };
+    auto state = std::make_shared<State>();
+    state->numChunks = numChunks;
+    state->body = &body;
+
+    const auto runChunks = [state] {
+        for (auto chunk = state->nextChunk++; chunk < state->numChunks; chunk = state->nextChunk++)
+        {
+            (*state->body) (chunk);
+            if (++state->numDone == state->numChunks)
+            {
+                const std::lock_guard<std::mutex> lock (state->mutex);
+                state->allDone.notify_all();
+            }
+        }
+    };
+
+    const auto numHelpers = std::min (numChunks - 1, workers.size());
+    for (size_t i = 0; i < numHelpers; ++i)
+        submit (runChunks, priority);
+
+    // Help out, then wait for the chunks other threads are still running
+    runChunks();
+    std::unique_lock<std::mutex> lock (state->mutex);
+    state->allDone.wait (lock, [&state] { return state->numDone.load() == state->numChunks; });
+}
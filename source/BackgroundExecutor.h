@@ -0,0 +1,133 @@
+/**
+ * @class BackgroundExecutor
+ * @brief A small work-stealing thread pool for heavy non-realtime jobs.
+ *
+ * Preset import, similarity search, saving and scanning devices must not run on the
+ * message thread, or the UI freezes. They are submitted here instead:
+ * - Jobs submitted from outside go to a shared queue, and are started in order.
+ * - Every worker also has its own queue. Jobs submitted from a job go there, and
+ *   are run newest first, while their data is still in cache.
+ * - A worker with nothing to do steals the oldest job from another worker's queue,
+ *   so a long job doesn't hold up the jobs queued behind it.
+ * - Higher priority jobs are always taken first, from any queue.
+ * - A job can be given a CancellationToken. Jobs cancelled before they start are
+ *   skipped, long jobs can check the token themselves.
+ * - The completion callback is called on the message thread, with the token state
+ *   checked there. So a component which cancels its token in its destructor is never
+ *   called back after it's gone.
+ *
+ * parallelFor() splits a loop into chunks, which the workers and the calling thread
+ * run together. It's what the importer and the similarity search use.
+ *
+ * The plugin shares one executor between all instances, through
+ * juce::SharedResourcePointer<BackgroundExecutor> (see ProgrammerProcessor::executor).
+ *
+ * NOTE: Never submit from, or wait on, the audio thread. Jobs which are still queued
+ * when the executor is destroyed are dropped, without calling their completion.
+ */
+
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class BackgroundExecutor
+{
+public:
+    enum class Priority
+    {
+        high,   // The user is waiting for it, ie. a search
+        normal, // Imports, saving
+        low,    // Autosave, indexing
+    };
+    static constexpr size_t numPriorities = 3;
+
+    /**
+     * @brief Shared flag to cancel one or more jobs. Copies refer to the same flag.
+     */
+    class CancellationToken
+    {
+    public:
+        CancellationToken() : cancelled (std::make_shared<std::atomic<bool>> (false)) {}
+
+        void cancel() { cancelled->store (true); }
+        bool isCancelled() const { return cancelled->load(); }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    using Job = std::function<void()>;
+
+    // Called on the message thread, wasCancelled is true if the token was cancelled
+    using Completion = std::function<void (bool wasCancelled)>;
+
+    /**
+     * @param numThreads Number of worker threads, 0 uses one per CPU core.
+     */
+    explicit BackgroundExecutor (int numThreads = 0);
+    ~BackgroundExecutor();
+
+    /**
+     * @brief Queues a job.
+     *
+     * @param job The job to run on a worker thread.
+     * @param priority Which jobs go first.
+     * @param token Skips the job (and tells the completion) when cancelled.
+     * @param onComplete Called on the message thread once the job ran or was skipped.
+     */
+    void submit (Job job, Priority priority = Priority::normal, CancellationToken token = {}, Completion onComplete = {});
+
+    /**
+     * @brief Calls body (chunk) for every chunk in 0..numChunks-1, spread over the
+     * workers and the calling thread, and returns when all chunks are done.
+     *
+     * Can also be called from a job, the worker then helps with the chunks instead of
+     * blocking.
+     */
+    void parallelFor (size_t numChunks, const std::function<void (size_t chunk)>& body, Priority priority = Priority::normal);
+
+    int getNumThreads() const { return static_cast<int> (workers.size()); }
+
+    // Jobs queued, but not started yet
+    int getNumQueued() const { return numQueued.load(); }
+
+private:
+    struct Task
+    {
+        Job job;
+        CancellationToken token;
+        Completion onComplete;
+    };
+
+    // One queue per priority
+    struct TaskQueues
+    {
+        std::mutex mutex;
+        std::array<std::deque<Task>, numPriorities> queues;
+    };
+
+    class Worker;
+    std::vector<std::unique_ptr<Worker>> workers;
+    TaskQueues sharedQueues;
+
+    // Sleeping workers wait for numQueued > 0
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> numQueued { 0 };
+    std::atomic<bool> shouldStop { false };
+
+    bool tryRunTask (size_t workerIndex);
+    bool popTask (size_t workerIndex, Task& task);
+    void waitForTask();
+    static void runTask (Task& task);
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundExecutor)
+};
@@ -0,0 +1,126 @@
+/**
+ * @class CcDecimator
+ * @brief Decides which parameter changes are worth sending as CC messages.
+ *
+ * Host automation can change a parameter on every block, but the 0-Coast only
+ * understands 7-bit CC values. The decimator quantizes each incoming value to
+ * 7 bits and only lets it through when the quantized value differs from what
+ * was last sent for that parameter. Everything else is dropped, so the MIDI link
+ * is not flooded with redundant messages.
+ *
+ * CCs which are sent through other paths (ie. the editor message queue) should be
+ * reported with noteSent(), so the decimator knows what the device has received.
+ *
+ * NOTE: Not thread-safe. It is meant to be owned and used by the audio thread only.
+ */
+
+#pragma once
+
+#include "ParameterDefinitions.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+class CcDecimator
+{
+public:
+    CcDecimator()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Resets the decimator, assuming the device holds the default values.
+     */
+    void reset()
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            lastInput[i] = static_cast<uint8_t> (parameterDefinitions[i].defaultValue);
+            lastSent[i] = lastInput[i];
+        }
+    }
+
+    /**
+     * @brief Quantizes a parameter value to the 7-bit range of a CC message.
+     */
+    static uint8_t quantize (float value)
+    {
+        const auto rounded = std::lround (value);
+        return static_cast<uint8_t> (rounded < 0 ? 0 : (rounded > 127 ? 127 : rounded));
+    }
+
+    /**
+     * @brief Feeds a new value for a parameter into the decimator.
+     *
+     * Only changes of the input are considered, so an input that sits still never
+     * overrides values sent through other paths.
+     *
+     * @param index The index of the parameter in parameterDefinitions.
+     * @param value The new (unquantized) value of the parameter.
+     * @return bool True if a CC with getLastSent(index) should be sent, false otherwise.
+     */
+    bool update (size_t index, float value)
+    {
+        const auto quantized = quantize (value);
+        if (quantized == lastInput[index])
+            return false;
+
+        lastInput[index] = quantized;
+        return send (index, quantized);
+    }
+
+    /**
+     * @brief Takes a new input value without sending anything, ie. when the input
+     * was set to follow a value already sent through another path.
+     *
+     * @param index The index of the parameter in parameterDefinitions.
+     * @param value The new (unquantized) value of the parameter.
+     */
+    void noteInput (size_t index, float value)
+    {
+        lastInput[index] = quantize (value);
+    }
+
+    /**
+     * @brief Checks a value against what was last sent, without any input tracking.
+     *
+     * Used for sources which produce a complete value every block (ie. morphing),
+     * where only the deduplication against the device is needed.
+     *
+     * @param index The index of the parameter in parameterDefinitions.
+     * @param value The 7-bit value to send.
+     * @return bool True if the value differs from what was last sent, false otherwise.
+     */
+    bool send (size_t index, uint8_t value)
+    {
+        if (value == lastSent[index])
+            return false;
+
+        lastSent[index] = value;
+        return true;
+    }
+
+    /**
+     * @brief Tells the decimator that a value has been sent through another path.
+     *
+     * @param index The index of the parameter in parameterDefinitions.
+     * @param value The 7-bit value which was sent.
+     */
+    void noteSent (size_t index, int value)
+    {
+        lastSent[index] = quantize (static_cast<float> (value));
+    }
+
+    /**
+     * @brief Retrieves the value last sent for a parameter.
+     */
+    uint8_t getLastSent (size_t index) const
+    {
+        return lastSent[index];
+    }
+
+private:
+    std::array<uint8_t, numParameters> lastInput;
+    std::array<uint8_t, numParameters> lastSent;
+};
@@ -0,0 +1,285 @@
+/**
+ * @class CcJournalWriter
+ * @brief Records every CC the processor emits into an append-only, memory-mapped journal file.
+ *
+ * Each record holds the high resolution timestamp of the block it was sent in, the
+ * absolute sample position (samples since the processor was created) and the three
+ * MIDI bytes. On the audio thread, recording a CC is a single store into a lock-free
+ * ring. A writer thread drains the ring into the journal file, which is memory-mapped
+ * and grown in chunks, so it never blocks the audio thread.
+ *
+ * Journals are handy for debugging stage problems after the fact, and recorded
+ * sessions can be replayed through processBlock (see ProgrammerProcessor::startReplay)
+ * as performance regression inputs.
+ *
+ * NOTE: One (1!) audio thread may call record(). start() and stop() must be called
+ * from the same non-realtime thread. The file is written in native byte order.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "RealtimeWatchdog.h"
+#include <vector>
+
+struct CcJournalRecord
+{
+    int64_t ticks;          // juce::Time::getHighResolutionTicks() at the start of the block
+    int64_t samplePosition; // Absolute sample position of the message
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+    uint8_t reserved[5];
+};
+static_assert (sizeof (CcJournalRecord) == 24);
+
+struct CcJournalHeader
+{
+    static constexpr char expectedMagic[4] = { 'C', 'C', 'J', '1' };
+    static constexpr uint32_t currentVersion = 1;
+
+    char magic[4];
+    uint32_t version;
+    double sampleRate;
+    int64_t ticksPerSecond;
+    int64_t numRecords; // Records written so far, updated after each batch of records
+};
+static_assert (sizeof (CcJournalHeader) == 32);
+
+class CcJournalWriter : private juce::Thread
+{
+public:
+    static constexpr int ringCapacity = 4096;
+    static constexpr int64_t recordsPerChunk = 65536; // Grow the file by 1.5MB at a time
+
+    CcJournalWriter()
+        : juce::Thread ("CC Journal"), fifo (ringCapacity), ring (static_cast<size_t> (ringCapacity))
+    {
+    }
+
+    ~CcJournalWriter() override
+    {
+        stop();
+    }
+
+    /**
+     * @brief Starts recording into a new journal file, replacing the file if it exists.
+     *
+     * @param journalFile The file to write.
+     * @param sampleRate The sample rate of the processor, stored for replay.
+     * @return bool True if the file could be created and mapped, false otherwise.
+     */
+    bool start (const juce::File& journalFile, double sampleRate)
+    {
+        REALTIME_WATCHDOG_BLOCKING_CALL ("CcJournalWriter::start");
+        stop();
+
+        file = journalFile;
+        file.deleteFile();
+        numRecords = 0;
+        capacity = 0;
+        if (! grow (recordsPerChunk))
+            return false;
+
+        auto* header = getHeader();
+        std::memcpy (header->magic, CcJournalHeader::expectedMagic, sizeof (header->magic));
+        header->version = CcJournalHeader::currentVersion;
+        header->sampleRate = sampleRate;
+        header->ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+        header->numRecords = 0;
+
+        // Records still in the ring from an earlier recording are older than this
+        startTicks = juce::Time::getHighResolutionTicks();
+        numDropped = 0;
+        startThread();
+        recording = true;
+        return true;
+    }
+
+    /**
+     * @brief Stops recording, and writes out what's left in the ring.
+     */
+    void stop()
+    {
+        REALTIME_WATCHDOG_BLOCKING_CALL ("CcJournalWriter::stop");
+        if (! isThreadRunning())
+            return;
+
+        recording = false;
+        stopThread (1000);
+        drain();
+
+        // Trim the unused part of the last chunk
+        mapping.reset();
+        juce::FileOutputStream stream (file);
+        if (stream.openedOk() && stream.setPosition (getFileSize (numRecords)))
+            stream.truncate();
+    }
+
+    bool isRecording() const { return recording.load (std::memory_order_relaxed); }
+
+    /**
+     * @brief Records one message. Realtime safe.
+     *
+     * @param ticks The high resolution timestamp of the current block.
+     * @param samplePosition The absolute sample position of the message.
+     * @param bytes The three MIDI bytes of the message.
+     */
+    void record (int64_t ticks, int64_t samplePosition, const uint8_t* bytes)
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 > 0)
+            ring[static_cast<size_t> (scope.startIndex1)] = { ticks, samplePosition, bytes[0], bytes[1], bytes[2], {} };
+        else
+            numDropped.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    // Messages which didn't fit in the ring, because the writer thread fell behind
+    int getNumDropped() const { return numDropped.load(); }
+
+    const juce::File& getFile() const { return file; }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            drain();
+            wait (5);
+        }
+    }
+
+    void drain()
+    {
+        const auto scope = fifo.read (fifo.getNumReady());
+        append (scope.startIndex1, scope.blockSize1);
+        append (scope.startIndex2, scope.blockSize2);
+
+        // Publish the new records after they were written, so a crash leaves a
+        // consistent file behind
+        if (mapping != nullptr)
+            getHeader()->numRecords = numRecords;
+    }
+
+    void append (int startIndex, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& record = ring[static_cast<size_t> (startIndex + i)];
+            if (record.ticks < startTicks)
+                continue;
+            if (numRecords == capacity && ! grow (capacity + recordsPerChunk))
+            {
+                numDropped.fetch_add (1, std::memory_order_relaxed);
+                continue;
+            }
+
+            auto* records = reinterpret_cast<CcJournalRecord*> (getHeader() + 1);
+            records[numRecords++] = record;
+        }
+    }
+
+    // Extends the file and maps it again. Nothing else touches the mapping meanwhile.
+    bool grow (int64_t newCapacity)
+    {
+        if (mapping != nullptr)
+            getHeader()->numRecords = numRecords;
+        mapping.reset();
+
+        {
+            juce::FileOutputStream stream (file);
+            if (! stream.openedOk() || ! stream.setPosition (getFileSize (newCapacity) - 1))
+                return false;
+            stream.writeByte (0);
+        }
+
+        mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readWrite);
+        if (mapping->getData() == nullptr || static_cast<int64_t> (mapping->getSize()) < getFileSize (newCapacity))
+        {
+            mapping.reset();
+            return false;
+        }
+
+        capacity = newCapacity;
+        return true;
+    }
+
+    static int64_t getFileSize (int64_t numRecordsInFile)
+    {
+        return static_cast<int64_t> (sizeof (CcJournalHeader)) + numRecordsInFile * static_cast<int64_t> (sizeof (CcJournalRecord));
+    }
+
+    CcJournalHeader* getHeader() const { return static_cast<CcJournalHeader*> (mapping->getData()); }
+
+    // Ring between the audio thread and the writer thread
+    juce::AbstractFifo fifo;
+    std::vector<CcJournalRecord> ring;
+    std::atomic<bool> recording { false };
+    std::atomic<int> numDropped { 0 };
+
+    // Only touched by the writer thread while it runs
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    int64_t numRecords = 0;
+    int64_t capacity = 0;
+    int64_t startTicks = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (CcJournalWriter)
+};
+
+/**
+ * @class CcJournalReader
+ * @brief Maps a journal written by CcJournalWriter for reading.
+ */
+class CcJournalReader
+{
+public:
+    /**
+     * @brief Opens a journal.
+     *
+     * @return bool True if the file is a valid journal, false otherwise.
+     */
+    bool open (const juce::File& journalFile)
+    {
+        mapping = std::make_unique<juce::MemoryMappedFile> (journalFile, juce::MemoryMappedFile::readOnly);
+        numRecords = 0;
+
+        const auto fileSize = mapping->getSize();
+        if (mapping->getData() == nullptr || fileSize < sizeof (CcJournalHeader))
+        {
+            mapping.reset();
+            return false;
+        }
+
+        const auto& header = getHeader();
+        if (std::memcmp (header.magic, CcJournalHeader::expectedMagic, sizeof (header.magic)) != 0
+            || header.version != CcJournalHeader::currentVersion)
+        {
+            mapping.reset();
+            return false;
+        }
+
+        // Don't trust the count further than the file reaches
+        const auto maxRecords = (fileSize - sizeof (CcJournalHeader)) / sizeof (CcJournalRecord);
+        numRecords = std::min (static_cast<size_t> (std::max<int64_t> (header.numRecords, 0)), maxRecords);
+        return true;
+    }
+
+    size_t size() const { return numRecords; }
+    bool isEmpty() const { return numRecords == 0; }
+
+    const CcJournalRecord& operator[] (size_t index) const
+    {
+        jassert (index < numRecords);
+        return reinterpret_cast<const CcJournalRecord*> (&getHeader() + 1)[index];
+    }
+
+    double getSampleRate() const { return getHeader().sampleRate; }
+    int64_t getTicksPerSecond() const { return getHeader().ticksPerSecond; }
+
+private:
+    const CcJournalHeader& getHeader() const { return *static_cast<const CcJournalHeader*> (mapping->getData()); }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    size_t numRecords = 0;
+};
@@ -0,0 +1,156 @@
+/**
+ * @class MessageQueueProducer
+ * @brief The producer end of a ThreadSafeMessageQueue, deciding what happens when the queue is full.
+ *
+ * When the queue is full, messages wait in a pending list on the producer side,
+ * which is moved into the queue (in order) on the next push() or flush(). What
+ * happens to the pending list depends on the overflow policy:
+ * - rejectNew: Nothing is kept. The new message is dropped.
+ * - dropOldest: The pending list holds up to pendingCapacity messages. When it's
+ *   full, the oldest pending message is dropped. Messages already in the queue
+ *   belong to the consumer, and are never dropped.
+ * - coalesceByCc: A pending message for the same channel and CC gets the new value
+ *   instead. The device ends up with the latest value, skipping the ones between.
+ * - spill: The pending list grows as needed. Nothing is dropped.
+ *
+ * A sysex event owns its slot in the queue's SysexPool, so a dropped one releases
+ * the slot.
+ *
+ * Every policy counts what it did in lock-free counters, which can be read from
+ * any thread (ie. to show a warning in the UI).
+ *
+ * NOTE: push(), flush() and setPolicy() must only be called from the producer
+ * thread (the one (1!) thread pushing into the queue).
+ */
+
+#pragma once
+
+#include "ThreadSafeMessageQueue.h"
+#include <deque>
+
+class MessageQueueProducer
+{
+public:
+    enum class OverflowPolicy
+    {
+        rejectNew,
+        dropOldest,
+        coalesceByCc,
+        spill
+    };
+
+    /**
+     * @brief Creates a producer for a queue. The queue must outlive the producer.
+     *
+     * @param messageQueue The queue to push into.
+     * @param overflowPolicy What to do with messages which don't fit in the queue.
+     * @param maxPending Size of the pending list for dropOldest, 0 uses the queue size.
+     */
+    MessageQueueProducer(ThreadSafeMessageQueue& messageQueue, OverflowPolicy overflowPolicy = OverflowPolicy::coalesceByCc, size_t maxPending = 0)
+        : queue(messageQueue),
+          policy(overflowPolicy),
+          pendingCapacity(maxPending > 0 ? maxPending : static_cast<size_t>(messageQueue.getTotalSize()))
+    {
+    }
+
+    /**
+     * @brief Pushes a message, or keeps it pending if the queue is full.
+     *
+     * @param message The message to push.
+     * @return bool False if the message was dropped (rejectNew), true otherwise.
+     */
+    bool push(const MidiEvent& message)
+    {
+        // Older messages go first
+        flush();
+        if (pending.empty() && queue.push(message))
+        {
+            numPushed.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        switch (policy)
+        {
+            case OverflowPolicy::rejectNew:
+                if (message.isSysex())
+                    queue.getSysexPool().release(message.getSysexSlot());
+                numRejected.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+            case OverflowPolicy::dropOldest:
+                if (pending.size() >= pendingCapacity)
+                {
+                    if (pending.front().isSysex())
+                        queue.getSysexPool().release(pending.front().getSysexSlot());
+                    pending.pop_front();
+                    numDroppedOldest.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+
+            case OverflowPolicy::coalesceByCc:
+                for (auto& waiting : pending)
+                {
+                    if (message.isController() && waiting.port == message.port && waiting.bytes[0] == message.bytes[0] && waiting.bytes[1] == message.bytes[1])
+                    {
+                        waiting.bytes[2] = message.bytes[2];
+                        numCoalesced.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+                break;
+
+            case OverflowPolicy::spill:
+                numSpilled.fetch_add(1, std::memory_order_relaxed);
+                break;
+        }
+
+        pending.push_back(message);
+        numPending.store(pending.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Moves as many pending messages into the queue as fit. Call this regularly
+     * (ie. every editor tick), so pending messages go out even when nothing new is pushed.
+     */
+    void flush()
+    {
+        while (! pending.empty() && queue.push(pending.front()))
+        {
+            pending.pop_front();
+            numPushed.fetch_add(1, std::memory_order_relaxed);
+        }
+        numPending.store(pending.size(), std::memory_order_relaxed);
+    }
+
+    void setPolicy(OverflowPolicy newPolicy) { policy = newPolicy; }
+    OverflowPolicy getPolicy() const { return policy; }
+
+    // Counters, readable from any thread
+    uint64_t getNumPushed() const { return numPushed.load(); }             // Messages moved into the queue
+    uint64_t getNumRejected() const { return numRejected.load(); }         // rejectNew: messages dropped
+    uint64_t getNumDroppedOldest() const { return numDroppedOldest.load(); } // dropOldest: pending messages dropped
+    uint64_t getNumCoalesced() const { return numCoalesced.load(); }       // coalesceByCc: messages merged into a pending one
+    uint64_t getNumSpilled() const { return numSpilled.load(); }           // spill: messages which had to wait in the overflow list
+    size_t getNumPending() const { return numPending.load(); }
+
+    /**
+     * @brief Number of updates the device never got, because a message was dropped.
+     *
+     * Coalesced messages don't count, as the device still ends up with the latest value.
+     */
+    uint64_t getNumLost() const { return getNumRejected() + getNumDroppedOldest(); }
+
+private:
+    ThreadSafeMessageQueue& queue;
+    OverflowPolicy policy;
+    const size_t pendingCapacity;
+    std::deque<MidiEvent> pending;
+
+    std::atomic<uint64_t> numPushed { 0 };
+    std::atomic<uint64_t> numRejected { 0 };
+    std::atomic<uint64_t> numDroppedOldest { 0 };
+    std::atomic<uint64_t> numCoalesced { 0 };
+    std::atomic<uint64_t> numSpilled { 0 };
+    std::atomic<size_t> numPending { 0 };
+};
@@ -0,0 +1,213 @@
+/**
+ * @class Metrics
+ * @brief Lock-free runtime counters and gauges for the processor and the editor.
+ *
+ * Each metric lives on its own cache line, so the audio thread and the editor never
+ * write to the same line. Every metric has a single writer, which keeps the hot path
+ * to a relaxed load and store (no locked read-modify-write). Durations are kept in
+ * high resolution ticks and only converted when a snapshot is taken.
+ *
+ * Any thread can read a snapshot. Rates (ie. CCs per second) are computed between
+ * two snapshots, so take snapshots from one thread only (ie. the editor timer).
+ *
+ * NOTE: Values in a snapshot are read one by one, not as one atomic transaction.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+class Metrics
+{
+public:
+    static constexpr size_t cacheLineSize = 64;
+
+    /* Monotonic counter. Single writer. */
+    struct alignas (cacheLineSize) Counter
+    {
+        void add (uint64_t amount = 1) { value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+        uint64_t get() const { return value.load (std::memory_order_relaxed); }
+
+        std::atomic<uint64_t> value { 0 };
+    };
+
+    /* Highest value seen. Single writer. */
+    struct alignas (cacheLineSize) MaxGauge
+    {
+        void update (int64_t newValue)
+        {
+            if (newValue > value.load (std::memory_order_relaxed))
+                value.store (newValue, std::memory_order_relaxed);
+        }
+        int64_t get() const { return value.load (std::memory_order_relaxed); }
+
+        std::atomic<int64_t> value { 0 };
+    };
+
+    /* Min, mean and max of a duration. Single writer. */
+    struct alignas (cacheLineSize) DurationStats
+    {
+        void record (int64_t ticks)
+        {
+            count.store (count.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            total.store (total.load (std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+            if (ticks < minimum.load (std::memory_order_relaxed))
+                minimum.store (ticks, std::memory_order_relaxed);
+            if (ticks > maximum.load (std::memory_order_relaxed))
+                maximum.store (ticks, std::memory_order_relaxed);
+        }
+
+        std::atomic<int64_t> count { 0 };
+        std::atomic<int64_t> total { 0 };
+        std::atomic<int64_t> minimum { std::numeric_limits<int64_t>::max() };
+        std::atomic<int64_t> maximum { 0 };
+    };
+
+    /* Times a scope into a DurationStats */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer (DurationStats& statsToUpdate)
+            : stats (statsToUpdate), startTicks (juce::Time::getHighResolutionTicks())
+        {
+        }
+        ~ScopedTimer() { stats.record (juce::Time::getHighResolutionTicks() - startTicks); }
+
+    private:
+        DurationStats& stats;
+        const int64_t startTicks;
+    };
+
+    struct DurationSnapshot
+    {
+        int64_t count = 0;
+        double minMicroseconds = 0.0;
+        double meanMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+    };
+
+    struct Snapshot
+    {
+        double uptimeSeconds = 0.0;
+        uint64_t messagesPushed = 0;
+        uint64_t messagesPopped = 0;
+        uint64_t messagesDropped = 0;
+        int64_t maxQueueDepth = 0;
+        uint64_t ccsEmitted = 0;
+        double ccsPerSecond = 0.0;
+        DurationSnapshot processBlock;
+        DurationSnapshot editorTick;
+
+        /**
+         * @brief Formats the snapshot on a single line, ie. for the debug footer.
+         */
+        juce::String toString() const
+        {
+            return "Msgs pushed/popped/dropped " + juce::String (messagesPushed) + "/" + juce::String (messagesPopped) + "/" + juce::String (messagesDropped)
+                   + " | max depth " + juce::String (maxQueueDepth)
+                   + " | processBlock " + formatDuration (processBlock)
+                   + " | " + juce::String (ccsPerSecond, 1) + " CC/s"
+                   + " | tick " + formatDuration (editorTick);
+        }
+
+        /**
+         * @brief Appends the snapshot as a CSV row to a file, writing the column names
+         * first if the file is new.
+         *
+         * @return bool True if the row was written, false otherwise.
+         */
+        bool appendToCsv (const juce::File& file) const
+        {
+            const auto isNew = ! file.existsAsFile() || file.getSize() == 0;
+            juce::FileOutputStream stream (file);
+            if (! stream.openedOk())
+                return false;
+
+            if (isNew)
+                stream << "uptime_s,pushed,popped,dropped,max_queue_depth,ccs_emitted,ccs_per_s,"
+                          "block_count,block_min_us,block_mean_us,block_max_us,"
+                          "tick_count,tick_min_us,tick_mean_us,tick_max_us\n";
+
+            stream << juce::String (uptimeSeconds, 3) << "," << juce::String (messagesPushed) << "," << juce::String (messagesPopped) << ","
+                   << juce::String (messagesDropped) << "," << juce::String (maxQueueDepth) << "," << juce::String (ccsEmitted) << ","
+                   << juce::String (ccsPerSecond, 1) << "," << formatCsv (processBlock) << "," << formatCsv (editorTick) << "\n";
+            stream.flush();
+            return stream.getStatus().wasOk();
+        }
+
+    private:
+        static juce::String formatDuration (const DurationSnapshot& duration)
+        {
+            return juce::String (duration.minMicroseconds, 1) + "/" + juce::String (duration.meanMicroseconds, 1) + "/"
+                   + juce::String (duration.maxMicroseconds, 1) + "us";
+        }
+
+        static juce::String formatCsv (const DurationSnapshot& duration)
+        {
+            return juce::String (duration.count) + "," + juce::String (duration.minMicroseconds, 2) + ","
+                   + juce::String (duration.meanMicroseconds, 2) + "," + juce::String (duration.maxMicroseconds, 2);
+        }
+    };
+
+    // Audio thread
+    Counter messagesPopped;
+    Counter ccsEmitted;
+    MaxGauge maxQueueDepth;
+    DurationStats processBlock;
+
+    // Editor thread
+    DurationStats editorTick;
+
+    // Direct output sender thread (see MidiSenderThread), which pops the queue instead
+    // of the audio thread
+    Counter messagesPoppedBySender;
+
+    /**
+     * @brief Reads all metrics.
+     *
+     * @param messagesPushed Messages pushed by the producer, ie. MessageQueueProducer::getNumPushed().
+     * @param messagesDropped Messages dropped by the producer, ie. MessageQueueProducer::getNumLost().
+     */
+    Snapshot getSnapshot (uint64_t messagesPushed, uint64_t messagesDropped)
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+
+        Snapshot snapshot;
+        snapshot.uptimeSeconds = juce::Time::highResolutionTicksToSeconds (now - createdTicks);
+        snapshot.messagesPushed = messagesPushed;
+        snapshot.messagesPopped = messagesPopped.get() + messagesPoppedBySender.get();
+        snapshot.messagesDropped = messagesDropped;
+        snapshot.maxQueueDepth = maxQueueDepth.get();
+        snapshot.ccsEmitted = ccsEmitted.get();
+        snapshot.processBlock = toSnapshot (processBlock);
+        snapshot.editorTick = toSnapshot (editorTick);
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (now - lastSnapshotTicks);
+        if (seconds > 0.0)
+            snapshot.ccsPerSecond = static_cast<double> (snapshot.ccsEmitted - lastCcsEmitted) / seconds;
+        lastSnapshotTicks = now;
+        lastCcsEmitted = snapshot.ccsEmitted;
+        return snapshot;
+    }
+
+private:
+    static DurationSnapshot toSnapshot (const DurationStats& stats)
+    {
+        DurationSnapshot snapshot;
+        snapshot.count = stats.count.load (std::memory_order_relaxed);
+        if (snapshot.count == 0)
+            return snapshot;
+
+        const auto microsecondsPerTick = 1.0e6 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+        snapshot.minMicroseconds = static_cast<double> (stats.minimum.load (std::memory_order_relaxed)) * microsecondsPerTick;
+        snapshot.maxMicroseconds = static_cast<double> (stats.maximum.load (std::memory_order_relaxed)) * microsecondsPerTick;
+        snapshot.meanMicroseconds = static_cast<double> (stats.total.load (std::memory_order_relaxed)) * microsecondsPerTick / static_cast<double> (snapshot.count);
+        return snapshot;
+    }
+
+    // Reader side, for rates between snapshots
+    const int64_t createdTicks = juce::Time::getHighResolutionTicks();
+    int64_t lastSnapshotTicks = createdTicks;
+    uint64_t lastCcsEmitted = 0;
+};
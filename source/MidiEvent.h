@@ -0,0 +1,228 @@
+/**
+ * @class MidiEvent
+ * @brief A MIDI message as it travels through the message queues, packed into 8 bytes.
+ *
+ * Holds the status byte and up to two data bytes, so every short MIDI message fits
+ * (CCs, program changes, notes, pitch bend, clock, ...), plus the index of the port
+ * or device it's meant for and its sample offset in the block it's sent in. Eight
+ * of them fit in a cache line, where the old four-int message only fit four.
+ *
+ * Longer messages (sysex) don't fit, so they go by reference: the bytes are copied
+ * into a slot of a SysexPool, and the event (status 0xF0) only carries the slot
+ * index. The consumer releases the slot once it copied the bytes out.
+ *
+ * NOTE: The event doesn't check anything, use the factory functions to build valid
+ * messages. Channels are 1-16, like juce::MidiMessage.
+ */
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+struct MidiEvent
+{
+    uint8_t bytes[3];      // Status byte, then the data bytes (or the sysex slot)
+    uint8_t port;          // Output port or device index, 0 is the default output
+    uint32_t sampleOffset; // Position in the audio block it's sent in
+
+    static constexpr uint8_t sysexStatus = 0xF0;
+
+    static MidiEvent controller (int channel, int number, int value, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0xB0, channel, number, value, port, sampleOffset);
+    }
+
+    static MidiEvent programChange (int channel, int program, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0xC0, channel, program, 0, port, sampleOffset);
+    }
+
+    static MidiEvent noteOn (int channel, int note, int velocity, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0x90, channel, note, velocity, port, sampleOffset);
+    }
+
+    static MidiEvent noteOff (int channel, int note, int velocity = 0, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0x80, channel, note, velocity, port, sampleOffset);
+    }
+
+    static MidiEvent polyPressure (int channel, int note, int pressure, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0xA0, channel, note, pressure, port, sampleOffset);
+    }
+
+    static MidiEvent channelPressure (int channel, int pressure, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0xD0, channel, pressure, 0, port, sampleOffset);
+    }
+
+    // 14 bit value, 0-16383, 8192 is centre
+    static MidiEvent pitchBend (int channel, int value, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return make (0xE0, channel, value & 0x7F, (value >> 7) & 0x7F, port, sampleOffset);
+    }
+
+    // MTC quarter frame (0xF1). pieceType 0-7, value 0-15.
+    static MidiEvent quarterFrame (int pieceType, int value, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return { { 0xF1, static_cast<uint8_t> (((pieceType & 0x07) << 4) | (value & 0x0F)), 0 }, port, sampleOffset };
+    }
+
+    // Song position pointer (0xF2), in sixteenth notes from the start, 0-16383
+    static MidiEvent songPosition (int sixteenths, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return { { 0xF2, static_cast<uint8_t> (sixteenths & 0x7F), static_cast<uint8_t> ((sixteenths >> 7) & 0x7F) }, port, sampleOffset };
+    }
+
+    // Song select (0xF3)
+    static MidiEvent songSelect (int song, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return { { 0xF3, static_cast<uint8_t> (song & 0x7F), 0 }, port, sampleOffset };
+    }
+
+    // System realtime and other status-only messages, ie. 0xF8 (clock). Use the
+    // factories above for system common messages with data bytes.
+    static MidiEvent system (uint8_t status, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return { { status, 0, 0 }, port, sampleOffset };
+    }
+
+    // A sysex message stored in a slot of a SysexPool
+    static MidiEvent sysex (int slot, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        return { { sysexStatus, static_cast<uint8_t> (slot & 0x7F), static_cast<uint8_t> ((slot >> 7) & 0x7F) }, port, sampleOffset };
+    }
+
+    uint8_t getStatus() const { return bytes[0]; }
+    int getChannel() const { return (bytes[0] & 0x0F) + 1; }
+
+    bool isController() const { return (bytes[0] & 0xF0) == 0xB0; }
+    bool isProgramChange() const { return (bytes[0] & 0xF0) == 0xC0; }
+    bool isSysex() const { return bytes[0] == sysexStatus; }
+
+    int getControllerNumber() const { return bytes[1]; }
+    int getControllerValue() const { return bytes[2]; }
+    int getProgramChangeNumber() const { return bytes[1]; }
+    int getPitchBendValue() const { return bytes[1] | (bytes[2] << 7); }
+    int getSongPosition() const { return bytes[1] | (bytes[2] << 7); }
+    int getSysexSlot() const { return bytes[1] | (bytes[2] << 7); }
+
+    /**
+     * @brief Number of MIDI bytes in bytes[], from the status byte. 0 for sysex, whose
+     * bytes are in the pool.
+     */
+    int getSize() const
+    {
+        const auto status = bytes[0];
+        if (status < 0xF0)
+            return (status & 0xE0) == 0xC0 ? 2 : 3; // Program change and channel pressure have one data byte
+        if (status == 0xF1 || status == 0xF3)
+            return 2;
+        if (status == 0xF2)
+            return 3;
+        return status == sysexStatus ? 0 : 1;
+    }
+
+    bool operator== (const MidiEvent& other) const
+    {
+        return std::memcmp (this, &other, sizeof (MidiEvent)) == 0;
+    }
+
+private:
+    static MidiEvent make (int type, int channel, int data1, int data2, uint8_t port, uint32_t sampleOffset)
+    {
+        return { { static_cast<uint8_t> (type | ((channel - 1) & 0x0F)), static_cast<uint8_t> (data1 & 0x7F), static_cast<uint8_t> (data2 & 0x7F) }, port, sampleOffset };
+    }
+};
+
+static_assert (sizeof (MidiEvent) == 8, "MidiEvent must stay 8 bytes");
+static_assert (std::is_trivially_copyable_v<MidiEvent>);
+
+/**
+ * @class SysexPool
+ * @brief Preallocated buffers for sysex messages travelling through a message queue.
+ *
+ * The producer stores the bytes with store() and pushes MidiEvent::sysex (slot). The
+ * consumer reads them with getData() / getSize(), then calls release(). Neither side
+ * allocates or locks, so the audio thread can be the consumer.
+ *
+ * NOTE: One producer and one consumer, like the queue it belongs to.
+ */
+class SysexPool
+{
+public:
+    static constexpr int numSlots = 16;
+    static constexpr size_t maxSize = 256;
+
+    /**
+     * @brief Copies a sysex message (including F0 and F7) into a free slot.
+     *
+     * @return int The slot, or -1 if no slot is free or the message is too long.
+     */
+    int store (const uint8_t* data, size_t size)
+    {
+        if (size > maxSize)
+            return -1;
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[static_cast<size_t> (i)];
+            if (slot.inUse.load (std::memory_order_acquire))
+                continue;
+
+            std::memcpy (slot.data.data(), data, size);
+            slot.size = size;
+            // Published to the consumer by pushing the event into the queue
+            slot.inUse.store (true, std::memory_order_relaxed);
+            return i;
+        }
+        return -1;
+    }
+
+    const uint8_t* getData (int slot) const { return slots[static_cast<size_t> (slot)].data.data(); }
+    size_t getSize (int slot) const { return slots[static_cast<size_t> (slot)].size; }
+
+    // Hands the slot back to the producer
+    void release (int slot) { slots[static_cast<size_t> (slot)].inUse.store (false, std::memory_order_release); }
+
+    int getNumInUse() const
+    {
+        int numInUse = 0;
+        for (const auto& slot : slots)
+            numInUse += slot.inUse.load() ? 1 : 0;
+        return numInUse;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> inUse { false };
+        size_t size = 0;
+        std::array<uint8_t, maxSize> data {};
+    };
+    std::array<Slot, numSlots> slots;
+};
+
+/**
+ * @brief Adds an event to a MidiBuffer at its sample offset. A sysex event's bytes are
+ * copied out of the pool and its slot is released.
+ */
+inline void addMidiEvent (juce::MidiBuffer& buffer, const MidiEvent& event, SysexPool& sysexPool)
+{
+    const auto samplePosition = static_cast<int> (event.sampleOffset);
+    if (! event.isSysex())
+    {
+        buffer.addEvent (event.bytes, event.getSize(), samplePosition);
+        return;
+    }
+
+    const auto slot = event.getSysexSlot();
+    buffer.addEvent (sysexPool.getData (slot), static_cast<int> (sysexPool.getSize (slot)), samplePosition);
+    sysexPool.release (slot);
+}
@@ -0,0 +1,223 @@
+/**
+ * @class MidiSenderThread
+ * @brief Sends the editor's CCs straight to a MIDI output, without waiting for processBlock.
+ *
+ * Normally, CCs only leave the app when the audio device calls processBlock, so the
+ * output latency follows the audio buffer size, and nothing is sent when no audio
+ * device is open. With direct output, a realtime priority thread consumes the message
+ * queue every periodMs instead (or right away when woken up), and sends every message
+ * with juce::MidiOutput::sendMessageNow from that thread. So the latency is bound by
+ * the period and the OS MIDI driver, not by JUCE's normal priority output thread.
+ * Short messages are built in place, only sysex longer than 8 bytes allocates (in
+ * juce::MidiMessage).
+ *
+ * The message queue is single consumer, so the sender and processBlock must never
+ * pop at the same time. QueueOwnership hands the consumer end back and forth between
+ * them without locks (see below).
+ *
+ * The program page CCs it sent are handed back to the audio thread with takeSentCcs(),
+ * so processBlock's decimator knows what the device has (one atomic per parameter,
+ * only the last value counts).
+ *
+ * NOTE: Only the editor's CCs take the direct path. Host automation, morphs, replays,
+ * OSC, shared memory control and Program Change recall are still sent from
+ * processBlock, so they need the audio device running.
+ */
+
+#pragma once
+
+#include <juce_audio_devices/juce_audio_devices.h>
+#include "ThreadSafeMessageQueue.h"
+#include "ParameterDefinitions.h"
+#include "Metrics.h"
+#include "RealtimeWatchdog.h"
+#include "Trace.h"
+
+/**
+ * @class QueueOwnership
+ * @brief Decides who owns the consumer end of the message queue: the audio thread or the sender.
+ *
+ * Dekker style: each side raises its own flag, then checks the other one (both with
+ * sequentially consistent ordering, so at least one of them sees the other's flag).
+ * The audio thread never waits. If direct output is on, it just skips the queue.
+ */
+class QueueOwnership
+{
+public:
+    /* Audio thread. Returns false if the sender owns the queue. Call audioThreadExit() after a true. */
+    bool audioThreadEnter()
+    {
+        audioThreadInQueue.store (true);
+        if (directOutput.load())
+        {
+            audioThreadInQueue.store (false);
+            return false;
+        }
+        return true;
+    }
+
+    void audioThreadExit() { audioThreadInQueue.store (false, std::memory_order_release); }
+
+    /* Sender thread. Waits for the audio thread to leave the queue, which takes at most one drain. */
+    void acquireForSender()
+    {
+        directOutput.store (true);
+        while (audioThreadInQueue.load())
+            std::this_thread::yield();
+    }
+
+    void releaseFromSender() { directOutput.store (false); }
+
+    bool isDirectOutput() const { return directOutput.load (std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> directOutput { false };
+    std::atomic<bool> audioThreadInQueue { false };
+};
+
+class MidiSenderThread : private juce::Thread
+{
+public:
+    static constexpr int defaultPeriodMs = 1;
+
+    MidiSenderThread (ThreadSafeMessageQueue& messageQueue, QueueOwnership& queueOwnership, Metrics::Counter& messagesPoppedCounter)
+        : juce::Thread ("MIDI Sender"), queue (messageQueue), ownership (queueOwnership), messagesPopped (messagesPoppedCounter)
+    {
+        for (auto& value : sentCcs)
+            value.store (-1);
+    }
+
+    ~MidiSenderThread() override
+    {
+        stop();
+    }
+
+    /**
+     * @brief Opens a MIDI output and starts sending the queued messages to it.
+     *
+     * @param deviceIdentifier The identifier of the output, see juce::MidiOutput::getAvailableDevices().
+     * @param newPeriodMs How often to check the queue, in milliseconds.
+     * @return bool True if the output could be opened, false otherwise.
+     */
+    bool start (const juce::String& deviceIdentifier, int newPeriodMs = defaultPeriodMs)
+    {
+        return start (juce::MidiOutput::openDevice (deviceIdentifier), newPeriodMs);
+    }
+
+    /**
+     * @brief Starts sending to an already opened output (ie. a virtual device).
+     */
+    bool start (std::unique_ptr<juce::MidiOutput> midiOutput, int newPeriodMs = defaultPeriodMs)
+    {
+        stop();
+
+        output = std::move (midiOutput);
+        if (output == nullptr)
+            return false;
+
+        periodMs = std::max (newPeriodMs, 1);
+        if (! startRealtimeThread (juce::Thread::RealtimeOptions {}.withPeriodMs (periodMs)))
+            startThread (juce::Thread::Priority::highest);
+        return true;
+    }
+
+    /**
+     * @brief Stops sending. Messages still in the queue go out through processBlock again.
+     */
+    void stop()
+    {
+        REALTIME_WATCHDOG_BLOCKING_CALL ("MidiSenderThread::stop");
+        stopThread (1000);
+        output.reset();
+    }
+
+    bool isSending() const { return isThreadRunning(); }
+
+    juce::String getDeviceName() const { return output != nullptr ? output->getName() : juce::String(); }
+
+    /**
+     * @brief Wakes the sender up, ie. right after pushing, to send without waiting for the period.
+     */
+    void wakeUp() { notify(); }
+
+    /**
+     * @brief Calls fn (index, value) for every parameter the sender sent a CC for since
+     * the last call, with the last value sent. Audio thread, doesn't allocate or lock.
+     */
+    template <typename Fn>
+    void takeSentCcs (Fn&& fn)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (sentCcs[i].load (std::memory_order_relaxed) < 0)
+                continue;
+            const auto value = sentCcs[i].exchange (-1, std::memory_order_acquire);
+            if (value >= 0)
+                fn (i, value);
+        }
+    }
+
+private:
+    void run() override
+    {
+        TRACE_RESERVED_THREAD_NAME ("MIDI Sender");
+        ownership.acquireForSender();
+
+        while (! threadShouldExit())
+        {
+            send();
+            wait (periodMs);
+        }
+
+        // Send what's queued now. Anything pushed later goes out through processBlock.
+        send();
+        ownership.releaseFromSender();
+    }
+
+    void send()
+    {
+        TRACE_SCOPE ("MidiSenderThread::send");
+        MidiEvent event;
+        uint64_t numPopped = 0;
+        while (queue.pop (event))
+        {
+            // There's no block here, so the sample offset doesn't apply: it goes out now
+            if (event.isSysex())
+            {
+                auto& sysexPool = queue.getSysexPool();
+                const auto slot = event.getSysexSlot();
+                output->sendMessageNow (juce::MidiMessage (sysexPool.getData (slot), static_cast<int> (sysexPool.getSize (slot))));
+                sysexPool.release (slot);
+            }
+            else
+            {
+                output->sendMessageNow (juce::MidiMessage (event.bytes, event.getSize()));
+                noteSent (event);
+            }
+            ++numPopped;
+        }
+        if (numPopped > 0)
+            messagesPopped.add (numPopped);
+    }
+
+    void noteSent (const MidiEvent& event)
+    {
+        if (! event.isController())
+            return;
+
+        const auto index = findParameterIndexByCc (event.getControllerNumber());
+        if (index >= 0)
+            sentCcs[static_cast<size_t> (index)].store (event.getControllerValue(), std::memory_order_release);
+    }
+
+    ThreadSafeMessageQueue& queue;
+    QueueOwnership& ownership;
+    Metrics::Counter& messagesPopped;
+    std::unique_ptr<juce::MidiOutput> output;
+    int periodMs = defaultPeriodMs;
+
+    // Last CC value sent per parameter, -1 once taken by the audio thread
+    std::array<std::atomic<int>, numParameters> sentCcs;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiSenderThread)
+};
@@ -0,0 +1,168 @@
+/**
+ * @class OscControlServer
+ * @brief Receives parameter changes over OSC (UDP, localhost only) and queues them as CCs.
+ *
+ * Lets other software on the same machine (show control, TouchOSC bridges, scripts)
+ * change program settings without the GUI. Every parameter from configuration.h has
+ * an address made from its name, ie. /0coast/MidiAChannel or /0coast/Portamento.
+ *
+ * The value is the first argument:
+ *  - int32: the raw parameter value, ie. 3 for MIDI channel 4
+ *  - float32: normalised 0..1 over the parameter range (like faders usually send)
+ * Values outside the range are clamped. Anything else is counted as rejected.
+ *
+ * Address patterns with OSC wildcards set every parameter they match, ie.
+ * /0coast/MidiA* with 0.0 sets all MIDI A parameters to their minimum. Accepted and
+ * dropped are counted per parameter.
+ *
+ * Messages are decoded on the receiver's network thread (RealtimeCallback), and pushed
+ * straight into a queue which processBlock drains, so there is no message thread hop.
+ * The server is the only producer of that queue.
+ *
+ * NOTE: The socket is bound to 127.0.0.1, so the server can't be reached from other
+ * machines.
+ */
+
+#pragma once
+
+#include <juce_osc/juce_osc.h>
+#include "ThreadSafeMessageQueue.h"
+#include "ParameterDefinitions.h"
+
+class OscControlServer : private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
+{
+public:
+    static constexpr int defaultPort = 9000;
+    static constexpr const char* addressPrefix = "/0coast/";
+
+    explicit OscControlServer (ThreadSafeMessageQueue& targetQueue) : queue (targetQueue)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            addresses[i] = std::make_unique<juce::OSCAddress> (juce::String (addressPrefix) + parameterDefinitions[i].name);
+
+        receiver.addListener (this);
+    }
+
+    ~OscControlServer() override
+    {
+        stop();
+        receiver.removeListener (this);
+    }
+
+    /**
+     * @brief Starts listening on 127.0.0.1.
+     *
+     * @param port The UDP port to listen on, or 0 to let the OS pick a free one (getPort()
+     * returns it).
+     * @return bool True if the port could be bound, false otherwise (ie. it's in use).
+     */
+    bool start (int port = defaultPort)
+    {
+        stop();
+
+        socket = std::make_unique<juce::DatagramSocket> (false);
+        if (! socket->bindToPort (port, "127.0.0.1") || ! receiver.connectToSocket (*socket))
+        {
+            socket.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void stop()
+    {
+        if (socket == nullptr)
+            return;
+
+        receiver.disconnect();
+        socket->shutdown();
+        socket.reset();
+    }
+
+    bool isRunning() const { return socket != nullptr; }
+    int getPort() const { return socket != nullptr ? socket->getBoundPort() : -1; }
+
+    uint64_t getNumAccepted() const { return numAccepted.load (std::memory_order_relaxed); }
+    uint64_t getNumRejected() const { return numRejected.load (std::memory_order_relaxed); }
+    uint64_t getNumDropped() const { return numDropped.load (std::memory_order_relaxed); }
+
+    /**
+     * @brief Decodes a message and queues a CC for every parameter its address matches.
+     * Called on the network thread.
+     *
+     * @return bool True if all CCs were queued, false if it was rejected or the queue was full.
+     */
+    bool handleMessage (const juce::OSCMessage& message)
+    {
+        const auto& pattern = message.getAddressPattern();
+        if (message.isEmpty() || ! (message[0].isInt32() || message[0].isFloat32()))
+        {
+            numRejected.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto numMatched = 0;
+        auto allQueued = true;
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (! pattern.matches (*addresses[i]))
+                continue;
+
+            ++numMatched;
+            if (queue.push (MidiEvent::controller (MIDI_CHANNEL, parameterDefinitions[i].cc, getValue (parameterDefinitions[i], message[0]))))
+                numAccepted.fetch_add (1, std::memory_order_relaxed);
+            else
+            {
+                numDropped.fetch_add (1, std::memory_order_relaxed);
+                allQueued = false;
+            }
+        }
+
+        if (numMatched == 0)
+        {
+            numRejected.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+        return allQueued;
+    }
+
+private:
+    void oscMessageReceived (const juce::OSCMessage& message) override
+    {
+        handleMessage (message);
+    }
+
+    void oscBundleReceived (const juce::OSCBundle& bundle) override
+    {
+        for (const auto& element : bundle)
+        {
+            if (element.isMessage())
+                handleMessage (element.getMessage());
+            else if (element.isBundle())
+                oscBundleReceived (element.getBundle());
+        }
+    }
+
+    // The argument as a value of the parameter, clamped to its range
+    static int getValue (const ParameterDefinition& definition, const juce::OSCArgument& argument)
+    {
+        int value = 0;
+        if (argument.isInt32())
+            value = argument.getInt32();
+        else
+            value = definition.minValue + juce::roundToInt (juce::jlimit (0.0f, 1.0f, argument.getFloat32()) * static_cast<float> (definition.maxValue - definition.minValue));
+
+        return juce::jlimit (definition.minValue, definition.maxValue, value);
+    }
+
+    ThreadSafeMessageQueue& queue;
+    juce::OSCReceiver receiver { "OSC Control" };
+    std::unique_ptr<juce::DatagramSocket> socket;
+    std::array<std::unique_ptr<juce::OSCAddress>, numParameters> addresses;
+
+    std::atomic<uint64_t> numAccepted { 0 };
+    std::atomic<uint64_t> numRejected { 0 };
+    std::atomic<uint64_t> numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (OscControlServer)
+};
@@ -0,0 +1,104 @@
+/**
+ * @file ParameterDefinitions.h
+ * @brief A table of all 0-Coast program page parameters, built from configuration.h
+ *
+ * configuration.h defines every parameter as a handful of macros. This file gathers
+ * those macros into one constexpr table, so code that needs to handle "all parameters"
+ * (host parameters, snapshots, exports, etc) can loop over it by index instead of
+ * spelling out every macro by hand.
+ *
+ * The order of the table is the order of the UI (column by column, top to bottom).
+ * Code which stores parameter values by index depends on this order, so only append!
+ */
+
+#pragma once
+
+#include "configuration.h"
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+struct ParameterDefinition
+{
+    const char* name;
+    int cc;
+    int defaultValue;
+    int minValue;
+    int maxValue;
+    bool isDiscrete; // True for combo box parameters (on/off, channel, CV/gate source)
+};
+
+inline constexpr std::array<ParameterDefinition, 18> parameterDefinitions { {
+    // Play Modes
+    { ENABLE_ARP_NAME, ENABLE_ARP_CC, ENABLE_ARP_VALUE, ENABLE_ARP_MIN_VALUE, ENABLE_ARP_MAX_VALUE, true },
+    { ARP_TYPE_NAME, ARP_TYPE_CC, ARP_TYPE_VALUE, ARP_TYPE_MIN_VALUE, ARP_TYPE_MAX_VALUE, true },
+    { ENABLE_LEGATO_NAME, ENABLE_LEGATO_CC, ENABLE_LEGATO_VALUE, ENABLE_LEGATO_MIN_VALUE, ENABLE_LEGATO_MAX_VALUE, true },
+    { PORTAMENTO_NAME, PORTAMENTO_CC, PORTAMENTO_VALUE, PORTAMENTO_MIN_VALUE, PORTAMENTO_MAX_VALUE, false },
+
+    // Clocks
+    { ENABLE_MIDI_CLK_NAME, ENABLE_MIDI_CLK_CC, ENABLE_MIDI_CLK_VALUE, ENABLE_MIDI_CLK_MIN_VALUE, ENABLE_MIDI_CLK_MAX_VALUE, true },
+    { TEMPO_IN_DIV_NAME, TEMPO_IN_DIV_CC, TEMPO_IN_DIV_VALUE, TEMPO_IN_DIV_MIN_VALUE, TEMPO_IN_DIV_MAX_VALUE, false },
+
+    // MIDI A
+    { MIDI_A_CHANNEL_NAME, MIDI_A_CHANNEL_CC, MIDI_A_CHANNEL_VALUE, MIDI_A_CHANNEL_MIN_VALUE, MIDI_A_CHANNEL_MAX_VALUE, true },
+    { MIDI_A_CV_NAME, MIDI_A_CV_CC, MIDI_A_CV_VALUE, MIDI_A_CV_MIN_VALUE, MIDI_A_CV_MAX_VALUE, true },
+    { MIDI_A_GATE_NAME, MIDI_A_GATE_CC, MIDI_A_GATE_VALUE, MIDI_A_GATE_MIN_VALUE, MIDI_A_GATE_MAX_VALUE, true },
+    { MIDI_A_PITCH_NAME, MIDI_A_PITCH_CC, MIDI_A_PITCH_VALUE, MIDI_A_PITCH_MIN_VALUE, MIDI_A_PITCH_MAX_VALUE, false },
+    { MIDI_A_AFTERTOUCH_NAME, MIDI_A_AFTERTOUCH_CC, MIDI_A_AFTERTOUCH_VALUE, MIDI_A_AFTERTOUCH_MIN_VALUE, MIDI_A_AFTERTOUCH_MAX_VALUE, false },
+    { MIDI_A_VELOCITY_NAME, MIDI_A_VELOCITY_CC, MIDI_A_VELOCITY_VALUE, MIDI_A_VELOCITY_MIN_VALUE, MIDI_A_VELOCITY_MAX_VALUE, false },
+
+    // MIDI B
+    { MIDI_B_CHANNEL_NAME, MIDI_B_CHANNEL_CC, MIDI_B_CHANNEL_VALUE, MIDI_B_CHANNEL_MIN_VALUE, MIDI_B_CHANNEL_MAX_VALUE, true },
+    { MIDI_B_CV_NAME, MIDI_B_CV_CC, MIDI_B_CV_VALUE, MIDI_B_CV_MIN_VALUE, MIDI_B_CV_MAX_VALUE, true },
+    { MIDI_B_GATE_NAME, MIDI_B_GATE_CC, MIDI_B_GATE_VALUE, MIDI_B_GATE_MIN_VALUE, MIDI_B_GATE_MAX_VALUE, true },
+    { MIDI_B_PITCH_NAME, MIDI_B_PITCH_CC, MIDI_B_PITCH_VALUE, MIDI_B_PITCH_MIN_VALUE, MIDI_B_PITCH_MAX_VALUE, false },
+    { MIDI_B_AFTERTOUCH_NAME, MIDI_B_AFTERTOUCH_CC, MIDI_B_AFTERTOUCH_VALUE, MIDI_B_AFTERTOUCH_MIN_VALUE, MIDI_B_AFTERTOUCH_MAX_VALUE, false },
+    { MIDI_B_VELOCITY_NAME, MIDI_B_VELOCITY_CC, MIDI_B_VELOCITY_VALUE, MIDI_B_VELOCITY_MIN_VALUE, MIDI_B_VELOCITY_MAX_VALUE, false },
+} };
+
+inline constexpr size_t numParameters = parameterDefinitions.size();
+
+/**
+ * @brief Looks up the index of a parameter from its CC number.
+ *
+ * @param cc The control change (CC) number to look for.
+ * @return int The index into parameterDefinitions, or -1 if no parameter uses this CC.
+ */
+constexpr int findParameterIndexByCc (int cc)
+{
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        if (parameterDefinitions[i].cc == cc)
+            return static_cast<int> (i);
+    }
+    return -1;
+}
+
+/**
+ * @brief Looks up the index of a parameter from its name.
+ *
+ * @param name The name of the parameter, as defined in configuration.h.
+ * @return int The index into parameterDefinitions, or -1 if no parameter has this name.
+ */
+constexpr int findParameterIndexByName (std::string_view name)
+{
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        if (name == parameterDefinitions[i].name)
+            return static_cast<int> (i);
+    }
+    return -1;
+}
+
+/**
+ * @brief Compile-time index of a parameter, ie. parameterIndex (PORTAMENTO_NAME).
+ *
+ * Fails to compile if no parameter has this name.
+ */
+consteval size_t parameterIndex (std::string_view name)
+{
+    const auto index = findParameterIndexByName (name);
+    if (index < 0)
+        throw "Unknown parameter name";
+    return static_cast<size_t> (index);
+}
@@ -0,0 +1,63 @@
+/**
+ * @class ParameterState
+ * @brief The current value of every program page parameter, owned by the processor.
+ *
+ * This is the one place which says what the device is set to. Everything which
+ * changes a parameter writes it here: the editor when a widget is moved, and
+ * processBlock for automation, morphs, replays, OSC and shared memory control.
+ * The host parameters follow it (see ProgrammerProcessor::syncHostParameters), and
+ * the plugin state is saved from it. Editors are views on it. A new editor reads
+ * a snapshot to set up its widgets, and on every tick shows the values which
+ * changed elsewhere, so nothing is re-sent when an editor opens and any number of
+ * editors (or none) can be attached.
+ *
+ * Each value is a separate atomic byte, so reads and writes are lock-free and
+ * realtime-safe from any thread. A snapshot is not taken atomically as a whole,
+ * but every value in it is one that was written.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <atomic>
+
+class ParameterState
+{
+public:
+    ParameterState()
+    {
+        set (ProgramState::defaults());
+    }
+
+    uint8_t get (size_t index) const
+    {
+        return values[index].load (std::memory_order_relaxed);
+    }
+
+    void set (size_t index, uint8_t value)
+    {
+        values[index].store (value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies all values into a plain state, ie. to set up a new view.
+     */
+    ProgramState getSnapshot() const
+    {
+        ProgramState state {};
+        for (size_t i = 0; i < numParameters; ++i)
+            state[i] = get (i);
+        return state;
+    }
+
+    void set (const ProgramState& state)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            set (i, state[i]);
+    }
+
+private:
+    std::array<std::atomic<uint8_t>, numParameters> values;
+
+    static_assert (std::atomic<uint8_t>::is_always_lock_free);
+};
@@ -1,31 +1,18 @@
 #include "PluginEditor.h"
+#include "PresetImporter.h"
 #include "configuration.h"
 
 ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     : AudioProcessorEditor (&p), processorRef (p)
 {
     juce::ignoreUnused (processorRef);
-#ifdef NDEBUG
-    // If we're in release mode, disable the inspector
+#if ! PROGRAMMER_INSPECTOR
+    // The inspector is only built in debug builds
     enableInspector = false;
 #else
     juce::Logger::outputDebugString (">>> ProgrammerEditor: Started in DEBUG mode");
 #endif
 
-    /* MELATONIN UI INSPECTOR */
-    addAndMakeVisible (inspectButton);
-
-    // this chunk of code instantiates and opens the melatonin inspector
-    inspectButton.onClick = [&] {
-        if (!inspector)
-        {
-            inspector = std::make_unique<melatonin::Inspector> (*this);
-            inspector->onClose = [this]() { inspector.reset(); };
-        }
-
-        inspector->setVisible (true);
-    };
-
     // Calculate the size of the UI
     // Height is header + content items + spacers + help text (1xcontent) + footer
     auto height = headerHeight + contentItemHeight*numberOfContentItems + numberOfSpacers*separatorHeight + contentItemHeight;;
@@ -40,11 +27,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     auto width = columnWidth + ((numberOfColumns-1) * (contentWidth + rightSidebarWidth));
     setSize (width, height);
 
-    // Start timer - this is used to scan the UI for changes
-    // NOTE: Currently scanning once per second - this should be faster for a snappy UI.
-    // But currently nice for debugging.
-    startTimerHz(1);
-
     // Add headers and footers for each column
     for (size_t col = 0; col < static_cast<size_t>(numberOfColumns); ++col)
     {
@@ -78,7 +60,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     arpEnable.addItem ("On", 2);
     arpEnable.setSelectedId (1);
     arpEnable.setLabelWidth (labelWidth);
-    params.addParameter (ENABLE_ARP_NAME, ENABLE_ARP_CC, ENABLE_ARP_VALUE, ENABLE_ARP_MIN_VALUE, ENABLE_ARP_MAX_VALUE);
 
     // Add ARP TYPE
     addAndMakeVisible (arpTypeMenu);
@@ -87,7 +68,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     arpTypeMenu.addItem ("Latch", 2);
     arpTypeMenu.setSelectedId (1);
     arpTypeMenu.setLabelWidth (labelWidth);
-    params.addParameter (ARP_TYPE_NAME, ARP_TYPE_CC, ARP_TYPE_VALUE, ARP_TYPE_MIN_VALUE, ARP_TYPE_MAX_VALUE);
 
     // Add LEGATO ENABLE
     addAndMakeVisible (legatoEnable);
@@ -96,13 +76,11 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     legatoEnable.addItem ("On", 2);
     legatoEnable.setSelectedId (1);
     legatoEnable.setLabelWidth (labelWidth);
-    params.addParameter (ENABLE_LEGATO_NAME, ENABLE_LEGATO_CC, ENABLE_LEGATO_VALUE, ENABLE_LEGATO_MIN_VALUE, ENABLE_LEGATO_MAX_VALUE);
 
     // Add PORTAMENTO SLIDER
     addAndMakeVisible (portamentoSlider);
     portamentoSlider.setText (PORTAMENTO_NAME);
     portamentoSlider.setLabelWidth (labelWidth);
-    params.addParameter (PORTAMENTO_NAME, PORTAMENTO_CC, PORTAMENTO_VALUE, PORTAMENTO_MIN_VALUE, PORTAMENTO_MAX_VALUE);
 
     // -- Add column 1 content items --
     // Add MIDI Clock Enable
@@ -112,14 +90,12 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     midiClkEnable.addItem ("On", 2);
     midiClkEnable.setSelectedId (1);
     midiClkEnable.setLabelWidth (labelWidth);
-    params.addParameter (ENABLE_MIDI_CLK_NAME, ENABLE_MIDI_CLK_CC, ENABLE_MIDI_CLK_VALUE, ENABLE_MIDI_CLK_MIN_VALUE, ENABLE_MIDI_CLK_MAX_VALUE);
 
     // Add Tempo in Divisions
     addAndMakeVisible (tempoInDiv);
     tempoInDiv.setText ("Tempo In Div");
     tempoInDiv.setRange (TEMPO_IN_DIV_MIN_VALUE, TEMPO_IN_DIV_MAX_VALUE, 1);
     tempoInDiv.setLabelWidth (labelWidth);
-    params.addParameter (TEMPO_IN_DIV_NAME, TEMPO_IN_DIV_CC, TEMPO_IN_DIV_VALUE, TEMPO_IN_DIV_MIN_VALUE, TEMPO_IN_DIV_MAX_VALUE);
 
     // -- Add column 2 content items --
     // Add MIDI A Channel
@@ -132,7 +108,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiAChannel.addItem ("All", 17);
     MidiAChannel.setSelectedId (1);
     MidiAChannel.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_CHANNEL_NAME, MIDI_A_CHANNEL_CC, MIDI_A_CHANNEL_VALUE, MIDI_A_CHANNEL_MIN_VALUE, MIDI_A_CHANNEL_MAX_VALUE);
     // Add MIDI A CV
     addAndMakeVisible (MidiACV);
     MidiACV.setText ("CV");
@@ -142,7 +117,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiACV.addItem ("LFO", 4);
     MidiACV.setSelectedId (1);
     MidiACV.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_CV_NAME, MIDI_A_CV_CC, MIDI_A_CV_VALUE, MIDI_A_CV_MIN_VALUE, MIDI_A_CV_MAX_VALUE);
     // Add MIDI A Gate
     addAndMakeVisible (MidiAGate);
     MidiAGate.setText ("Gate");
@@ -152,25 +126,21 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiAGate.addItem ("LFO", 4);
     MidiAGate.setSelectedId (1);
     MidiAGate.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_GATE_NAME, MIDI_A_GATE_CC, MIDI_A_GATE_VALUE, MIDI_A_GATE_MIN_VALUE, MIDI_A_GATE_MAX_VALUE);
     // Add MIDI A Pitch Scale
     addAndMakeVisible (MidiAPitchScale);
     MidiAPitchScale.setText ("Pitchbend Scale");
     MidiAPitchScale.setRange (MIDI_A_PITCH_MIN_VALUE, MIDI_A_PITCH_MAX_VALUE, 1);
     MidiAPitchScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_PITCH_NAME, MIDI_A_PITCH_CC, MIDI_A_PITCH_VALUE, MIDI_A_PITCH_MIN_VALUE, MIDI_A_PITCH_MAX_VALUE);
     // Add MIDI A Aftertouch Scale
     addAndMakeVisible (MidiAAftertouchScale);
     MidiAAftertouchScale.setText ("Aftertouch Scale");
     MidiAAftertouchScale.setRange (MIDI_A_AFTERTOUCH_MIN_VALUE, MIDI_A_AFTERTOUCH_MAX_VALUE, 1);
     MidiAAftertouchScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_AFTERTOUCH_NAME, MIDI_A_AFTERTOUCH_CC, MIDI_A_AFTERTOUCH_VALUE, MIDI_A_AFTERTOUCH_MIN_VALUE, MIDI_A_AFTERTOUCH_MAX_VALUE);
     // Add MIDI A Velocity Scale
     addAndMakeVisible (MidiAVelocityScale);
     MidiAVelocityScale.setText ("Velocity Scale");
     MidiAVelocityScale.setRange (MIDI_A_VELOCITY_MIN_VALUE, MIDI_A_VELOCITY_MAX_VALUE, 1);
     MidiAVelocityScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_A_VELOCITY_NAME, MIDI_A_VELOCITY_CC, MIDI_A_VELOCITY_VALUE, MIDI_A_VELOCITY_MIN_VALUE, MIDI_A_VELOCITY_MAX_VALUE);
 
     // -- Add column 3 content items --
     // Add MIDI B Channel
@@ -183,7 +153,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiBChannel.addItem ("All", 17);
     MidiBChannel.setSelectedId (1);
     MidiBChannel.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_CHANNEL_NAME, MIDI_B_CHANNEL_CC, MIDI_B_CHANNEL_VALUE, MIDI_B_CHANNEL_MIN_VALUE, MIDI_B_CHANNEL_MAX_VALUE);
     // Add MIDI B CV
     addAndMakeVisible (MidiBCV);
     MidiBCV.setText ("CV");
@@ -193,7 +162,6 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiBCV.addItem ("LFO", 4);
     MidiBCV.setSelectedId (1);
     MidiBCV.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_CV_NAME, MIDI_B_CV_CC, MIDI_B_CV_VALUE, MIDI_B_CV_MIN_VALUE, MIDI_B_CV_MAX_VALUE);
     // Add MIDI B Gate
     addAndMakeVisible (MidiBGate);
     MidiBGate.setText ("Gate");
@@ -203,33 +171,137 @@ ProgrammerEditor::ProgrammerEditor (ProgrammerProcessor& p)
     MidiBGate.addItem ("LFO", 4);
     MidiBGate.setSelectedId (1);
     MidiBGate.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_GATE_NAME, MIDI_B_GATE_CC, MIDI_B_GATE_VALUE, MIDI_B_GATE_MIN_VALUE, MIDI_B_GATE_MAX_VALUE);
     // Add MIDI B Pitch Scale
     addAndMakeVisible (MidiBPitchScale);
     MidiBPitchScale.setText ("Pitchbend Scale");
     MidiBPitchScale.setRange (MIDI_B_PITCH_MIN_VALUE, MIDI_B_PITCH_MAX_VALUE, 1);
     MidiBPitchScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_PITCH_NAME, MIDI_B_PITCH_CC, MIDI_B_PITCH_VALUE, MIDI_B_PITCH_MIN_VALUE, MIDI_B_PITCH_MAX_VALUE);
     // Add MIDI B Aftertouch Scale
     addAndMakeVisible (MidiBAftertouchScale);
     MidiBAftertouchScale.setText ("Aftertouch Scale");
     MidiBAftertouchScale.setRange (MIDI_B_AFTERTOUCH_MIN_VALUE, MIDI_B_AFTERTOUCH_MAX_VALUE, 1);
     MidiBAftertouchScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_AFTERTOUCH_NAME, MIDI_B_AFTERTOUCH_CC, MIDI_B_AFTERTOUCH_VALUE, MIDI_B_AFTERTOUCH_MIN_VALUE, MIDI_B_AFTERTOUCH_MAX_VALUE);
     // Add MIDI B Velocity Scale
     addAndMakeVisible (MidiBVelocityScale);
     MidiBVelocityScale.setText ("Velocity Scale");
     MidiBVelocityScale.setRange (MIDI_B_VELOCITY_MIN_VALUE, MIDI_B_VELOCITY_MAX_VALUE, 1);
     MidiBVelocityScale.setLabelWidth (labelWidth);
-    params.addParameter (MIDI_B_VELOCITY_NAME, MIDI_B_VELOCITY_CC, MIDI_B_VELOCITY_VALUE, MIDI_B_VELOCITY_MIN_VALUE, MIDI_B_VELOCITY_MAX_VALUE);
+
+    // Add direct MIDI output selection. Only in the Standalone app, as plugins
+    // send through the host. The devices are listed after the first paint.
+    if (processorRef.wrapperType == juce::AudioProcessor::wrapperType_Standalone)
+    {
+        addAndMakeVisible (directOutputMenu);
+        directOutputMenu.setText ("Direct Out");
+        directOutputMenu.addItem ("Off (via audio)", 1);
+        directOutputMenu.setSelectedId (1);
+        directOutputMenu.setLabelWidth (labelWidth);
+        directOutputMenu.onChange = [this] { directOutputChanged(); };
+    }
+
+    // Add OSC control server switch (localhost only)
+    addAndMakeVisible (oscServerMenu);
+    oscServerMenu.setText ("OSC In");
+    oscServerMenu.addItem ("Off", 1);
+    oscServerMenu.addItem ("On (port " + juce::String (OscControlServer::defaultPort) + ")", 2);
+    oscServerMenu.setSelectedId (processorRef.isOscServerRunning() ? 2 : 1);
+    oscServerMenu.setLabelWidth (labelWidth);
+    oscServerMenu.onChange = [this] { oscServerChanged(); };
+
+    // Add shared memory control switch (for sequencers in another process)
+    addAndMakeVisible (sharedControlMenu);
+    sharedControlMenu.setText ("Shared Mem In");
+    sharedControlMenu.addItem ("Off", 1);
+    sharedControlMenu.addItem ("On", 2);
+    sharedControlMenu.setSelectedId (processorRef.isSharedControlActive() ? 2 : 1);
+    sharedControlMenu.setLabelWidth (labelWidth);
+    sharedControlMenu.onChange = [this] { sharedControlChanged(); };
+
+    // Add program change recall bank selection
+    addAndMakeVisible (recallMenu);
+    recallMenu.setText ("PC Recall");
+    recallMenu.setLabelWidth (labelWidth);
+    recallMenu.onChange = [this] { recallMenuChanged(); };
+    updateRecallMenu();
+
+    // Warning shown when the message queue overflowed and updates were dropped
+    addChildComponent (overflowWarning);
+    overflowWarning.setColour (juce::Label::textColourId, juce::Colours::orange);
+    overflowWarning.setJustificationType (juce::Justification::centredLeft);
+
+    // Show what the device is set to. This is only a read, nothing is sent.
+    // The undo history starts from there too. Keyboard focus is needed for the
+    // undo/redo shortcuts.
+    TRACE_RESERVED_THREAD_NAME ("Message Thread");
+    shownState = processorRef.parameterState.getSnapshot();
+    setWidgetState (shownState);
+    undoHistory.reset (shownState);
+    setWantsKeyboardFocus (true);
+
+    // Scan the UI for changes on every tick, on the processor's scheduler
+    // NOTE: Currently scanning once per second - this should be faster for a snappy UI.
+    // But currently nice for debugging.
+    tickId = processorRef.getScheduler().callEvery (tickIntervalMs, [this] { tick(); });
 }
 
 ProgrammerEditor::~ProgrammerEditor()
 {
+    processorRef.getScheduler().cancel (tickId);
+    cancelPendingUpdate();
+    backgroundJobs.cancel();
+}
+
+void ProgrammerEditor::handleAsyncUpdate()
+{
+    // Secondary setup, which runs after the first frame is on screen
+    if (deferredSetupDone)
+        return;
+    deferredSetupDone = true;
+
+    // Scanning the MIDI devices can take a while, depending on the OS and drivers,
+    // so it runs in the background and fills the menu when done
+    if (processorRef.wrapperType == juce::AudioProcessor::wrapperType_Standalone)
+    {
+        auto devices = std::make_shared<juce::Array<juce::MidiDeviceInfo>>();
+        processorRef.executor->submit (
+            [devices] { *devices = juce::MidiOutput::getAvailableDevices(); },
+            BackgroundExecutor::Priority::high,
+            backgroundJobs,
+            [this, devices] (bool wasCancelled) {
+                if (wasCancelled)
+                    return;
+                directOutputDevices = *devices;
+                for (int i = 0; i < directOutputDevices.size(); ++i)
+                    directOutputMenu.addItem (directOutputDevices[i].name, i + 2);
+            });
+    }
+
+#if PROGRAMMER_INSPECTOR
+    /* MELATONIN UI INSPECTOR */
+    if (enableInspector == true)
+    {
+        inspectButton = std::make_unique<juce::TextButton> ("Inspect the UI");
+        addAndMakeVisible (*inspectButton);
+
+        // this chunk of code instantiates and opens the melatonin inspector
+        inspectButton->onClick = [&] {
+            if (!inspector)
+            {
+                inspector = std::make_unique<melatonin::Inspector> (*this);
+                inspector->onClose = [this]() { inspector.reset(); };
+            }
+
+            inspector->setVisible (true);
+        };
+        repaint();
+    }
+#endif
 }
 
 void ProgrammerEditor::paint (juce::Graphics& g)
 {
+    TRACE_SCOPE ("ProgrammerEditor::paint");
+
     // NOTE: Move much of this to resized when adding support for resizing UI
 
     // (Our component is opaque, so we must completely fill the background with a solid colour)
@@ -241,11 +313,15 @@ void ProgrammerEditor::paint (juce::Graphics& g)
     // Define area for UI
     auto area = getLocalBounds();
     
-    // Add debug label if needed
+    // Add debug label if needed, with the runtime metrics below it
     if (enableInspector == true)
     {
         auto helloWorld = juce::String ("Hello from ") + PRODUCT_NAME_WITHOUT_VERSION + " v" VERSION + " running in " + CMAKE_BUILD_TYPE;
-        g.drawText (helloWorld, area.removeFromBottom (footerHeight), juce::Justification::centred, false);
+        auto footer = area.removeFromBottom (footerHeight);
+        g.drawText (helloWorld, footer.removeFromTop (footerHeight / 2), juce::Justification::centred, false);
+        g.setFont (12.0f);
+        g.drawText (metricsText, footer, juce::Justification::centred, false);
+        g.setFont (16.0f);
     }
 
     // Draw sidebar spacers
@@ -256,12 +332,18 @@ void ProgrammerEditor::paint (juce::Graphics& g)
     if (enableInspector == true)
     {      
         // Draw inspector-button
-        inspectButton.setBounds (area.removeFromBottom(inspectButtonHeight));
+        auto inspectButtonArea = area.removeFromBottom(inspectButtonHeight);
+       #if PROGRAMMER_INSPECTOR
+        if (inspectButton != nullptr)
+            inspectButton->setBounds (inspectButtonArea);
+       #endif
+        juce::ignoreUnused (inspectButtonArea);
     }
     else
     {
         g.drawText ("", area.removeFromBottom (headerHeight), juce::Justification::centred, false);
     }
+    overflowWarning.setBounds (area.getX(), getHeight() - headerHeight, columnWidth, headerHeight);
 
     // -- Calculate bounding boxes for UI elements --
     // We'll calculate bounding boxes for each of the UI elements (content, headers, etc)
@@ -319,6 +401,10 @@ void ProgrammerEditor::paint (juce::Graphics& g)
     // Draw content items for column 1
     midiClkEnable.setBounds (contentAreas[1][0]);
     tempoInDiv.setBounds (contentAreas[1][1]);
+    recallMenu.setBounds (contentAreas[1][2]);
+    directOutputMenu.setBounds (contentAreas[1][3]);
+    oscServerMenu.setBounds (contentAreas[1][4]);
+    sharedControlMenu.setBounds (contentAreas[1][5]);
 
     // Draw content items for column 2
     MidiAChannel.setBounds (contentAreas[2][0]);
@@ -348,6 +434,9 @@ void ProgrammerEditor::paint (juce::Graphics& g)
         }
     }
 
+    // The first frame is done, now do the rest of the setup
+    if (! deferredSetupDone)
+        triggerAsyncUpdate();
 }
 
 void ProgrammerEditor::resized()
@@ -355,73 +444,263 @@ void ProgrammerEditor::resized()
     // At some point, let's enable resizing of the UI and paint stuff here   
 }
 
-void ProgrammerEditor::timerCallback()
+bool ProgrammerEditor::keyPressed (const juce::KeyPress& key)
 {
-    // Update the parameter value based on the button states
-    params.setParameter (ENABLE_ARP_NAME, arpEnable.getValue());
-    params.setParameter (ARP_TYPE_NAME, arpTypeMenu.getValue());
-    params.setParameter (ENABLE_LEGATO_NAME, legatoEnable.getValue());
-    params.setParameter (PORTAMENTO_NAME, (int)portamentoSlider.getValue());
-
-    params.setParameter (ENABLE_MIDI_CLK_NAME, midiClkEnable.getValue());
-    params.setParameter (TEMPO_IN_DIV_NAME, (int)tempoInDiv.getValue());
-
-    params.setParameter (MIDI_A_CHANNEL_NAME, MidiAChannel.getValue());
-    params.setParameter (MIDI_A_CV_NAME, MidiACV.getValue());
-    params.setParameter (MIDI_A_GATE_NAME, MidiAGate.getValue());
-    params.setParameter (MIDI_A_PITCH_NAME, (int)MidiAPitchScale.getValue());
-    params.setParameter (MIDI_A_AFTERTOUCH_NAME, (int)MidiAAftertouchScale.getValue());
-    params.setParameter (MIDI_A_VELOCITY_NAME, (int)MidiAVelocityScale.getValue());
-    
-    params.setParameter (MIDI_B_CHANNEL_NAME, MidiBChannel.getValue());
-    params.setParameter (MIDI_B_CV_NAME, MidiBCV.getValue());
-    params.setParameter (MIDI_B_GATE_NAME, MidiBGate.getValue());
-    params.setParameter (MIDI_B_PITCH_NAME, (int)MidiBPitchScale.getValue());
-    params.setParameter (MIDI_B_AFTERTOUCH_NAME, (int)MidiBAftertouchScale.getValue());
-    params.setParameter (MIDI_B_VELOCITY_NAME, (int)MidiBVelocityScale.getValue());
-    
-    params.setParameter (ENABLE_MIDI_CLK_NAME, midiClkEnable.getValue());
-    params.setParameter (TEMPO_IN_DIV_NAME, (int)tempoInDiv.getValue());
-
-    params.setParameter (MIDI_A_CHANNEL_NAME, MidiAChannel.getValue());
-    params.setParameter (MIDI_A_CV_NAME, MidiACV.getValue());
-    params.setParameter (MIDI_A_GATE_NAME, MidiAGate.getValue());
-    params.setParameter (MIDI_A_PITCH_NAME, (int)MidiAPitchScale.getValue());
-    params.setParameter (MIDI_A_AFTERTOUCH_NAME, (int)MidiAAftertouchScale.getValue());
-    params.setParameter (MIDI_A_VELOCITY_NAME, (int)MidiAVelocityScale.getValue());
-    
-    params.setParameter (MIDI_B_CHANNEL_NAME, MidiBChannel.getValue());
-    params.setParameter (MIDI_B_CV_NAME, MidiBCV.getValue());
-    params.setParameter (MIDI_B_GATE_NAME, MidiBGate.getValue());
-    params.setParameter (MIDI_B_PITCH_NAME, (int)MidiBPitchScale.getValue());
-    params.setParameter (MIDI_B_AFTERTOUCH_NAME, (int)MidiBAftertouchScale.getValue());
-    params.setParameter (MIDI_B_VELOCITY_NAME, (int)MidiBVelocityScale.getValue());
-    
-    // Iterate over parameters and check if they are updated
-    auto allParams = params.getAllParameters();
-    for (const auto& param : allParams)
+    const auto undoKey = juce::KeyPress ('z', juce::ModifierKeys::commandModifier, 0);
+    const auto redoKey = juce::KeyPress ('z', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0);
+    const auto redoKeyAlt = juce::KeyPress ('y', juce::ModifierKeys::commandModifier, 0);
+
+    if (key == undoKey)
+    {
+        undo();
+        return true;
+    }
+    if (key == redoKey || key == redoKeyAlt)
     {
-        auto paramName = param.first;
-        if (params.isParameterUpdated(paramName) == true)
+        redo();
+        return true;
+    }
+
+#if PROGRAMMER_TRACING
+    // Write the trace so far, next to the one written at exit
+    if (key == juce::KeyPress ('t', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        const auto file = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("0-Programmer-trace-now.json");
+        if (Trace::writeJson (file.getFullPathName().toStdString()))
+            juce::Logger::outputDebugString ("Trace written to " + file.getFullPathName());
+        return true;
+    }
+#endif
+    return false;
+}
+
+void ProgrammerEditor::undo()
+{
+    ProgramState state;
+    if (undoHistory.undo (state))
+    {
+        setWidgetState (state);
+        // Send the differing CCs right away, instead of waiting for the next tick
+        tick();
+    }
+}
+
+void ProgrammerEditor::redo()
+{
+    ProgramState state;
+    if (undoHistory.redo (state))
+    {
+        setWidgetState (state);
+        tick();
+    }
+}
+
+ProgramState ProgrammerEditor::getWidgetState() const
+{
+    auto state = ProgramState::defaults();
+    state[parameterIndex (ENABLE_ARP_NAME)] = static_cast<uint8_t> (arpEnable.getValue());
+    state[parameterIndex (ARP_TYPE_NAME)] = static_cast<uint8_t> (arpTypeMenu.getValue());
+    state[parameterIndex (ENABLE_LEGATO_NAME)] = static_cast<uint8_t> (legatoEnable.getValue());
+    state[parameterIndex (PORTAMENTO_NAME)] = static_cast<uint8_t> (portamentoSlider.getValue());
+
+    state[parameterIndex (ENABLE_MIDI_CLK_NAME)] = static_cast<uint8_t> (midiClkEnable.getValue());
+    state[parameterIndex (TEMPO_IN_DIV_NAME)] = static_cast<uint8_t> (tempoInDiv.getValue());
+
+    state[parameterIndex (MIDI_A_CHANNEL_NAME)] = static_cast<uint8_t> (MidiAChannel.getValue());
+    state[parameterIndex (MIDI_A_CV_NAME)] = static_cast<uint8_t> (MidiACV.getValue());
+    state[parameterIndex (MIDI_A_GATE_NAME)] = static_cast<uint8_t> (MidiAGate.getValue());
+    state[parameterIndex (MIDI_A_PITCH_NAME)] = static_cast<uint8_t> (MidiAPitchScale.getValue());
+    state[parameterIndex (MIDI_A_AFTERTOUCH_NAME)] = static_cast<uint8_t> (MidiAAftertouchScale.getValue());
+    state[parameterIndex (MIDI_A_VELOCITY_NAME)] = static_cast<uint8_t> (MidiAVelocityScale.getValue());
+
+    state[parameterIndex (MIDI_B_CHANNEL_NAME)] = static_cast<uint8_t> (MidiBChannel.getValue());
+    state[parameterIndex (MIDI_B_CV_NAME)] = static_cast<uint8_t> (MidiBCV.getValue());
+    state[parameterIndex (MIDI_B_GATE_NAME)] = static_cast<uint8_t> (MidiBGate.getValue());
+    state[parameterIndex (MIDI_B_PITCH_NAME)] = static_cast<uint8_t> (MidiBPitchScale.getValue());
+    state[parameterIndex (MIDI_B_AFTERTOUCH_NAME)] = static_cast<uint8_t> (MidiBAftertouchScale.getValue());
+    state[parameterIndex (MIDI_B_VELOCITY_NAME)] = static_cast<uint8_t> (MidiBVelocityScale.getValue());
+    return state;
+}
+
+void ProgrammerEditor::setWidgetState (const ProgramState& state)
+{
+    arpEnable.setValue (state[parameterIndex (ENABLE_ARP_NAME)]);
+    arpTypeMenu.setValue (state[parameterIndex (ARP_TYPE_NAME)]);
+    legatoEnable.setValue (state[parameterIndex (ENABLE_LEGATO_NAME)]);
+    portamentoSlider.setValue (state[parameterIndex (PORTAMENTO_NAME)]);
+
+    midiClkEnable.setValue (state[parameterIndex (ENABLE_MIDI_CLK_NAME)]);
+    tempoInDiv.setValue (state[parameterIndex (TEMPO_IN_DIV_NAME)]);
+
+    MidiAChannel.setValue (state[parameterIndex (MIDI_A_CHANNEL_NAME)]);
+    MidiACV.setValue (state[parameterIndex (MIDI_A_CV_NAME)]);
+    MidiAGate.setValue (state[parameterIndex (MIDI_A_GATE_NAME)]);
+    MidiAPitchScale.setValue (state[parameterIndex (MIDI_A_PITCH_NAME)]);
+    MidiAAftertouchScale.setValue (state[parameterIndex (MIDI_A_AFTERTOUCH_NAME)]);
+    MidiAVelocityScale.setValue (state[parameterIndex (MIDI_A_VELOCITY_NAME)]);
+
+    MidiBChannel.setValue (state[parameterIndex (MIDI_B_CHANNEL_NAME)]);
+    MidiBCV.setValue (state[parameterIndex (MIDI_B_CV_NAME)]);
+    MidiBGate.setValue (state[parameterIndex (MIDI_B_GATE_NAME)]);
+    MidiBPitchScale.setValue (state[parameterIndex (MIDI_B_PITCH_NAME)]);
+    MidiBAftertouchScale.setValue (state[parameterIndex (MIDI_B_AFTERTOUCH_NAME)]);
+    MidiBVelocityScale.setValue (state[parameterIndex (MIDI_B_VELOCITY_NAME)]);
+}
+
+void ProgrammerEditor::tick()
+{
+    const Metrics::ScopedTimer timer (processorRef.metrics.editorTick);
+    TRACE_SCOPE ("ProgrammerEditor::tick");
+
+    // Messages waiting for room in the queue go first
+    processorRef.messageProducer->flush();
+
+    // Send a CC for every widget which was moved since the last tick, and write it
+    // to the processor's parameter state. This runs at the timer rate, so it must
+    // not allocate: the states are plain arrays, and the CC numbers come from the
+    // constexpr parameter table.
+    auto& parameterState = processorRef.parameterState;
+    auto widgetState = getWidgetState();
+    bool edited = false;
+    bool changedElsewhere = false;
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        if (widgetState[i] == shownState[i])
         {
-            auto paramValue = param.second.value;
-            juce::Logger::outputDebugString (paramName + " updated to " + std::to_string (paramValue));
-
-            // send a message to the processor
-            // In this particular case, we're sending CC messages
-            // value1: Midi Channel
-            // value2: CC #
-            // value3: CC value
-            GuiMessage message;
-            message.type = GuiMessage::cc;
-            message.value1 = MIDI_CHANNEL;
-            message.value2 = param.second.cc;
-            message.value3 = param.second.value;
-            if (! processorRef.messageQueue->push(message))
-            {
-                juce::Logger::outputDebugString ("Message queue is full!");
-                // Handle queue full scenario (e.g., drop oldest, indicate error)
-            }
+            // Not touched here, so follow changes from automation, OSC, other editors, ...
+            const auto value = parameterState.get (i);
+            changedElsewhere = changedElsewhere || value != widgetState[i];
+            widgetState[i] = value;
+            continue;
         }
+
+        parameterState.set (i, widgetState[i]);
+        edited = true;
+
+        // In this particular case, we're sending CC messages
+        // If the queue is full, the producer's overflow policy takes over
+        processorRef.messageProducer->push (MidiEvent::controller (MIDI_CHANNEL, parameterDefinitions[i].cc, widgetState[i]));
+    }
+
+    if (changedElsewhere)
+        setWidgetState (widgetState);
+    shownState = widgetState;
+
+    // Only edits made in this editor are undo steps
+    if (edited && widgetState != undoHistory.getCurrent())
+        undoHistory.push (widgetState);
+
+    processorRef.notifyMessagesPushed();
+    updateOverflowWarning();
+
+    // Refresh the metrics in the debug footer
+    if (enableInspector == true)
+    {
+        metricsText = processorRef.getMetricsSnapshot().toString();
+        repaint (getLocalBounds().removeFromBottom (footerHeight));
+    }
+}
+
+void ProgrammerEditor::directOutputChanged()
+{
+    const auto device = directOutputMenu.getValue() - 1;
+    if (device < 0 || device >= directOutputDevices.size())
+    {
+        processorRef.stopDirectOutput();
+        return;
+    }
+
+    if (! processorRef.startDirectOutput (directOutputDevices[device].identifier))
+    {
+        juce::Logger::outputDebugString ("Could not open MIDI output " + directOutputDevices[device].name);
+        directOutputMenu.setValue (0);
     }
+}
+
+void ProgrammerEditor::oscServerChanged()
+{
+    if (oscServerMenu.getValue() != 1)
+    {
+        processorRef.stopOscServer();
+        return;
+    }
+
+    if (! processorRef.startOscServer())
+    {
+        juce::Logger::outputDebugString ("Could not listen for OSC on port " + juce::String (OscControlServer::defaultPort));
+        oscServerMenu.setValue (0);
+    }
+}
+
+void ProgrammerEditor::sharedControlChanged()
+{
+    if (sharedControlMenu.getValue() != 1)
+    {
+        processorRef.stopSharedControl();
+        return;
+    }
+
+    if (! processorRef.startSharedControl())
+    {
+        juce::Logger::outputDebugString ("Could not create shared memory " PROGRAMMER_SHM_NAME " (is another 0-Programmer using it?)");
+        sharedControlMenu.setValue (0);
+    }
+}
+
+void ProgrammerEditor::recallMenuChanged()
+{
+    const auto selectedId = recallMenu.getSelectedId();
+    if (selectedId == 1)
+    {
+        processorRef.setRecallBank ({});
+        return;
+    }
+    if (selectedId != 2)
+        return;
+
+    // Shows the current bank again until a new one is imported
+    updateRecallMenu();
+    recallChooser = std::make_unique<juce::FileChooser> ("Folder with presets to recall");
+    recallChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+        [this] (const juce::FileChooser& chooser) {
+            const auto directory = chooser.getResult();
+            if (! directory.isDirectory())
+                return;
+
+            auto bank = std::make_shared<PresetBank>();
+            processorRef.executor->submit (
+                [directory, bank] { PresetImporter::importDirectory (directory, *bank); },
+                BackgroundExecutor::Priority::normal,
+                backgroundJobs,
+                [this, bank] (bool wasCancelled) {
+                    if (wasCancelled)
+                        return;
+                    processorRef.setRecallBank (*bank);
+                    updateRecallMenu();
+                });
+        });
+}
+
+void ProgrammerEditor::updateRecallMenu()
+{
+    const auto numPresets = processorRef.getRecallBank().size();
+    recallMenu.clear();
+    recallMenu.addItem ("Off", 1);
+    recallMenu.addItem ("Load folder...", 2);
+    if (numPresets > 0)
+        recallMenu.addItem (juce::String (static_cast<int> (numPresets)) + (numPresets == 1 ? " preset" : " presets"), 3);
+    recallMenu.setSelectedId (numPresets > 0 ? 3 : 1);
+}
+
+void ProgrammerEditor::updateOverflowWarning()
+{
+    const auto numLost = processorRef.messageProducer->getNumLost();
+    if (numLost == numLostShown)
+        return;
+
+    numLostShown = numLost;
+    overflowWarning.setText ("Queue overflow: the device may have missed "
+                                 + juce::String (numLost) + (numLost == 1 ? " update" : " updates"),
+        juce::dontSendNotification);
+    overflowWarning.setVisible (true);
 }
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
 
 #include "PluginProcessor.h"
-#include "BinaryData.h"
-#include "melatonin_inspector/melatonin_inspector.h"
-#include "Parameters.h"
+#include "UndoHistory.h"
+
+// The melatonin inspector is only linked in debug builds (see CMakeLists.txt)
+#ifndef PROGRAMMER_INSPECTOR
+    #define PROGRAMMER_INSPECTOR 0
+#endif
+#if PROGRAMMER_INSPECTOR
+    #include "melatonin_inspector/melatonin_inspector.h"
+#endif
 
 //==============================================================================
 // CUSTOM UI ELEMENTS
@@ -31,6 +37,10 @@ public:
     {
         addAndMakeVisible (customLabel);
         addAndMakeVisible (customComboBox);
+        customComboBox.onChange = [this] {
+            if (onChange)
+                onChange();
+        };
     }
 
     void addItem (const juce::String& text, int itemId)
@@ -72,6 +82,14 @@ public:
     {
         customComboBox.setSelectedId (value + 1, juce::dontSendNotification);
     }
+
+    void clear()
+    {
+        customComboBox.clear (juce::dontSendNotification);
+    }
+
+    // Called when the user picks an item
+    std::function<void()> onChange;
     
     void setText(const juce::String &newText)
     {
@@ -130,11 +148,16 @@ public:
         customSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
     }
 
-    double getValue()
+    double getValue() const
     {
         return customSlider.getValue();
     }
 
+    void setValue (double newValue)
+    {
+        customSlider.setValue (newValue, juce::dontSendNotification);
+    }
+
     void setText(const juce::String &newText)
     {
         customLabel.setText (newText, juce::dontSendNotification);
@@ -181,7 +204,7 @@ private:
 
 //==============================================================================
 // Editor class
-class ProgrammerEditor : public juce::AudioProcessorEditor, private juce::Timer
+class ProgrammerEditor : public juce::AudioProcessorEditor, private juce::AsyncUpdater
 {
 public:
     explicit ProgrammerEditor (ProgrammerProcessor&);
@@ -190,26 +213,42 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
+    bool keyPressed (const juce::KeyPress& key) override;
+
+    // Undo/redo the last change of any widget. Only the CCs which differ
+    // from the current state are sent to the device. The last maxUndoSteps
+    // changes can be undone.
+    void undo();
+    void redo();
 
     // Enable melatonin inspector here - will only be enabled in
     // debug builds
     bool enableInspector = false;
     
-    // Test interface for callback - this is not nice, figure out how to 
-    // get timer to fire in test
-    void testTimerCallback() { timerCallback(); }
+    // How often the widgets are scanned for changes, on the processor's scheduler.
+    // Tests run the ticks with a VirtualScheduler.
+    static constexpr double tickIntervalMs = 1000.0;
+
+    // Test interface
     void testEnableArp() { arpEnable.setValue(1); }
+    ProgramState testGetWidgetState() const { return getWidgetState(); }
+    void testSetWidgetState (const ProgramState& state) { setWidgetState (state); }
 
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     ProgrammerProcessor& processorRef;
     
-    // Melatonin Inspector Stuff
+    // Melatonin Inspector Stuff. Created on demand, after the first paint.
+#if PROGRAMMER_INSPECTOR
     std::unique_ptr<melatonin::Inspector> inspector;
-    juce::TextButton inspectButton { "Inspect the UI" };
+    std::unique_ptr<juce::TextButton> inspectButton;
+#endif
     int inspectButtonHeight = 50;
 
+    // Setup which isn't needed for the first frame is done after it (see handleAsyncUpdate)
+    bool deferredSetupDone = false;
+
     // UI Layout values
     const int columnWidth  = 400;
     const int headerHeight = 36;
@@ -236,6 +275,23 @@ private:
     CustomComboBox midiClkEnable;
     CustomSlider tempoInDiv;
 
+    // Standalone only: send CCs straight to a MIDI output instead of through the audio device
+    CustomComboBox directOutputMenu;
+    juce::Array<juce::MidiDeviceInfo> directOutputDevices;
+
+    // Cancelled when the editor goes, so no background job calls back into it
+    BackgroundExecutor::CancellationToken backgroundJobs;
+
+    // Receive parameter changes over OSC from other apps on this machine
+    CustomComboBox oscServerMenu;
+
+    // Receive CC changes from another process through shared memory
+    CustomComboBox sharedControlMenu;
+
+    // Program change recall: a folder of preset files, program n recalls preset n
+    CustomComboBox recallMenu;
+    std::unique_ptr<juce::FileChooser> recallChooser;
+
     CustomComboBox MidiAChannel;
     CustomComboBox MidiACV;
     CustomComboBox MidiAGate;
@@ -256,9 +312,28 @@ private:
     std::array<HorizontalSeparator, numberOfColumns> headerSeparator;
     std::array<HorizontalSeparator, numberOfColumns> footerSeparator;
     std::array<juce::Label, numberOfColumns> headerLabel;
+    juce::Label overflowWarning;
+    juce::String metricsText;
+    uint64_t numLostShown = 0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProgrammerEditor)
-    void timerCallback() override;
-
-    Parameters params;
+    void tick();
+    int tickId = 0;
+    void handleAsyncUpdate() override;
+    void updateOverflowWarning();
+    void directOutputChanged();
+    void oscServerChanged();
+    void sharedControlChanged();
+    void recallMenuChanged();
+    void updateRecallMenu();
+
+    // Read/write all widget values at once, indexed like parameterDefinitions
+    ProgramState getWidgetState() const;
+    void setWidgetState (const ProgramState& state);
+
+    // The values the widgets showed after the last tick. A widget which differs was
+    // moved by the user, everything else follows the processor's parameter state.
+    ProgramState shownState = ProgramState::defaults();
+    static constexpr size_t maxUndoSteps = 1000;
+    UndoHistory undoHistory { 2048, maxUndoSteps };
 };
@@ -10,13 +10,56 @@ ProgrammerProcessor::ProgrammerProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+       parameters (*this, nullptr, "Parameters", createParameterLayout())
 {
     messageQueue.reset(new ThreadSafeMessageQueue(128)); // Example capacity (number of messages)
+    messageProducer.reset(new MessageQueueProducer(*messageQueue, MessageQueueProducer::OverflowPolicy::coalesceByCc));
+    midiSender.reset(new MidiSenderThread(*messageQueue, queueOwnership, metrics.messagesPoppedBySender));
+    oscQueue.reset(new ThreadSafeMessageQueue(128));
+    oscServer.reset(new OscControlServer(*oscQueue));
+
+    // Room for a full queue, a recall and a morph step, so processBlock doesn't allocate
+    outputMessages.ensureSize (4096);
+    passThroughMessages.ensureSize (4096);
+
+    // Only does something in builds with the realtime watchdog
+    RealtimeWatchdog::installLogger();
+
+    recallRefreshId = scheduler->callEvery (recallRefreshIntervalMs, [this] { refreshRecall(); });
+    hostSyncId = scheduler->callEvery (hostSyncIntervalMs, [this] { syncHostParameters(); });
+
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        parameterValues[i] = parameters.getRawParameterValue (parameterDefinitions[i].name);
+        jassert (parameterValues[i] != nullptr);
+        hostSyncValues[i].store (-1);
+    }
 }
 
 ProgrammerProcessor::~ProgrammerProcessor()
 {
+    cancelPendingUpdate();
+    scheduler->cancel (recallRefreshId);
+    scheduler->cancel (hostSyncId);
+    midiSender->stop();
+    oscServer->stop();
+    stopSharedControl();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout ProgrammerProcessor::createParameterLayout()
+{
+    // Publish every parameter from configuration.h as an integer host parameter
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    for (const auto& definition : parameterDefinitions)
+    {
+        layout.add (std::make_unique<juce::AudioParameterInt> (juce::ParameterID { definition.name, 1 },
+            definition.name,
+            definition.minValue,
+            definition.maxValue,
+            definition.defaultValue));
+    }
+    return layout;
 }
 
 //==============================================================================
@@ -90,6 +133,9 @@ void ProgrammerProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     juce::ignoreUnused (sampleRate, samplesPerBlock);
+
+    // The device is assumed to hold whatever we sent last, so the decimator is
+    // deliberately not reset here.
 }
 
 void ProgrammerProcessor::releaseResources()
@@ -123,8 +169,12 @@ bool ProgrammerProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
 void ProgrammerProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
+    const Metrics::ScopedTimer timer (metrics.processBlock);
+    const RealtimeWatchdog::ScopedAudioThread watchdogScope;
+    TRACE_RESERVED_THREAD_NAME ("Audio Thread");
+    TRACE_SCOPE ("ProgrammerProcessor::processBlock");
 
+   #if ! JucePlugin_IsMidiEffect
     juce::ScopedNoDenormals noDenormals;
     //auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -132,23 +182,472 @@ void ProgrammerProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     // We'll clear all output channels, as we are not doing any audio
     for (auto i = 0; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
+   #endif
+
+    // Everything the processor sends is collected in outputMessages, and only added
+    // to the host's buffer at the end. That way the journal only sees what we sent,
+    // not the host's input.
+    outputMessages.clear();
+
+    // CCs the sender wrote straight to the device, so the decimator knows what it has
+    midiSender->takeSentCcs ([this] (size_t index, int value) { ccDecimator.noteSent (index, value); });
+
+    // Program changes from the host recall a preset
+    const auto numRecallSlotsUsed = recallProgram (midiMessages, outputMessages, buffer.getNumSamples());
+
+    // Send everything the editor queued up. Only what's ready now is taken, so a
+    // busy editor can't keep the audio thread in here. With direct output, the
+    // sender thread owns the queue and this is skipped.
+    if (queueOwnership.audioThreadEnter())
+    {
+        metrics.maxQueueDepth.update (messageQueue->getNumReady());
+        metrics.messagesPopped.add (static_cast<uint64_t> (popMessages (*messageQueue, outputMessages, false)));
+        queueOwnership.audioThreadExit();
+    }
+
+    // Changes received over OSC and from other processes. Always sent from here,
+    // also with direct output.
+    popMessages (*oscQueue, outputMessages, true);
+    popSharedControl (outputMessages);
+
+    // Morphing. The morphed values go through the decimator too, so a slow morph
+    // only sends a CC when a value actually moves to the next step.
+    handleMorphRequest();
+    if (presetMorph.process (buffer.getNumSamples(), morphState))
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (ccDecimator.send (i, morphState[i]))
+            {
+                parameterState.set (i, morphState[i]);
+                auto ccMessage = juce::MidiMessage::controllerEvent (MIDI_CHANNEL, parameterDefinitions[i].cc, morphState[i]);
+                outputMessages.addEvent (ccMessage, 0);
+            }
+        }
+        morphRunning = presetMorph.isRunning();
+    }
+
+    // Host automation. JUCE parameters are block rate, so we check each parameter
+    // once per block and only send a CC when its quantized value changed.
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        // A value set by syncHostParameters() follows the device, it isn't automation
+        const auto value = parameterValues[i]->load (std::memory_order_relaxed);
+        const auto syncValue = hostSyncValues[i].load (std::memory_order_acquire);
+        if (syncValue >= 0 && CcDecimator::quantize (value) == syncValue)
+        {
+            hostSyncValues[i].store (-1, std::memory_order_relaxed);
+            ccDecimator.noteInput (i, value);
+            continue;
+        }
+
+        if (ccDecimator.update (i, value))
+        {
+            parameterState.set (i, ccDecimator.getLastSent (i));
+            auto ccMessage = juce::MidiMessage::controllerEvent (MIDI_CHANNEL, parameterDefinitions[i].cc, ccDecimator.getLastSent (i));
+            outputMessages.addEvent (ccMessage, 0);
+        }
+    }
+
+    replayBlock (outputMessages, buffer.getNumSamples());
+    if (ccJournal.isRecording())
+        recordBlock (outputMessages);
+    samplePosition += buffer.getNumSamples();
+
+    metrics.ccsEmitted.add (static_cast<uint64_t> (outputMessages.getNumEvents()));
+
+    // A Program Change which recalls a preset is replaced by its burst. The same
+    // slots as in recallProgram, so a Program Change is either recalled or passed through.
+    if (numRecallSlotsUsed > 0)
+    {
+        passThroughMessages.clear();
+        for (const auto metadata : midiMessages)
+        {
+            if (! isRecallProgramChange (metadata, numRecallSlotsUsed))
+                passThroughMessages.addEvent (metadata.data, metadata.numBytes, metadata.samplePosition);
+        }
+        if (passThroughMessages.getNumEvents() != midiMessages.getNumEvents())
+        {
+            midiMessages.clear();
+            midiMessages.addEvents (passThroughMessages, 0, -1, 0);
+        }
+    }
+    midiMessages.addEvents (outputMessages, 0, -1, 0);
+}
+
+int ProgrammerProcessor::popMessages (ThreadSafeMessageQueue& queue, juce::MidiBuffer& midiMessages, bool updateParameterState)
+{
+    const auto numReady = queue.getNumReady();
+    for (int i = 0; i < numReady; ++i)
+    {
+        MidiEvent event;
+        queue.pop (event);
+        if (event.isSysex())
+            addMidiEvent (midiMessages, event, queue.getSysexPool());
+        else
+            sendMessage (event, midiMessages, updateParameterState);
+    }
+    return numReady;
+}
+
+void ProgrammerProcessor::popSharedControl (juce::MidiBuffer& midiMessages)
+{
+    const RealtimeWatchdog::SpinLock::ScopedTryLockType lock (sharedControlLock);
+    if (! lock.isLocked() || sharedControl == nullptr)
+        return;
+
+    // Only what's ready now (at most one ring, invalid records included), so a busy
+    // or broken client can't keep the audio thread in here
+    MidiEvent event;
+    auto budget = sharedControl->getNumReady();
+    while (sharedControl->pop (event, budget))
+        sendMessage (event, midiMessages, true);
+}
+
+void ProgrammerProcessor::sendMessage (const MidiEvent& event, juce::MidiBuffer& midiMessages, bool updateParameterState)
+{
+    // Add message to midi buffer. Sysex is added by the caller, which has its pool.
+    jassert (! event.isSysex());
+    midiMessages.addEvent (event.bytes, event.getSize(), static_cast<int> (event.sampleOffset));
+    if (! event.isController())
+        return;
+
+    // Let the decimator know, so automation doesn't re-send the same value
+    auto index = findParameterIndexByCc (event.getControllerNumber());
+    if (index < 0)
+        return;
+
+    ccDecimator.noteSent (static_cast<size_t> (index), event.getControllerValue());
+    if (updateParameterState)
+        parameterState.set (static_cast<size_t> (index), static_cast<uint8_t> (event.getControllerValue()));
+}
+
+Metrics::Snapshot ProgrammerProcessor::getMetricsSnapshot()
+{
+    return metrics.getSnapshot (messageProducer->getNumPushed(), messageProducer->getNumLost());
+}
+
+//==============================================================================
+void ProgrammerProcessor::startMorph (const ProgramState& from, const ProgramState& to, double lengthInBars, float discreteSwitchPoint)
+{
+    const RealtimeWatchdog::SpinLock::ScopedLockType lock (morphRequestLock);
+    morphRequest = { from, to, lengthInBars, discreteSwitchPoint, false };
+    morphRequestPending = true;
+    morphRunning = true;
+}
+
+void ProgrammerProcessor::stopMorph()
+{
+    const RealtimeWatchdog::SpinLock::ScopedLockType lock (morphRequestLock);
+    morphRequest.stop = true;
+    morphRequestPending = true;
+    morphRunning = false;
+}
+
+void ProgrammerProcessor::handleMorphRequest()
+{
+    // Never wait on the audio thread. If the lock is taken, we'll pick up the
+    // request on the next block.
+    const RealtimeWatchdog::SpinLock::ScopedTryLockType lock (morphRequestLock);
+    if (! lock.isLocked() || ! morphRequestPending)
+        return;
+
+    if (morphRequest.stop)
+        presetMorph.stop();
+    else
+        presetMorph.start (morphRequest.from, morphRequest.to, barsToSamples (morphRequest.lengthInBars), morphRequest.discreteSwitchPoint);
+
+    morphRequestPending = false;
+}
+
+int64_t ProgrammerProcessor::barsToSamples (double bars)
+{
+    double bpm = 120.0;
+    double beatsPerBar = 4.0;
+
+    if (auto* playHead = getPlayHead())
+    {
+        if (auto position = playHead->getPosition())
+        {
+            if (auto hostBpm = position->getBpm())
+                bpm = *hostBpm;
+            if (auto timeSignature = position->getTimeSignature())
+                beatsPerBar = timeSignature->numerator * (4.0 / timeSignature->denominator);
+        }
+    }
+
+    const auto seconds = bars * beatsPerBar * 60.0 / bpm;
+    return static_cast<int64_t> (seconds * getSampleRate());
+}
+
+//==============================================================================
+void ProgrammerProcessor::setRecallBank (const PresetBank& bank)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    {
+        // Only the presets which get a slot
+        const juce::ScopedLock lock (recallBankLock);
+        recallBank.clear();
+        const auto numSlots = std::min (bank.size(), ProgramRecall::numSlots);
+        recallBank.reserve (numSlots);
+        for (size_t slot = 0; slot < numSlots; ++slot)
+            recallBank.add (bank.getName (slot), bank.getState (slot));
+        restoredRecallBank.reset();
+    }
+
+    recallPresetsChanged = true;
+    refreshRecall();
+}
+
+PresetBank ProgrammerProcessor::getRecallBank() const
+{
+    const juce::ScopedLock lock (recallBankLock);
+    return restoredRecallBank != nullptr ? *restoredRecallBank : recallBank;
+}
+
+void ProgrammerProcessor::handleAsyncUpdate()
+{
+    // A bank restored on another thread
+    std::unique_ptr<PresetBank> bank;
+    {
+        const juce::ScopedLock lock (recallBankLock);
+        bank = std::move (restoredRecallBank);
+    }
+    if (bank != nullptr)
+        setRecallBank (*bank);
+}
+
+bool ProgrammerProcessor::isRecallUpToDate() const
+{
+    if (recallBuild != nullptr || recallPresetsChanged)
+        return false;
+    return recallTable != nullptr ? recallTable->basis == parameterState.getSnapshot() : recallBank.isEmpty();
+}
+
+void ProgrammerProcessor::refreshRecall()
+{
+    if (recallBuild != nullptr)
+    {
+        // One build at a time. Once it's done, hand it to the audio thread.
+        if (! recallBuild->done.load())
+            return;
+
+        std::shared_ptr<const ProgramRecall::Table> oldTable = recallBuild->table;
+        {
+            const RealtimeWatchdog::SpinLock::ScopedLockType lock (recallLock);
+            std::swap (recallTable, oldTable);
+            numRecallSlots = static_cast<int> (recallTable->numPresets);
+        }
+        recallBuild.reset();
+    }
+
+    // Build again when the presets changed, or the device moved away from the basis
+    const auto deviceState = parameterState.getSnapshot();
+    const auto upToDate = recallTable != nullptr ? recallTable->basis == deviceState : recallBank.isEmpty();
+    if (upToDate && ! recallPresetsChanged)
+        return;
+
+    recallPresetsChanged = false;
+    recallBuild = std::make_shared<RecallBuild>();
 
+    // The job only holds on to shared data, so it can outlive this processor
+    executor->submit ([build = recallBuild, previous = recallTable, presets = recallBank.getStates(), deviceState] {
+        ProgramRecall::build (*build->table, previous.get(), presets, deviceState);
+        build->done = true;
+    }, BackgroundExecutor::Priority::high);
+}
+
+int ProgrammerProcessor::recallProgram (const juce::MidiBuffer& hostMessages, juce::MidiBuffer& midiMessages, int numSamples)
+{
+    // Never wait on the audio thread. If a table is being published right now, the
+    // slots of the last published one count, and the program is recalled at the start
+    // of the next block. Until the first table is published there are no slots, so
+    // Program Changes pass through instead of being lost.
+    const RealtimeWatchdog::SpinLock::ScopedTryLockType lock (recallLock);
+    const auto numSlots = lock.isLocked() ? (recallTable != nullptr ? static_cast<int> (recallTable->numPresets) : 0)
+                                          : numRecallSlots.load (std::memory_order_relaxed);
+
+    // The last program change wins
+    for (const auto metadata : hostMessages)
+    {
+        if (isRecallProgramChange (metadata, numSlots))
+        {
+            pendingRecall = metadata.data[1];
+            pendingRecallPosition = metadata.samplePosition;
+        }
+    }
+    if (pendingRecall < 0)
+        return numSlots;
+
+    if (! lock.isLocked())
+    {
+        pendingRecallPosition = 0;
+        return numSlots;
+    }
+
+    const auto program = static_cast<size_t> (std::exchange (pendingRecall, -1));
+    const auto position = juce::jlimit (0, juce::jmax (0, numSamples - 1), pendingRecallPosition);
+    const auto* burst = recallTable != nullptr ? recallTable->getBurst (program, parameterState.getSnapshot()) : nullptr;
+    if (burst == nullptr)
+        return numSlots;
+
+    // The recalled program replaces a running morph
+    presetMorph.stop();
+    morphRunning = false;
+
+    for (size_t i = 0; i < burst->numCcs; ++i)
+    {
+        const auto& cc = burst->ccs[i];
+        ccDecimator.noteSent (cc.index, cc.value);
+        parameterState.set (cc.index, cc.value);
+        midiMessages.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, parameterDefinitions[cc.index].cc, cc.value), position);
+    }
+    return numSlots;
+}
+
+bool ProgrammerProcessor::isRecallProgramChange (const juce::MidiMessageMetadata& metadata, int numSlots)
+{
+    // Program changes on MIDI_CHANNEL for a slot which holds a preset
+    const auto status = metadata.data[0];
+    return metadata.numBytes == 2 && (status & 0xF0) == 0xC0 && (status & 0x0F) + 1 == MIDI_CHANNEL
+        && metadata.data[1] < numSlots;
+}
+
+//==============================================================================
+bool ProgrammerProcessor::startDirectOutput (const juce::String& deviceIdentifier)
+{
+    return midiSender->start (deviceIdentifier);
+}
+
+bool ProgrammerProcessor::startDirectOutput (std::unique_ptr<juce::MidiOutput> output)
+{
+    return midiSender->start (std::move (output));
+}
+
+void ProgrammerProcessor::stopDirectOutput()
+{
+    midiSender->stop();
+}
+
+void ProgrammerProcessor::notifyMessagesPushed()
+{
+    if (midiSender->isSending())
+        midiSender->wakeUp();
+}
+
+//==============================================================================
+bool ProgrammerProcessor::startOscServer (int port)
+{
+    return oscServer->start (port);
+}
+
+void ProgrammerProcessor::stopOscServer()
+{
+    oscServer->stop();
+}
+
+//==============================================================================
+bool ProgrammerProcessor::startSharedControl (const juce::String& name)
+{
+    stopSharedControl();
+
+    auto ring = std::make_unique<SharedControlRing>();
+    if (! ring->create (name))
+        return false;
+
+    const RealtimeWatchdog::SpinLock::ScopedLockType lock (sharedControlLock);
+    sharedControl = std::move (ring);
+    sharedControlActive = true;
+    return true;
+}
+
+void ProgrammerProcessor::stopSharedControl()
+{
+    std::unique_ptr<SharedControlRing> ring;
+    {
+        const RealtimeWatchdog::SpinLock::ScopedLockType lock (sharedControlLock);
+        std::swap (sharedControl, ring);
+        sharedControlActive = false;
+    }
+    // The segment (if any) is unmapped here, off the audio thread
+}
+
+//==============================================================================
+bool ProgrammerProcessor::startReplay (const juce::File& journalFile)
+{
+    auto journal = std::make_unique<CcJournalReader>();
+    if (! journal->open (journalFile))
+        return false;
+
+    {
+        const RealtimeWatchdog::SpinLock::ScopedLockType lock (replayLock);
+        std::swap (replayJournal, journal);
+        replayStartPending = true;
+        replayRunning = true;
+    }
+    // The previous journal (if any) is released here, off the audio thread
+    return true;
+}
 
+void ProgrammerProcessor::stopReplay()
+{
+    std::unique_ptr<CcJournalReader> journal;
+    {
+        const RealtimeWatchdog::SpinLock::ScopedLockType lock (replayLock);
+        std::swap (replayJournal, journal);
+        replayRunning = false;
+    }
+}
+
+void ProgrammerProcessor::replayBlock (juce::MidiBuffer& midiMessages, int numSamples)
+{
+    // If the lock is taken, late records go out at the start of the next block
+    const RealtimeWatchdog::SpinLock::ScopedTryLockType lock (replayLock);
+    if (! lock.isLocked() || replayJournal == nullptr || ! replayRunning)
+        return;
 
-    if (messageQueue->getNumReady() > 0)
+    const auto& journal = *replayJournal;
+    if (replayStartPending)
     {
-        juce::Logger::outputDebugString ("GOT MESSAGE!");
-        GuiMessage message;
-        messageQueue->pop(message);
-        juce::Logger::outputDebugString ("Message type = " + std::to_string (message.type));
-        juce::Logger::outputDebugString ("Value1 = " + std::to_string (message.value1));
-        juce::Logger::outputDebugString ("Value2 = " + std::to_string (message.value2));
-        juce::Logger::outputDebugString ("Value3 = " + std::to_string (message.value3));
-        juce::Logger::outputDebugString ("Messages still in Queue: " + std::to_string (messageQueue->getNumReady()));
+        replayIndex = 0;
+        replayStartPosition = samplePosition;
+        replaySampleRateRatio = journal.getSampleRate() > 0.0 && getSampleRate() > 0.0 ? getSampleRate() / journal.getSampleRate() : 1.0;
+        replayStartPending = false;
+    }
+
+    // Positions are relative to the first record, scaled to the current sample rate
+    const auto blockEnd = samplePosition + numSamples;
+    for (; replayIndex < journal.size(); ++replayIndex)
+    {
+        const auto& record = journal[replayIndex];
+        const auto recordedDistance = static_cast<double> (record.samplePosition - journal[0].samplePosition);
+        const auto position = replayStartPosition + static_cast<int64_t> (std::llround (recordedDistance * replaySampleRateRatio));
+        if (position >= blockEnd)
+            break;
+
+        const auto offset = static_cast<int> (std::max<int64_t> (position - samplePosition, 0));
+        midiMessages.addEvent (juce::MidiMessage (record.status, record.data1, record.data2), offset);
+
+        auto index = findParameterIndexByCc (record.data1);
+        if ((record.status & 0xF0) == 0xB0 && index >= 0)
+        {
+            ccDecimator.noteSent (static_cast<size_t> (index), record.data2);
+            parameterState.set (static_cast<size_t> (index), record.data2);
+        }
+    }
 
-        // Add message to midi buffer
-        auto myMidiMessage = juce::MidiMessage::controllerEvent(message.value1, message.value2, message.value3);
-        midiMessages.addEvent( myMidiMessage, 0);
+    if (replayIndex == journal.size())
+        replayRunning = false;
+}
+
+void ProgrammerProcessor::recordBlock (const juce::MidiBuffer& midiMessages)
+{
+    const auto ticks = juce::Time::getHighResolutionTicks();
+    for (const auto metadata : midiMessages)
+    {
+        if (metadata.numBytes == 3 && (metadata.data[0] & 0xF0) == 0xB0)
+            ccJournal.record (ticks, samplePosition + metadata.samplePosition, metadata.data);
     }
 }
 
@@ -164,19 +663,99 @@ juce::AudioProcessorEditor* ProgrammerProcessor::createEditor()
 }
 
 //==============================================================================
+void ProgrammerProcessor::syncHostParameters()
+{
+    const auto deviceState = parameterState.getSnapshot();
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        if (deviceState[i] == hostSyncedState[i])
+            continue;
+
+        if (CcDecimator::quantize (parameterValues[i]->load (std::memory_order_relaxed)) == deviceState[i])
+            continue;
+
+        // Marked before it's set, so processBlock never sees it as automation
+        auto* parameter = parameters.getParameter (parameterDefinitions[i].name);
+        hostSyncValues[i].store (deviceState[i], std::memory_order_release);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (static_cast<float> (deviceState[i])));
+    }
+    hostSyncedState = deviceState;
+}
+
 void ProgrammerProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    juce::ignoreUnused (destData);
+    // Store the host parameters as XML. The values are taken from parameterState,
+    // so edits which weren't synced to the host parameters yet are saved too.
+    auto state = parameters.copyState();
+    const auto deviceState = parameterState.getSnapshot();
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        auto parameterTree = state.getChildWithProperty ("id", juce::String (parameterDefinitions[i].name));
+        if (parameterTree.isValid())
+            parameterTree.setProperty ("value", static_cast<int> (deviceState[i]), nullptr);
+    }
+
+    // The recall bank, one Preset per slot with a value for every parameter
+    const auto bank = getRecallBank();
+    juce::ValueTree bankTree (recallBankType);
+    for (size_t slot = 0; slot < bank.size(); ++slot)
+    {
+        juce::ValueTree presetTree ("Preset");
+        presetTree.setProperty ("name", bank.getName (slot), nullptr);
+        for (size_t i = 0; i < numParameters; ++i)
+            presetTree.setProperty (parameterDefinitions[i].name, static_cast<int> (bank.getState (slot)[i]), nullptr);
+        bankTree.appendChild (presetTree, nullptr);
+    }
+    state.removeChild (state.getChildWithName (recallBankType), nullptr);
+    state.appendChild (bankTree, nullptr);
+
+    std::unique_ptr<juce::XmlElement> xml (state.createXml());
+    copyXmlToBinary (*xml, destData);
 }
 
 void ProgrammerProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    juce::ignoreUnused (data, sizeInBytes);
+    // Restore the host parameters. The next processBlock will send any values which
+    // differ from what the device has, through the decimator.
+    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+    if (xmlState == nullptr || ! xmlState->hasTagName (parameters.state.getType()))
+        return;
+
+    // The recall bank isn't part of the host parameters. Missing values (ie. from an
+    // older version with fewer parameters) are the defaults.
+    auto state = juce::ValueTree::fromXml (*xmlState);
+    const auto bankTree = state.getChildWithName (recallBankType);
+    PresetBank bank;
+    for (const auto& presetTree : bankTree)
+    {
+        auto preset = ProgramState::defaults();
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto& definition = parameterDefinitions[i];
+            const int value = presetTree.getProperty (definition.name, definition.defaultValue);
+            preset[i] = static_cast<uint8_t> (juce::jlimit (definition.minValue, definition.maxValue, value));
+        }
+        bank.add (presetTree.getProperty ("name").toString(), preset);
+    }
+    state.removeChild (bankTree, nullptr);
+
+    // Hosts may restore the state on any thread, but the recall tables are built from
+    // the message thread
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        setRecallBank (bank);
+    else
+    {
+        {
+            const juce::ScopedLock lock (recallBankLock);
+            restoredRecallBank = std::make_unique<PresetBank> (std::move (bank));
+        }
+        triggerAsyncUpdate();
+    }
+
+    // The restored values are sent, even if one matches a pending sync
+    for (auto& syncValue : hostSyncValues)
+        syncValue.store (-1);
+    parameters.replaceState (state);
 }
 
 //==============================================================================
@@ -2,12 +2,29 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "ThreadSafeMessageQueue.h"
+#include "BackgroundExecutor.h"
+#include "Scheduler.h"
+#include "MessageQueueProducer.h"
+#include "ParameterDefinitions.h"
+#include "ParameterState.h"
+#include "CcDecimator.h"
+#include "PresetMorph.h"
+#include "ProgramRecall.h"
+#include "PresetBank.h"
+#include "CcJournal.h"
+#include "Metrics.h"
+#include "MidiSenderThread.h"
+#include "OscControlServer.h"
+#include "SharedControlRing.h"
+#include "RealtimeWatchdog.h"
+#include "Trace.h"
 
 #if (MSVC)
 #include "ipps.h"
 #endif
 
-class ProgrammerProcessor : public juce::AudioProcessor
+class ProgrammerProcessor : public juce::AudioProcessor,
+                            private juce::AsyncUpdater
 {
 public:
     ProgrammerProcessor();
@@ -41,6 +58,258 @@ public:
 
     std::unique_ptr<ThreadSafeMessageQueue> messageQueue;
 
+    // The editor pushes through this, so a full queue is handled by the overflow
+    // policy (and counted) instead of silently dropping edits
+    std::unique_ptr<MessageQueueProducer> messageProducer;
+
+    // Host parameters, one for each entry in configuration.h. The parameter ID is the
+    // parameter name, so DAW automation lanes show up as ie. "EnableArp".
+    juce::AudioProcessorValueTreeState parameters;
+
+    // What the device is set to. Editors are views on this, see ParameterState.
+    ParameterState parameterState;
+
+    /**
+     * @brief Morphs from one program state to another over a number of bars.
+     *
+     * Can be called from any (non-realtime) thread. The morph starts on the next
+     * processBlock, using the host tempo and time signature (120bpm 4/4 if the host
+     * doesn't provide them).
+     *
+     * @param from The state to start from.
+     * @param to The state to end at.
+     * @param lengthInBars The length of the morph in bars.
+     * @param discreteSwitchPoint Position (0..1) where discrete parameters switch to the target.
+     */
+    void startMorph (const ProgramState& from, const ProgramState& to, double lengthInBars, float discreteSwitchPoint = 0.5f);
+    void stopMorph();
+    bool isMorphing() const { return morphRunning.load(); }
+
+    /**
+     * @brief Sends the editor's CCs straight to a MIDI output from a realtime thread,
+     * instead of through processBlock. Works without an audio device (Standalone).
+     *
+     * @param deviceIdentifier The identifier of the output, see juce::MidiOutput::getAvailableDevices().
+     * @return bool True if the output could be opened, false otherwise.
+     */
+    bool startDirectOutput (const juce::String& deviceIdentifier);
+    // To an output which is already open, ie. a virtual device in tests
+    bool startDirectOutput (std::unique_ptr<juce::MidiOutput> output);
+    void stopDirectOutput();
+    bool isDirectOutputActive() const { return midiSender->isSending(); }
+
+    // Wakes the direct output sender after pushing messages (does nothing without direct output)
+    void notifyMessagesPushed();
+
+    /**
+     * @brief Starts receiving parameter changes over OSC on 127.0.0.1, see OscControlServer.
+     *
+     * @param port The UDP port to listen on, or 0 for any free port (see getOscServerPort()).
+     * @return bool True if the port could be bound, false otherwise.
+     */
+    bool startOscServer (int port = OscControlServer::defaultPort);
+    void stopOscServer();
+    bool isOscServerRunning() const { return oscServer->isRunning(); }
+    int getOscServerPort() const { return oscServer->getPort(); }
+
+    // Second lock-free queue into processBlock, fed by the OSC server's network thread
+    std::unique_ptr<ThreadSafeMessageQueue> oscQueue;
+    std::unique_ptr<OscControlServer> oscServer;
+
+    /**
+     * @brief Creates the shared memory control ring (see ProgrammerShm.h), which another
+     * process on this machine can write CC changes into. processBlock drains it directly.
+     *
+     * Call from the message thread.
+     *
+     * @param name The name of the shared memory segment.
+     * @return bool True if the segment could be created, false otherwise.
+     */
+    bool startSharedControl (const juce::String& name = PROGRAMMER_SHM_NAME);
+    void stopSharedControl();
+    bool isSharedControlActive() const { return sharedControlActive.load(); }
+
+    /**
+     * @brief The clock and periodic callbacks for time-driven work on the message
+     * thread, ie. the editor tick. JUCE timers by default.
+     *
+     * Replace it before any editor is created, ie. with a VirtualScheduler in tests.
+     */
+    Scheduler& getScheduler() { return *scheduler; }
+    void setScheduler (std::unique_ptr<Scheduler> newScheduler)
+    {
+        jassert (getActiveEditor() == nullptr);
+        scheduler->cancel (recallRefreshId);
+        scheduler->cancel (hostSyncId);
+        scheduler = std::move (newScheduler);
+        recallRefreshId = scheduler->callEvery (recallRefreshIntervalMs, [this] { refreshRecall(); });
+        hostSyncId = scheduler->callEvery (hostSyncIntervalMs, [this] { syncHostParameters(); });
+    }
+
+    /**
+     * @brief Sets the bank a MIDI Program Change (on MIDI_CHANNEL) recalls from:
+     * program n recalls preset n, for the first ProgramRecall::numSlots presets. An
+     * empty bank switches recall off. Call from the message thread.
+     *
+     * The CC bursts for every slot are built on the executor (see ProgramRecall), and
+     * built again whenever the presets or the device state change. processBlock only
+     * looks them up and copies them out. A Program Change which recalls a preset is
+     * replaced by its burst, so it isn't passed through to the device.
+     *
+     * The bank is saved with the plugin state.
+     */
+    void setRecallBank (const PresetBank& bank);
+
+    // A copy of the bank last set (also one restored by setStateInformation which is
+    // still on its way to the message thread). Any thread but the audio thread.
+    PresetBank getRecallBank() const;
+
+    // True when the bursts for the current presets and device state are in place
+    bool isRecallUpToDate() const;
+
+    // How often the message thread checks whether the bursts need building again
+    static constexpr double recallRefreshIntervalMs = 20.0;
+
+    // How often the message thread publishes changes of parameterState to the host
+    // parameters, see syncHostParameters()
+    static constexpr double hostSyncIntervalMs = 50.0;
+
+    // Heavy non-realtime work (imports, saving, scanning) goes here, instead of
+    // blocking the message thread. Shared between all plugin instances.
+    juce::SharedResourcePointer<BackgroundExecutor> executor;
+
+    // Runtime counters, updated by processBlock and the editor
+    Metrics metrics;
+    Metrics::Snapshot getMetricsSnapshot();
+
+    // Records every CC sent by processBlock (not the ones passed through from the host). Start and stop it from the message thread.
+    CcJournalWriter ccJournal;
+
+    /**
+     * @brief Replays a recorded journal through processBlock.
+     *
+     * The CCs are sent at the same distances (in samples) as they were recorded,
+     * starting on the next processBlock, so the replay runs as fast as the host
+     * calls processBlock: in realtime when playing, as fast as possible when
+     * rendering offline. Can be called from any (non-realtime) thread.
+     *
+     * @param journalFile A journal written by ccJournal.
+     * @return bool True if the journal could be opened, false otherwise.
+     */
+    bool startReplay (const juce::File& journalFile);
+    void stopReplay();
+    bool isReplaying() const { return replayRunning.load(); }
+
 private:
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    std::unique_ptr<Scheduler> scheduler = std::make_unique<JuceScheduler>();
+
+    // Raw (lock-free) parameter values, indexed like parameterDefinitions
+    std::array<std::atomic<float>*, numParameters> parameterValues {};
+
+    // Turns host automation into CCs, only sending when the 7-bit value changes
+    CcDecimator ccDecimator;
+
+    // parameterState is what the device is set to, the host parameters follow it.
+    // Every change of parameterState which isn't already in a host parameter (editor,
+    // OSC, shared memory, recall, morph, replay) is set on it with
+    // setValueNotifyingHost, on the message thread. Only values which changed since
+    // the last sync are set, so a host parameter the host is moving isn't overridden
+    // with a stale device value.
+    //
+    // hostSyncValues holds the value the sync last set on each host parameter (-1 when
+    // none is pending), so processBlock takes it as input without sending it: by then
+    // the device may have moved on, and sending it would undo that.
+    ProgramState hostSyncedState = ProgramState::defaults();
+    std::array<std::atomic<int>, numParameters> hostSyncValues;
+    int hostSyncId = 0;
+    void syncHostParameters();
+
+    // Morphing. Requests are handed to the audio thread under a spin lock, which
+    // the audio thread only ever try-locks.
+    struct MorphRequest
+    {
+        ProgramState from;
+        ProgramState to;
+        double lengthInBars;
+        float discreteSwitchPoint;
+        bool stop;
+    };
+    RealtimeWatchdog::SpinLock morphRequestLock { "morphRequestLock" };
+    MorphRequest morphRequest {};
+    bool morphRequestPending = false;
+    std::atomic<bool> morphRunning { false };
+    PresetMorph presetMorph;
+    ProgramState morphState {};
+
+    void handleMorphRequest();
+    int64_t barsToSamples (double bars);
+
+    // Direct output. While the sender runs, it owns the consumer end of messageQueue.
+    QueueOwnership queueOwnership;
+    std::unique_ptr<MidiSenderThread> midiSender;
+
+    // The messages processBlock sends in the current block, without the host's input
+    juce::MidiBuffer outputMessages;
+
+    // The host's input without the Program Changes which recalled a preset
+    juce::MidiBuffer passThroughMessages;
+
+    // Absolute position of the current block, for the journal
+    int64_t samplePosition = 0;
+
+    // Replay. The journal is swapped in under a spin lock, which the audio thread
+    // only ever try-locks, and is only released on the calling thread.
+    RealtimeWatchdog::SpinLock replayLock { "replayLock" };
+    std::unique_ptr<CcJournalReader> replayJournal;
+    bool replayStartPending = false;
+    size_t replayIndex = 0;
+    int64_t replayStartPosition = 0;
+    double replaySampleRateRatio = 1.0;
+    std::atomic<bool> replayRunning { false };
+
+    // Shared memory control. The ring is swapped in under a spin lock, which the
+    // audio thread only ever try-locks, and is only unmapped on the calling thread.
+    RealtimeWatchdog::SpinLock sharedControlLock { "sharedControlLock" };
+    std::unique_ptr<SharedControlRing> sharedControl;
+    std::atomic<bool> sharedControlActive { false };
+
+    // Program change recall. Tables are built on the executor, published on the
+    // message thread under a spin lock (which the audio thread only ever try-locks)
+    // and only released on the message thread.
+    struct RecallBuild
+    {
+        std::shared_ptr<ProgramRecall::Table> table = std::make_shared<ProgramRecall::Table>();
+        std::atomic<bool> done { false };
+    };
+    RealtimeWatchdog::SpinLock recallLock { "recallLock" };
+    std::shared_ptr<const ProgramRecall::Table> recallTable;
+    std::shared_ptr<RecallBuild> recallBuild;
+    PresetBank recallBank;
+    std::unique_ptr<PresetBank> restoredRecallBank; // From setStateInformation, off the message thread
+    juce::CriticalSection recallBankLock;           // Guards both banks, never taken by the audio thread
+    void handleAsyncUpdate() override;
+    static inline const juce::Identifier recallBankType { "RecallBank" };
+    bool recallPresetsChanged = false;
+    std::atomic<int> numRecallSlots { 0 }; // Slots of the published table, for when processBlock can't lock it
+    int recallRefreshId = 0;
+    int pendingRecall = -1;
+    int pendingRecallPosition = 0;
+
+    void refreshRecall();
+    // Returns the number of slots Program Changes were recalled from
+    int recallProgram (const juce::MidiBuffer& hostMessages, juce::MidiBuffer& midiMessages, int numSamples);
+    static bool isRecallProgramChange (const juce::MidiMessageMetadata& metadata, int numSlots);
+
+    // Sends every message which is ready in the queue, returns how many. Messages
+    // from the editor are already in parameterState, so they don't update it.
+    int popMessages (ThreadSafeMessageQueue& queue, juce::MidiBuffer& midiMessages, bool updateParameterState);
+    void popSharedControl (juce::MidiBuffer& midiMessages);
+    void sendMessage (const MidiEvent& event, juce::MidiBuffer& midiMessages, bool updateParameterState);
+
+    void replayBlock (juce::MidiBuffer& midiMessages, int numSamples);
+    void recordBlock (const juce::MidiBuffer& midiMessages);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProgrammerProcessor)
 };
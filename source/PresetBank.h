@@ -0,0 +1,64 @@
+/**
+ * @class PresetBank
+ * @brief A library of named program states.
+ *
+ * The states are kept in one contiguous array of ProgramState records (18 bytes
+ * each), separate from the names. That keeps the records compact for anything that
+ * scans the whole library, and the bank cheap to hold even with many thousands
+ * of presets.
+ *
+ * NOTE: Not thread-safe. The bank is meant to be changed from the message thread.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "ProgramState.h"
+#include <vector>
+
+class PresetBank
+{
+public:
+    PresetBank() = default;
+
+    /**
+     * @brief Adds a preset to the end of the bank.
+     *
+     * @param name The name of the preset.
+     * @param state The parameter values of the preset.
+     * @return size_t The index of the new preset.
+     */
+    size_t add (const juce::String& name, const ProgramState& state)
+    {
+        names.push_back (name);
+        states.push_back (state);
+        return states.size() - 1;
+    }
+
+    void reserve (size_t numPresets)
+    {
+        names.reserve (numPresets);
+        states.reserve (numPresets);
+    }
+
+    void clear()
+    {
+        names.clear();
+        states.clear();
+    }
+
+    size_t size() const { return states.size(); }
+    bool isEmpty() const { return states.empty(); }
+
+    const juce::String& getName (size_t index) const { return names[index]; }
+    const ProgramState& getState (size_t index) const { return states[index]; }
+
+    /**
+     * @brief Retrieves all preset records, in bank order.
+     */
+    const std::vector<ProgramState>& getStates() const { return states; }
+
+private:
+    std::vector<juce::String> names;
+    std::vector<ProgramState> states;
+};
@@ -0,0 +1,310 @@
+/**
+ * @class PresetImporter
+ * @brief Bulk imports preset files from a directory tree into a PresetBank.
+ *
+ * Supported files are the ones colleagues share as CC dumps, and the ones written
+ * by ProgramExporter:
+ * - Standard MIDI Files (.mid, .midi, .smf)
+ * - Raw MIDI byte dumps (.syx, .bin). SysEx messages in these are skipped.
+ *
+ * A file can hold several programs. A new program starts at a marker (which also
+ * names it), or when a parameter CC shows up again. Parameters missing from a
+ * program keep their default values. A file with a value outside the min/max range
+ * from configuration.h is rejected as a whole.
+ *
+ * Files are parsed on the BackgroundExecutor, one file per chunk, each into its own
+ * result slot (no locking between chunks). Afterwards, a single pass on the calling thread
+ * removes duplicates (by content hash, also against presets already in the bank)
+ * and appends the rest to the bank in file order.
+ */
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "BackgroundExecutor.h"
+#include "PresetBank.h"
+#include <unordered_set>
+
+class PresetImporter
+{
+public:
+    struct Result
+    {
+        int numFiles = 0;         // Preset files found
+        int numRejectedFiles = 0; // Files which couldn't be read, or failed validation
+        int numPresetsFound = 0;  // Programs in the accepted files
+        int numDuplicates = 0;    // Programs dropped because the bank already had them
+        int numImported = 0;      // Programs added to the bank
+        juce::StringArray errors;
+    };
+
+    struct ParsedPreset
+    {
+        juce::String name;
+        ProgramState state;
+    };
+
+    /**
+     * @brief Imports all preset files in a directory (and its subdirectories).
+     *
+     * Blocks until done, so call it from a job when the message thread is waiting.
+     *
+     * @param directory The directory to scan.
+     * @param bank The bank to add the presets to.
+     * @param executor The executor to parse the files on.
+     * @return Result Counts of what was found, rejected and imported.
+     */
+    static Result importDirectory (const juce::File& directory, PresetBank& bank, BackgroundExecutor& executor)
+    {
+        // Sorted, so the import order doesn't depend on the file system
+        juce::Array<juce::File> files;
+        for (const auto& entry : juce::RangedDirectoryIterator (directory, true, "*", juce::File::findFiles))
+        {
+            if (isPresetFile (entry.getFile()))
+                files.add (entry.getFile());
+        }
+        files.sort();
+
+        // Parse, one job per file
+        struct FileResult
+        {
+            std::vector<ParsedPreset> presets;
+            juce::String error;
+        };
+        std::vector<FileResult> fileResults (static_cast<size_t> (files.size()));
+
+        executor.parallelFor (fileResults.size(), [&] (size_t i) {
+            auto& fileResult = fileResults[i];
+            if (! parseFile (files.getReference (static_cast<int> (i)), fileResult.presets, fileResult.error))
+                fileResult.presets.clear();
+        });
+
+        // Merge, dropping duplicates
+        Result result;
+        result.numFiles = files.size();
+
+        std::unordered_set<PackedProgramState, PackedProgramStateHash> seen;
+        seen.reserve (bank.size());
+        for (const auto& state : bank.getStates())
+            seen.insert (PackedProgramState::pack (state));
+
+        for (size_t i = 0; i < fileResults.size(); ++i)
+        {
+            const auto& fileResult = fileResults[i];
+            if (fileResult.error.isNotEmpty())
+            {
+                ++result.numRejectedFiles;
+                result.errors.add (files.getReference (static_cast<int> (i)).getFullPathName() + ": " + fileResult.error);
+                continue;
+            }
+
+            for (const auto& preset : fileResult.presets)
+            {
+                ++result.numPresetsFound;
+                if (! seen.insert (PackedProgramState::pack (preset.state)).second)
+                {
+                    ++result.numDuplicates;
+                    continue;
+                }
+                bank.add (preset.name, preset.state);
+                ++result.numImported;
+            }
+        }
+
+        return result;
+    }
+
+    // Imports on the executor shared by the plugin
+    static Result importDirectory (const juce::File& directory, PresetBank& bank)
+    {
+        const juce::SharedResourcePointer<BackgroundExecutor> executor;
+        return importDirectory (directory, bank, *executor);
+    }
+
+    static bool isPresetFile (const juce::File& file)
+    {
+        return file.hasFileExtension ("mid;midi;smf;syx;bin");
+    }
+
+    /**
+     * @brief Parses a single preset file.
+     *
+     * @param file The file to parse.
+     * @param presets Receives the programs found in the file.
+     * @param error Receives the reason if the file is rejected.
+     * @return bool True if the file was parsed and all values were valid, false otherwise.
+     */
+    static bool parseFile (const juce::File& file, std::vector<ParsedPreset>& presets, juce::String& error)
+    {
+        juce::MemoryBlock data;
+        if (! file.loadFileAsData (data))
+        {
+            error = "Could not read file";
+            return false;
+        }
+
+        ProgramParser parser (file.getFileNameWithoutExtension(), presets);
+        if (file.hasFileExtension ("syx;bin"))
+            parseRawDump (data, parser);
+        else if (! parseMidiFile (data, parser))
+            error = "Not a valid MIDI file";
+
+        parser.finish();
+        if (error.isEmpty())
+            error = parser.getError();
+        if (error.isEmpty() && presets.empty())
+            error = "No programs found";
+
+        return error.isEmpty();
+    }
+
+    /**
+     * @brief Hashes the packed bits of a state, for deduplication.
+     */
+    struct PackedProgramStateHash
+    {
+        size_t operator() (const PackedProgramState& packed) const noexcept
+        {
+            // Mix the two words (splitmix64 style)
+            auto hash = packed.words[0] ^ (packed.words[1] * 0x9E3779B97F4A7C15ull);
+            hash ^= hash >> 31;
+            hash *= 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 27;
+            return static_cast<size_t> (hash);
+        }
+    };
+
+private:
+    /* Collects CCs into programs, splitting at markers and repeated parameters */
+    class ProgramParser
+    {
+    public:
+        ProgramParser (const juce::String& fileName, std::vector<ParsedPreset>& output)
+            : baseName (fileName), presets (output)
+        {
+            startProgram ({});
+        }
+
+        void marker (const juce::String& name)
+        {
+            flush();
+            startProgram (name);
+        }
+
+        void controller (int cc, int value)
+        {
+            const auto index = findParameterIndexByCc (cc);
+            if (index < 0)
+                return;
+
+            const auto i = static_cast<size_t> (index);
+            const auto& definition = parameterDefinitions[i];
+            if (value < definition.minValue || value > definition.maxValue)
+            {
+                if (error.isEmpty())
+                    error = juce::String (definition.name) + " value " + juce::String (value) + " is out of range";
+                return;
+            }
+
+            if (assigned[i])
+            {
+                flush();
+                startProgram ({});
+            }
+
+            current.state[i] = static_cast<uint8_t> (value);
+            assigned[i] = true;
+            anyAssigned = true;
+        }
+
+        void finish() { flush(); }
+
+        const juce::String& getError() const { return error; }
+
+    private:
+        void startProgram (const juce::String& name)
+        {
+            current.name = name;
+            current.state = ProgramState::defaults();
+            assigned.fill (false);
+            anyAssigned = false;
+        }
+
+        void flush()
+        {
+            if (! anyAssigned)
+                return;
+
+            if (current.name.isEmpty())
+                current.name = baseName + (presets.empty() ? juce::String() : " " + juce::String (presets.size() + 1));
+            presets.push_back (current);
+            anyAssigned = false;
+        }
+
+        juce::String baseName;
+        std::vector<ParsedPreset>& presets;
+        ParsedPreset current;
+        std::array<bool, numParameters> assigned {};
+        bool anyAssigned = false;
+        juce::String error;
+    };
+
+    static bool parseMidiFile (const juce::MemoryBlock& data, ProgramParser& parser)
+    {
+        juce::MemoryInputStream input (data, false);
+        juce::MidiFile midiFile;
+        if (! midiFile.readFrom (input))
+            return false;
+
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        {
+            for (const auto* event : *midiFile.getTrack (track))
+            {
+                const auto& message = event->message;
+                if (message.isTextMetaEvent() && message.getMetaEventType() == 0x06)
+                    parser.marker (message.getTextFromTextMetaEvent());
+                else if (message.isController())
+                    parser.controller (message.getControllerNumber(), message.getControllerValue());
+            }
+        }
+        return true;
+    }
+
+    static void parseRawDump (const juce::MemoryBlock& data, ProgramParser& parser)
+    {
+        const auto* bytes = static_cast<const uint8_t*> (data.getData());
+        const auto numBytes = data.getSize();
+
+        uint8_t runningStatus = 0;
+        bool inSysex = false;
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            const auto byte = bytes[i];
+            if (inSysex)
+            {
+                inSysex = byte != 0xF7;
+                continue;
+            }
+            if (byte == 0xF0)
+            {
+                inSysex = true;
+                runningStatus = 0;
+                continue;
+            }
+            if (byte >= 0xF8)
+                continue; // Realtime messages can be anywhere
+            if (byte & 0x80)
+            {
+                runningStatus = byte;
+                continue;
+            }
+
+            // A data byte. Only CCs are of interest, everything else is skipped.
+            if ((runningStatus & 0xF0) == 0xB0 && i + 1 < numBytes && (bytes[i + 1] & 0x80) == 0)
+            {
+                parser.controller (byte, bytes[i + 1]);
+                ++i;
+            }
+        }
+    }
+};
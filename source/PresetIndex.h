@@ -0,0 +1,257 @@
+/**
+ * @class PresetIndex
+ * @brief A bitmap index over preset records, for filtering large libraries as you type.
+ *
+ * Every preset gets one bit (its position in the bank) in a number of bitmaps:
+ * - Discrete parameters (combo boxes) have one bitmap per possible value.
+ * - Slider parameters (0-127) have one bitmap per bucket of 8 values, plus a column
+ *   of the actual values, so the edges of a range can be checked exactly.
+ *
+ * A query is a list of terms (parameter == value, or value in a range), and is
+ * answered by AND'ing bitmaps 64 presets at a time. Adding a preset just sets a
+ * few bits, so the index can be kept up to date incrementally.
+ *
+ * NOTE: Not thread-safe. Keep the index next to the bank it indexes.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+class PresetIndex
+{
+public:
+    static constexpr int bucketSize = 8;
+    static constexpr int numBuckets = 128 / bucketSize;
+
+    /**
+     * @brief A set of presets, one bit per preset.
+     */
+    class Bitmap
+    {
+    public:
+        size_t count() const
+        {
+            size_t total = 0;
+            for (auto word : words)
+                total += static_cast<size_t> (std::popcount (word));
+            return total;
+        }
+
+        bool contains (size_t preset) const
+        {
+            return (preset / 64) < words.size() && (words[preset / 64] >> (preset % 64)) & 1;
+        }
+
+        /**
+         * @brief Calls a function with the bank index of each preset in the set, in order.
+         */
+        template <typename Function>
+        void forEach (Function&& function) const
+        {
+            for (size_t w = 0; w < words.size(); ++w)
+            {
+                auto word = words[w];
+                while (word != 0)
+                {
+                    function (w * 64 + static_cast<size_t> (std::countr_zero (word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        std::vector<uint64_t> words;
+    };
+
+    /**
+     * @brief A filter on the library. All terms must match (AND).
+     */
+    class Query
+    {
+    public:
+        /** Parameter must have exactly this value */
+        Query& equals (size_t parameter, int value) { return range (parameter, value, value); }
+
+        /** Parameter must be between low and high (inclusive) */
+        Query& range (size_t parameter, int low, int high)
+        {
+            terms.push_back ({ parameter, std::clamp (low, 0, 127), std::clamp (high, 0, 127) });
+            return *this;
+        }
+
+        struct Term
+        {
+            size_t parameter;
+            int low;
+            int high;
+        };
+        std::vector<Term> terms;
+    };
+
+    PresetIndex()
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto& definition = parameterDefinitions[i];
+            firstBitmap[i] = bitmaps.size();
+            bitmaps.resize (bitmaps.size() + static_cast<size_t> (definition.isDiscrete ? definition.maxValue + 1 : numBuckets));
+        }
+    }
+
+    /**
+     * @brief Rebuilds the index from scratch.
+     */
+    void rebuild (const std::vector<ProgramState>& records)
+    {
+        clear();
+        reserve (records.size());
+        for (const auto& record : records)
+            add (record);
+    }
+
+    void clear()
+    {
+        for (auto& bitmap : bitmaps)
+            bitmap.clear();
+        for (auto& column : values)
+            column.clear();
+        numPresets = 0;
+    }
+
+    void reserve (size_t capacity)
+    {
+        for (auto& bitmap : bitmaps)
+            bitmap.reserve ((capacity + 63) / 64);
+        for (auto& column : values)
+            column.reserve (capacity);
+    }
+
+    /**
+     * @brief Adds the next preset of the bank to the index.
+     *
+     * @param record The values of the preset. Its bank index must be size().
+     */
+    void add (const ProgramState& record)
+    {
+        const auto word = numPresets / 64;
+        const auto bit = uint64_t (1) << (numPresets % 64);
+        if (numPresets % 64 == 0)
+        {
+            for (auto& bitmap : bitmaps)
+                bitmap.push_back (0);
+        }
+
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            bitmaps[bitmapFor (i, record[i])][word] |= bit;
+            values[i].push_back (record[i]);
+        }
+        ++numPresets;
+    }
+
+    size_t size() const { return numPresets; }
+
+    /**
+     * @brief Finds all presets matching a query.
+     *
+     * @param query The terms to match.
+     * @param result Receives the matching presets. Reusing it avoids allocating.
+     */
+    void find (const Query& query, Bitmap& result) const
+    {
+        const auto numWords = (numPresets + 63) / 64;
+        result.words.assign (numWords, ~uint64_t (0));
+        if (numPresets % 64 != 0)
+            result.words.back() = (uint64_t (1) << (numPresets % 64)) - 1;
+
+        for (const auto& term : query.terms)
+            applyTerm (term, result);
+    }
+
+    Bitmap find (const Query& query) const
+    {
+        Bitmap result;
+        find (query, result);
+        return result;
+    }
+
+private:
+    size_t bitmapFor (size_t parameter, int value) const
+    {
+        if (parameterDefinitions[parameter].isDiscrete)
+            return firstBitmap[parameter] + static_cast<size_t> (std::min (value, parameterDefinitions[parameter].maxValue));
+        return firstBitmap[parameter] + static_cast<size_t> (value / bucketSize);
+    }
+
+    void applyTerm (const Query::Term& term, Bitmap& result) const
+    {
+        const auto& definition = parameterDefinitions[term.parameter];
+        const auto numWords = result.words.size();
+
+        // Fast path: a single bitmap holds exactly the matching presets
+        if (definition.isDiscrete && term.low == term.high)
+        {
+            if (term.low > definition.maxValue)
+            {
+                std::fill (result.words.begin(), result.words.end(), 0);
+                return;
+            }
+            const auto& bitmap = bitmaps[bitmapFor (term.parameter, term.low)];
+            for (size_t w = 0; w < numWords; ++w)
+                result.words[w] &= bitmap[w];
+            return;
+        }
+
+        // Otherwise OR together the bitmaps covering the range, and AND that in.
+        // Slider buckets at the edges of the range may hold values outside it, so
+        // those presets are checked against the actual values.
+        const auto low = term.low;
+        const auto high = definition.isDiscrete ? std::min (term.high, definition.maxValue) : term.high;
+        if (low > high)
+        {
+            std::fill (result.words.begin(), result.words.end(), 0);
+            return;
+        }
+
+        const auto first = bitmapFor (term.parameter, low);
+        const auto last = bitmapFor (term.parameter, high);
+        const auto lowIsExact = definition.isDiscrete || low % bucketSize == 0;
+        const auto highIsExact = definition.isDiscrete || high % bucketSize == bucketSize - 1;
+
+        const auto& column = values[term.parameter];
+        for (size_t w = 0; w < numWords; ++w)
+        {
+            if (result.words[w] == 0)
+                continue;
+
+            uint64_t matches = 0;
+            uint64_t edges = 0;
+            for (auto b = first; b <= last; ++b)
+            {
+                const auto isEdge = (b == first && ! lowIsExact) || (b == last && ! highIsExact);
+                (isEdge ? edges : matches) |= bitmaps[b][w];
+            }
+
+            // Check the presets in the edge buckets one by one
+            edges &= result.words[w] & ~matches;
+            while (edges != 0)
+            {
+                const auto bit = static_cast<size_t> (std::countr_zero (edges));
+                const auto value = column[w * 64 + bit];
+                if (value >= low && value <= high)
+                    matches |= uint64_t (1) << bit;
+                edges &= edges - 1;
+            }
+
+            result.words[w] &= matches;
+        }
+    }
+
+    std::vector<std::vector<uint64_t>> bitmaps;
+    std::array<size_t, numParameters> firstBitmap {};
+    std::array<std::vector<uint8_t>, numParameters> values;
+    size_t numPresets = 0;
+};
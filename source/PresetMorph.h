@@ -0,0 +1,104 @@
+/**
+ * @class PresetMorph
+ * @brief Crossfades between two program states, computed per block on the audio thread.
+ *
+ * Continuous parameters (sliders) are interpolated linearly from the start state to
+ * the target state. Discrete parameters (on/off, channel, CV/gate choices) can't be
+ * interpolated, so they jump from start to target when the morph passes the switch
+ * point (0 = immediately, 1 = at the very end).
+ *
+ * start() precomputes the per-parameter deltas, so process() is a multiply-add per
+ * parameter and never allocates. The morph only produces states; deduplicating the
+ * resulting CCs is up to the caller (see CcDecimator::send).
+ *
+ * NOTE: Not thread-safe. Owned and used by the audio thread.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class PresetMorph
+{
+public:
+    /**
+     * @brief Starts a new morph, replacing any morph in progress.
+     *
+     * @param from The state to start from.
+     * @param to The state to end at.
+     * @param lengthInSamples The length of the morph. Zero or less jumps straight to the target.
+     * @param discreteSwitchPoint Position (0..1) where discrete parameters switch to the target.
+     */
+    void start(const ProgramState& from, const ProgramState& to, int64_t lengthInSamples, float discreteSwitchPoint = 0.5f)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            startValues[i] = static_cast<float>(from[i]);
+            deltas[i] = static_cast<float>(to[i]) - static_cast<float>(from[i]);
+        }
+        source = from;
+        target = to;
+        length = std::max<int64_t>(lengthInSamples, 1);
+        position = 0;
+        switchPoint = std::clamp(discreteSwitchPoint, 0.0f, 1.0f);
+        running = true;
+    }
+
+    /**
+     * @brief Stops the morph where it is.
+     */
+    void stop() { running = false; }
+
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Retrieves how far the morph has come, 0..1.
+     */
+    float getProgress() const
+    {
+        return static_cast<float>(position) / static_cast<float>(length);
+    }
+
+    /**
+     * @brief Advances the morph by one block and computes the state at the end of it.
+     *
+     * @param numSamples The number of samples in the block.
+     * @param state Receives the morphed state.
+     * @return bool True if a state was produced, false if no morph is running.
+     */
+    bool process(int numSamples, ProgramState& state)
+    {
+        if (! running)
+            return false;
+
+        position = std::min<int64_t>(position + numSamples, length);
+        const auto progress = getProgress();
+        const auto useTargetForDiscrete = progress >= switchPoint;
+
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (parameterDefinitions[i].isDiscrete)
+                state[i] = useTargetForDiscrete ? target[i] : source[i];
+            else
+                state[i] = static_cast<uint8_t>(std::lround(startValues[i] + deltas[i] * progress));
+        }
+
+        if (position >= length)
+            running = false;
+
+        return true;
+    }
+
+private:
+    std::array<float, numParameters> startValues {};
+    std::array<float, numParameters> deltas {};
+    ProgramState source {};
+    ProgramState target {};
+    int64_t length = 1;
+    int64_t position = 0;
+    float switchPoint = 0.5f;
+    bool running = false;
+};
@@ -0,0 +1,265 @@
+#include "PresetSimilarity.h"
+#include "BackgroundExecutor.h"
+#include <juce_core/juce_core.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define PRESET_SIMILARITY_X86 1
+    #include <immintrin.h>
+    // GCC and Clang need to be told which functions may use newer instructions.
+    // MSVC allows intrinsics anywhere.
+    #if defined(__GNUC__) || defined(__clang__)
+        #define PRESET_SIMILARITY_TARGET(isa) __attribute__ ((target (isa)))
+    #else
+        #define PRESET_SIMILARITY_TARGET(isa)
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define PRESET_SIMILARITY_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// The SIMD kernels handle the first 16 parameters in one register, and the rest
+// in scalar code
+static_assert (numParameters >= 16 && numParameters <= 32);
+static constexpr size_t numVectorParameters = 16;
+
+//==============================================================================
+// Distance over the parameters that don't fit in a 16 byte register
+static inline uint32_t tailDistance (const ProgramState& record, const ProgramState& target, const PresetSimilarity::Weights& weights)
+{
+    uint32_t distance = 0;
+    for (size_t i = numVectorParameters; i < numParameters; ++i)
+    {
+        const auto difference = record[i] > target[i] ? record[i] - target[i] : target[i] - record[i];
+        distance += static_cast<uint32_t> (difference) * weights[i];
+    }
+    return distance;
+}
+
+static void computeDistancesScalar (const ProgramState* records, size_t numRecords, const ProgramState& target, const PresetSimilarity::Weights& weights, uint32_t* distances)
+{
+    for (size_t r = 0; r < numRecords; ++r)
+    {
+        uint32_t distance = 0;
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto difference = records[r][i] > target[i] ? records[r][i] - target[i] : target[i] - records[r][i];
+            distance += static_cast<uint32_t> (difference) * weights[i];
+        }
+        distances[r] = distance;
+    }
+}
+
+#if PRESET_SIMILARITY_X86
+// |record - target| per byte, times the weights, summed up as 4 x int32.
+// maddubs treats the weights as signed, which is why weights go to 127 only.
+PRESET_SIMILARITY_TARGET ("ssse3")
+static void computeDistancesSsse3 (const ProgramState* records, size_t numRecords, const ProgramState& target, const PresetSimilarity::Weights& weights, uint32_t* distances)
+{
+    const auto targetVector = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (target.values.data()));
+    const auto weightVector = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (weights.data()));
+    const auto ones = _mm_set1_epi16 (1);
+
+    for (size_t r = 0; r < numRecords; ++r)
+    {
+        const auto record = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (records[r].values.data()));
+        const auto difference = _mm_or_si128 (_mm_subs_epu8 (record, targetVector), _mm_subs_epu8 (targetVector, record));
+        auto sums = _mm_madd_epi16 (_mm_maddubs_epi16 (difference, weightVector), ones);
+        sums = _mm_add_epi32 (sums, _mm_shuffle_epi32 (sums, _MM_SHUFFLE (1, 0, 3, 2)));
+        sums = _mm_add_epi32 (sums, _mm_shuffle_epi32 (sums, _MM_SHUFFLE (2, 3, 0, 1)));
+        distances[r] = static_cast<uint32_t> (_mm_cvtsi128_si32 (sums)) + tailDistance (records[r], target, weights);
+    }
+}
+
+// Same as SSSE3, but two records at a time, one in each 128 bit lane
+PRESET_SIMILARITY_TARGET ("avx2")
+static void computeDistancesAvx2 (const ProgramState* records, size_t numRecords, const ProgramState& target, const PresetSimilarity::Weights& weights, uint32_t* distances)
+{
+    const auto targetVector = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (target.values.data())));
+    const auto weightVector = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (weights.data())));
+    const auto ones = _mm256_set1_epi16 (1);
+
+    size_t r = 0;
+    for (; r + 2 <= numRecords; r += 2)
+    {
+        const auto first = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (records[r].values.data()));
+        const auto second = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (records[r + 1].values.data()));
+        const auto both = _mm256_inserti128_si256 (_mm256_castsi128_si256 (first), second, 1);
+        const auto difference = _mm256_or_si256 (_mm256_subs_epu8 (both, targetVector), _mm256_subs_epu8 (targetVector, both));
+        auto sums = _mm256_madd_epi16 (_mm256_maddubs_epi16 (difference, weightVector), ones);
+        sums = _mm256_add_epi32 (sums, _mm256_shuffle_epi32 (sums, _MM_SHUFFLE (1, 0, 3, 2)));
+        sums = _mm256_add_epi32 (sums, _mm256_shuffle_epi32 (sums, _MM_SHUFFLE (2, 3, 0, 1)));
+        distances[r] = static_cast<uint32_t> (_mm256_extract_epi32 (sums, 0)) + tailDistance (records[r], target, weights);
+        distances[r + 1] = static_cast<uint32_t> (_mm256_extract_epi32 (sums, 4)) + tailDistance (records[r + 1], target, weights);
+    }
+
+    computeDistancesScalar (records + r, numRecords - r, target, weights, distances + r);
+}
+#endif
+
+#if PRESET_SIMILARITY_NEON
+static void computeDistancesNeon (const ProgramState* records, size_t numRecords, const ProgramState& target, const PresetSimilarity::Weights& weights, uint32_t* distances)
+{
+    const auto targetVector = vld1q_u8 (target.values.data());
+    const auto weightVector = vld1q_u8 (weights.data());
+
+    for (size_t r = 0; r < numRecords; ++r)
+    {
+        const auto difference = vabdq_u8 (vld1q_u8 (records[r].values.data()), targetVector);
+        auto products = vmull_u8 (vget_low_u8 (difference), vget_low_u8 (weightVector));
+        products = vmlal_u8 (products, vget_high_u8 (difference), vget_high_u8 (weightVector));
+        distances[r] = vaddlvq_u16 (products) + tailDistance (records[r], target, weights);
+    }
+}
+#endif
+
+//==============================================================================
+PresetSimilarity::Weights PresetSimilarity::getDefaultWeights()
+{
+    // A slider moving across its whole range and a combo box changing value
+    // count about the same
+    Weights weights {};
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        const auto& definition = parameterDefinitions[i];
+        const auto range = std::max (definition.maxValue - definition.minValue, 1);
+        weights[i] = static_cast<uint8_t> (definition.isDiscrete ? std::max (127 / range, 1) : 1);
+    }
+    return weights;
+}
+
+bool PresetSimilarity::isKernelAvailable (Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::scalar:
+            return true;
+#if PRESET_SIMILARITY_X86
+        case Kernel::ssse3:
+            return juce::SystemStats::hasSSSE3();
+        case Kernel::avx2:
+            return juce::SystemStats::hasAVX2();
+#endif
+#if PRESET_SIMILARITY_NEON
+        case Kernel::neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+PresetSimilarity::Kernel PresetSimilarity::getBestKernel()
+{
+    for (auto kernel : { Kernel::avx2, Kernel::neon, Kernel::ssse3 })
+    {
+        if (isKernelAvailable (kernel))
+            return kernel;
+    }
+    return Kernel::scalar;
+}
+
+const char* PresetSimilarity::getKernelName (Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::scalar:
+            return "scalar";
+        case Kernel::ssse3:
+            return "SSSE3";
+        case Kernel::avx2:
+            return "AVX2";
+        case Kernel::neon:
+            return "NEON";
+    }
+    return "unknown";
+}
+
+void PresetSimilarity::computeDistances (const ProgramState* records,
+    size_t numRecords,
+    const ProgramState& target,
+    const Weights& weights,
+    uint32_t* distances,
+    Kernel kernel)
+{
+    jassert (isKernelAvailable (kernel));
+    jassert (std::all_of (weights.begin(), weights.end(), [] (uint8_t w) { return w <= 127; }));
+
+    switch (kernel)
+    {
+#if PRESET_SIMILARITY_X86
+        case Kernel::ssse3:
+            computeDistancesSsse3 (records, numRecords, target, weights, distances);
+            return;
+        case Kernel::avx2:
+            computeDistancesAvx2 (records, numRecords, target, weights, distances);
+            return;
+#endif
+#if PRESET_SIMILARITY_NEON
+        case Kernel::neon:
+            computeDistancesNeon (records, numRecords, target, weights, distances);
+            return;
+#endif
+        default:
+            computeDistancesScalar (records, numRecords, target, weights, distances);
+            return;
+    }
+}
+
+std::vector<PresetSimilarity::Match> PresetSimilarity::findSimilar (const std::vector<ProgramState>& records,
+    const ProgramState& target,
+    size_t maxResults,
+    const Weights& weights,
+    Kernel kernel,
+    int numThreads)
+{
+    const auto numRecords = records.size();
+    std::vector<uint32_t> distances (numRecords);
+
+    // Scan, in chunks on several threads for large libraries
+    if (numThreads <= 0)
+        numThreads = static_cast<int> (std::min<size_t> (static_cast<size_t> (juce::SystemStats::getNumCpus()), numRecords / minRecordsPerThread));
+    numThreads = std::max (numThreads, 1);
+
+    if (numThreads == 1)
+    {
+        computeDistances (records.data(), numRecords, target, weights, distances.data(), kernel);
+    }
+    else
+    {
+        const auto chunkSize = (numRecords + static_cast<size_t> (numThreads) - 1) / static_cast<size_t> (numThreads);
+        const auto numChunks = (numRecords + chunkSize - 1) / chunkSize;
+        const juce::SharedResourcePointer<BackgroundExecutor> executor;
+        executor->parallelFor (numChunks, [&] (size_t chunk) {
+            const auto start = chunk * chunkSize;
+            const auto count = std::min (chunkSize, numRecords - start);
+            computeDistances (records.data() + start, count, target, weights, distances.data() + start, kernel);
+        }, BackgroundExecutor::Priority::high);
+    }
+
+    // Keep the best matches in a max-heap, so the worst of them is on top
+    const auto isCloser = [] (const Match& a, const Match& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+    };
+
+    std::vector<Match> best;
+    best.reserve (std::min (maxResults, numRecords) + 1);
+    for (size_t i = 0; i < numRecords && maxResults > 0; ++i)
+    {
+        const Match match { i, distances[i] };
+        if (best.size() < maxResults)
+        {
+            best.push_back (match);
+            std::push_heap (best.begin(), best.end(), isCloser);
+        }
+        else if (isCloser (match, best.front()))
+        {
+            std::pop_heap (best.begin(), best.end(), isCloser);
+            best.back() = match;
+            std::push_heap (best.begin(), best.end(), isCloser);
+        }
+    }
+
+    std::sort_heap (best.begin(), best.end(), isCloser);
+    return best;
+}
@@ -0,0 +1,95 @@
+/**
+ * @class PresetSimilarity
+ * @brief Ranks preset records by weighted distance to a program state.
+ *
+ * The distance between two states is the weighted sum of absolute differences of
+ * all parameter values (weighted L1). Weights are 0-127, so a combo box (ie. on/off)
+ * can count as much as a full sweep of a slider.
+ *
+ * Distances are computed by one of several kernels:
+ * - scalar: plain C++, works everywhere and is the reference for the others.
+ * - ssse3 / avx2: x86, 1 or 2 records per instruction sequence.
+ * - neon: ARM (Apple Silicon), 1 record per instruction sequence.
+ * The best kernel available on the running CPU is picked by default. Very large
+ * libraries are split into chunks and scanned in parallel on the BackgroundExecutor.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <vector>
+
+class PresetSimilarity
+{
+public:
+    using Weights = std::array<uint8_t, numParameters>;
+
+    enum class Kernel
+    {
+        scalar,
+        ssse3,
+        avx2,
+        neon
+    };
+
+    struct Match
+    {
+        size_t index;
+        uint32_t distance;
+    };
+
+    /**
+     * @brief Weights which make every parameter count the same over its full range.
+     */
+    static Weights getDefaultWeights();
+
+    /**
+     * @brief Checks if a kernel can run on this CPU.
+     */
+    static bool isKernelAvailable (Kernel kernel);
+
+    /**
+     * @brief Retrieves the fastest kernel available on this CPU.
+     */
+    static Kernel getBestKernel();
+
+    static const char* getKernelName (Kernel kernel);
+
+    /**
+     * @brief Computes the distance of every record to the target.
+     *
+     * @param records The records to scan.
+     * @param numRecords The number of records.
+     * @param target The state to compare to.
+     * @param weights The weight of each parameter.
+     * @param distances Receives one distance per record.
+     * @param kernel The kernel to use. Must be available on this CPU.
+     */
+    static void computeDistances (const ProgramState* records,
+        size_t numRecords,
+        const ProgramState& target,
+        const Weights& weights,
+        uint32_t* distances,
+        Kernel kernel);
+
+    /**
+     * @brief Finds the records closest to the target.
+     *
+     * @param records The records to scan, ie. PresetBank::getStates().
+     * @param target The state to compare to, ie. the state of the editor.
+     * @param maxResults The maximum number of matches to return.
+     * @param weights The weight of each parameter.
+     * @param kernel The kernel to use. Must be available on this CPU.
+     * @param numThreads Number of chunks to scan in parallel, 0 picks automatically from the library size.
+     * @return std::vector<Match> The closest records, closest first. Ties are in bank order.
+     */
+    static std::vector<Match> findSimilar (const std::vector<ProgramState>& records,
+        const ProgramState& target,
+        size_t maxResults,
+        const Weights& weights = getDefaultWeights(),
+        Kernel kernel = getBestKernel(),
+        int numThreads = 0);
+
+    // Below this many records, scanning isn't worth spreading over threads
+    static constexpr size_t minRecordsPerThread = 32768;
+};
@@ -0,0 +1,220 @@
+/**
+ * @class ProgramExporter
+ * @brief Streams programs to disk as the CC sequence that programs a 0-Coast.
+ *
+ * Two formats are supported:
+ * - Standard MIDI File (format 0, one track). Each program starts on its own bar,
+ *   with a marker holding the preset name, followed by one CC per parameter. Load
+ *   it into a hardware sequencer, play it, and the 0-Coast is programmed.
+ * - Raw dump. Just the MIDI bytes of the CCs, one complete message after another.
+ *   Handy for tools that send a file of raw MIDI bytes (ie. .syx senders).
+ *
+ * The CC sequence is built from parameterDefinitions, and every event is written
+ * straight to the output stream as it's produced. Memory use is fixed, no matter
+ * how many programs are exported. The only thing needing a seekable stream is the
+ * MIDI file track length, which is patched in by finish().
+ *
+ * NOTE: Remember to put the 0-Coast in program page mode (hold PGM_A) before
+ * playing back an export!
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "PresetBank.h"
+
+class ProgramExporter
+{
+public:
+    enum class Format
+    {
+        standardMidiFile,
+        rawDump
+    };
+
+    static constexpr int ticksPerQuarterNote = 480;
+    static constexpr int ticksBetweenPrograms = ticksPerQuarterNote * 4; // One bar in 4/4
+
+    /**
+     * @brief Creates an exporter writing to a stream. The stream must outlive the exporter.
+     *
+     * @param outputStream The stream to write to. Must be seekable for Standard MIDI Files.
+     * @param fileFormat The format to write.
+     * @param midiChannel The MIDI channel (1-16) the 0-Coast listens on.
+     */
+    ProgramExporter (juce::OutputStream& outputStream, Format fileFormat, int midiChannel = MIDI_CHANNEL)
+        : stream (outputStream),
+          format (fileFormat),
+          ccStatus (static_cast<uint8_t> (0xB0 | ((midiChannel - 1) & 0x0F)))
+    {
+        jassert (midiChannel >= 1 && midiChannel <= 16);
+
+        if (format == Format::standardMidiFile)
+            writeHeader();
+    }
+
+    ~ProgramExporter()
+    {
+        finish();
+    }
+
+    /**
+     * @brief Appends one program to the export.
+     *
+     * @param state The parameter values to program.
+     * @param name The preset name, written as a marker in MIDI files.
+     */
+    void writeProgram (const ProgramState& state, const juce::String& name = {})
+    {
+        jassert (! finished);
+        if (format == Format::rawDump)
+        {
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                stream.writeByte (static_cast<char> (ccStatus));
+                stream.writeByte (static_cast<char> (parameterDefinitions[i].cc));
+                stream.writeByte (static_cast<char> (state[i] & 0x7F));
+            }
+            return;
+        }
+
+        // Each program starts on a new bar, with the preset name as a marker
+        const auto delta = static_cast<uint32_t> (numProgramsWritten == 0 ? 0 : ticksBetweenPrograms);
+        if (name.isNotEmpty())
+        {
+            const auto utf8 = name.toUTF8();
+            const auto numBytes = utf8.sizeInBytes() - 1;
+            writeVariableLength (delta);
+            writeTrackByte (0xFF);
+            writeTrackByte (0x06); // Marker
+            writeVariableLength (static_cast<uint32_t> (numBytes));
+            for (size_t i = 0; i < numBytes; ++i)
+                writeTrackByte (static_cast<uint8_t> (utf8.getAddress()[i]));
+            writeVariableLength (0);
+        }
+        else
+        {
+            writeVariableLength (delta);
+        }
+
+        // One CC per parameter. Running status after the first one, as the meta
+        // event above cancels it.
+        writeTrackByte (ccStatus);
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (i > 0)
+                writeVariableLength (0);
+            writeTrackByte (static_cast<uint8_t> (parameterDefinitions[i].cc));
+            writeTrackByte (static_cast<uint8_t> (state[i] & 0x7F));
+        }
+        ++numProgramsWritten;
+    }
+
+    /**
+     * @brief Appends a whole bank, in bank order.
+     */
+    void writeBank (const PresetBank& bank)
+    {
+        for (size_t i = 0; i < bank.size(); ++i)
+            writeProgram (bank.getState (i), bank.getName (i));
+    }
+
+    /**
+     * @brief Completes the export. Called by the destructor if not called before.
+     *
+     * @return bool True if everything was written, false if the stream couldn't seek
+     * back to patch in the MIDI file track length.
+     */
+    bool finish()
+    {
+        if (finished)
+            return true;
+        finished = true;
+
+        if (format == Format::rawDump)
+        {
+            stream.flush();
+            return true;
+        }
+
+        // End of track
+        writeVariableLength (0);
+        writeTrackByte (0xFF);
+        writeTrackByte (0x2F);
+        writeTrackByte (0x00);
+
+        // Go back and patch in the track length
+        const auto endPosition = stream.getPosition();
+        if (! stream.setPosition (trackLengthPosition))
+            return false;
+        stream.writeIntBigEndian (static_cast<int> (trackLength));
+        const auto result = stream.setPosition (endPosition);
+        stream.flush();
+        return result;
+    }
+
+    /**
+     * @brief Exports a whole bank to a file, replacing the file if it exists.
+     *
+     * @return bool True if the file was written, false otherwise.
+     */
+    static bool exportBank (const PresetBank& bank, const juce::File& file, Format format)
+    {
+        file.deleteFile();
+        juce::FileOutputStream fileStream (file);
+        if (! fileStream.openedOk())
+            return false;
+
+        ProgramExporter exporter (fileStream, format);
+        exporter.writeBank (bank);
+        return exporter.finish() && fileStream.getStatus().wasOk();
+    }
+
+private:
+    void writeHeader()
+    {
+        stream.write ("MThd", 4);
+        stream.writeIntBigEndian (6);
+        stream.writeShortBigEndian (0); // Format 0
+        stream.writeShortBigEndian (1); // One track
+        stream.writeShortBigEndian (ticksPerQuarterNote);
+
+        stream.write ("MTrk", 4);
+        trackLengthPosition = stream.getPosition();
+        stream.writeIntBigEndian (0); // Patched by finish()
+    }
+
+    void writeTrackByte (uint8_t byte)
+    {
+        stream.writeByte (static_cast<char> (byte));
+        ++trackLength;
+    }
+
+    void writeVariableLength (uint32_t value)
+    {
+        // Up to 4 bytes, 7 bits each, most significant first
+        uint8_t bytes[4];
+        int numBytes = 0;
+        do
+        {
+            bytes[numBytes++] = static_cast<uint8_t> (value & 0x7F);
+            value >>= 7;
+        } while (value > 0 && numBytes < 4);
+
+        while (numBytes > 0)
+        {
+            --numBytes;
+            writeTrackByte (static_cast<uint8_t> (bytes[numBytes] | (numBytes > 0 ? 0x80 : 0x00)));
+        }
+    }
+
+    juce::OutputStream& stream;
+    const Format format;
+    const uint8_t ccStatus;
+    juce::int64 trackLengthPosition = 0;
+    uint32_t trackLength = 0;
+    size_t numProgramsWritten = 0;
+    bool finished = false;
+
+    JUCE_DECLARE_NON_COPYABLE (ProgramExporter)
+};
@@ -0,0 +1,115 @@
+/**
+ * @class ProgramRecall
+ * @brief Ready-made CC bursts for recalling presets with a MIDI Program Change.
+ *
+ * A sequencer sends Program Change n, and processBlock sends the CCs which take the
+ * device from its current state to preset slot n. So that this is a lookup and a
+ * copy on the audio thread, everything is worked out beforehand, in a Table:
+ * - For every slot, the burst of CCs which differ between the device state the
+ *   table was built against (the basis) and the preset.
+ * - For every slot, the full burst with every parameter, for when the device has
+ *   moved away from the basis since (the table is rebuilt, but may not be ready yet).
+ *
+ * build() reuses whatever it can from the previous table: slots whose preset didn't
+ * change keep their full burst, and also their diff burst while the basis is the same.
+ *
+ * The processor builds tables on the background executor whenever the presets or
+ * the device state change, see ProgrammerProcessor::setRecallBank().
+ *
+ * NOTE: A Table is never changed once it's handed to the audio thread.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <algorithm>
+#include <vector>
+
+class ProgramRecall
+{
+public:
+    // One per MIDI program number
+    static constexpr size_t numSlots = 128;
+
+    struct Cc
+    {
+        uint8_t index; // Index in parameterDefinitions
+        uint8_t value;
+    };
+
+    struct Burst
+    {
+        std::array<Cc, numParameters> ccs {};
+        uint8_t numCcs = 0;
+    };
+
+    struct Table
+    {
+        ProgramState basis {};
+        size_t numPresets = 0;
+        std::array<ProgramState, numSlots> presets {};
+        std::array<Burst, numSlots> bursts {};
+        std::array<Burst, numSlots> fullBursts {};
+
+        /**
+         * @brief The burst which takes the device from deviceState to a slot. Realtime-safe.
+         *
+         * @return const Burst* The burst, or nullptr if the slot holds no preset.
+         */
+        const Burst* getBurst (size_t slot, const ProgramState& deviceState) const
+        {
+            if (slot >= numPresets)
+                return nullptr;
+            return deviceState == basis ? &bursts[slot] : &fullBursts[slot];
+        }
+    };
+
+    /**
+     * @brief Fills a table for the presets (the first numSlots of them), against the
+     * device state basis.
+     *
+     * @param table The table to fill.
+     * @param previous The table built before, to reuse unchanged slots from. Can be nullptr.
+     * @param presets The preset for every slot, ie. PresetBank::getStates().
+     * @param basis The device state the bursts start from.
+     * @return size_t The number of diff bursts which had to be worked out again.
+     */
+    static size_t build (Table& table, const Table* previous, const std::vector<ProgramState>& presets, const ProgramState& basis)
+    {
+        table.basis = basis;
+        table.numPresets = std::min (presets.size(), numSlots);
+
+        size_t numBuilt = 0;
+        for (size_t slot = 0; slot < table.numPresets; ++slot)
+        {
+            const auto& preset = presets[slot];
+            table.presets[slot] = preset;
+
+            const auto unchanged = previous != nullptr && slot < previous->numPresets && previous->presets[slot] == preset;
+            table.fullBursts[slot] = unchanged ? previous->fullBursts[slot] : makeBurst (nullptr, preset);
+
+            if (unchanged && previous->basis == basis)
+                table.bursts[slot] = previous->bursts[slot];
+            else
+            {
+                table.bursts[slot] = makeBurst (&basis, preset);
+                ++numBuilt;
+            }
+        }
+        return numBuilt;
+    }
+
+    /**
+     * @brief The CCs which differ between two states, or all of them without from.
+     */
+    static Burst makeBurst (const ProgramState* from, const ProgramState& to)
+    {
+        Burst burst;
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (from == nullptr || (*from)[i] != to[i])
+                burst.ccs[burst.numCcs++] = { static_cast<uint8_t> (i), to[i] };
+        }
+        return burst;
+    }
+};
@@ -0,0 +1,81 @@
+/**
+ * @file ProgramState.h
+ * @brief Plain value snapshots of all program page parameters.
+ *
+ * ProgramState holds one value per parameter, indexed like parameterDefinitions.
+ * It's a small trivially copyable struct, so it can be copied around freely (also
+ * on the audio thread).
+ *
+ * PackedProgramState stores the same values with 7 bits per parameter (all CC
+ * values fit in 7 bits), for when lots of states need to be kept around, ie. the
+ * undo history.
+ */
+
+#pragma once
+
+#include "ParameterDefinitions.h"
+#include <array>
+#include <cstdint>
+
+struct ProgramState
+{
+    std::array<uint8_t, numParameters> values;
+
+    /**
+     * @brief Creates a state holding the default value of every parameter.
+     */
+    static constexpr ProgramState defaults()
+    {
+        ProgramState state {};
+        for (size_t i = 0; i < numParameters; ++i)
+            state.values[i] = static_cast<uint8_t> (parameterDefinitions[i].defaultValue);
+        return state;
+    }
+
+    uint8_t& operator[] (size_t index) { return values[index]; }
+    uint8_t operator[] (size_t index) const { return values[index]; }
+
+    bool operator== (const ProgramState&) const = default;
+};
+
+struct PackedProgramState
+{
+    static constexpr int bitsPerValue = 7;
+    static constexpr uint64_t valueMask = (1u << bitsPerValue) - 1;
+    static constexpr size_t valuesPerWord = 64 / bitsPerValue;
+
+    std::array<uint64_t, 2> words;
+
+    /**
+     * @brief Packs a state, 7 bits per parameter.
+     */
+    static constexpr PackedProgramState pack (const ProgramState& state)
+    {
+        PackedProgramState packed {};
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto shift = (i % valuesPerWord) * bitsPerValue;
+            packed.words[i / valuesPerWord] |= (static_cast<uint64_t> (state.values[i]) & valueMask) << shift;
+        }
+        return packed;
+    }
+
+    /**
+     * @brief Unpacks the values into a plain state.
+     */
+    constexpr ProgramState unpack() const
+    {
+        ProgramState state {};
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto shift = (i % valuesPerWord) * bitsPerValue;
+            state.values[i] = static_cast<uint8_t> ((words[i / valuesPerWord] >> shift) & valueMask);
+        }
+        return state;
+    }
+
+    bool operator== (const PackedProgramState&) const = default;
+};
+
+static_assert (numParameters <= 2 * PackedProgramState::valuesPerWord, "Too many parameters for PackedProgramState");
+static_assert (sizeof (PackedProgramState) == 16);
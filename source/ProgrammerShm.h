@@ -0,0 +1,147 @@
+/*
+ * ProgrammerShm.h
+ *
+ * Shared memory control ring, for sending CC changes to 0-Programmer from another
+ * process on the same machine (ie. a sequencer), without sockets in between.
+ *
+ * 0-Programmer creates a named shared memory segment holding one ProgrammerShmRing:
+ *  - POSIX: shm_open (PROGRAMMER_SHM_NAME), sizeof (ProgrammerShmRing) bytes
+ *  - Windows: a named file mapping, "Local\" + the name without the leading slash
+ * Only one 0-Programmer can own a name at a time. A segment whose owner process is
+ * gone (ie. after a crash) is replaced.
+ *
+ * The ring is single producer (the client) and single consumer (the audio thread of
+ * 0-Programmer). The client maps the segment, checks magic, version and capacity, and
+ * calls programmer_shm_push() for every CC change. Messages are four int32s:
+ * { type = 0 (cc), channel 1-16, CC number, value }.
+ * They are sent on the next audio block. If the ring is full, the push fails and the
+ * client decides what to do (drop or retry).
+ *
+ * Plain C (C99 + GCC/Clang/MSVC atomics), so it can be used from any language with a
+ * C FFI. See shmclient/ShmClient.c for an example.
+ */
+
+#ifndef PROGRAMMER_SHM_H
+#define PROGRAMMER_SHM_H
+
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROGRAMMER_SHM_NAME "/0-programmer-control"
+#define PROGRAMMER_SHM_MAGIC 0x4D484330u /* "0CHM" */
+#define PROGRAMMER_SHM_VERSION 1u
+#define PROGRAMMER_SHM_CAPACITY 1024u /* Must be a power of two */
+#define PROGRAMMER_SHM_TYPE_CC 0
+
+typedef struct ProgrammerShmMessage
+{
+    int32_t type;   /* PROGRAMMER_SHM_TYPE_CC */
+    int32_t value1; /* MIDI channel, 1-16 */
+    int32_t value2; /* CC number, 0-127 */
+    int32_t value3; /* CC value, 0-127 */
+} ProgrammerShmMessage;
+
+/* The indices are free running (they wrap at 2^32), and each is written by one side
+ * only. They are on separate cache lines, so the two sides don't slow each other down. */
+typedef struct ProgrammerShmRing
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t ownerPid;   /* Process id of the 0-Programmer which created the segment */
+    uint32_t ownerToken; /* Random, tells this segment apart from a later one with the same name */
+    uint8_t padding0[44];
+
+    volatile uint32_t writeIndex; /* Written by the client */
+    uint8_t padding1[60];
+
+    volatile uint32_t readIndex; /* Written by 0-Programmer */
+    uint8_t padding2[60];
+
+    ProgrammerShmMessage messages[PROGRAMMER_SHM_CAPACITY];
+} ProgrammerShmRing;
+
+static inline uint32_t programmer_shm_load_acquire (const volatile uint32_t* index)
+{
+#if defined(_MSC_VER)
+    /* Interlocked operations are full hardware barriers, also on ARM64 (where
+     * _ReadWriteBarrier alone would only stop the compiler from reordering) */
+    return (uint32_t) _InterlockedOr ((volatile long*) index, 0);
+#else
+    return __atomic_load_n (index, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void programmer_shm_store_release (volatile uint32_t* index, uint32_t value)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchange ((volatile long*) index, (long) value);
+#else
+    __atomic_store_n (index, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/* Sets up an empty ring. Only called by the side which created the segment, after
+ * setting ownerPid and ownerToken. */
+static inline void programmer_shm_init (ProgrammerShmRing* ring)
+{
+    ring->version = PROGRAMMER_SHM_VERSION;
+    ring->capacity = PROGRAMMER_SHM_CAPACITY;
+    programmer_shm_store_release (&ring->writeIndex, 0);
+    programmer_shm_store_release (&ring->readIndex, 0);
+
+    /* Written last, so a client which sees the magic sees an initialised ring */
+    programmer_shm_store_release (&ring->magic, PROGRAMMER_SHM_MAGIC);
+}
+
+/* Returns 1 if the ring was set up by a compatible version of 0-Programmer. */
+static inline int programmer_shm_is_valid (const ProgrammerShmRing* ring)
+{
+    return programmer_shm_load_acquire (&ring->magic) == PROGRAMMER_SHM_MAGIC
+        && ring->version == PROGRAMMER_SHM_VERSION
+        && ring->capacity == PROGRAMMER_SHM_CAPACITY;
+}
+
+static inline uint32_t programmer_shm_num_ready (const ProgrammerShmRing* ring)
+{
+    return programmer_shm_load_acquire (&ring->writeIndex) - programmer_shm_load_acquire (&ring->readIndex);
+}
+
+/* Producer (client) side. Returns 1 if the message was queued, 0 if the ring is full. */
+static inline int programmer_shm_push (ProgrammerShmRing* ring, const ProgrammerShmMessage* message)
+{
+    const uint32_t write = ring->writeIndex;
+    const uint32_t read = programmer_shm_load_acquire (&ring->readIndex);
+    if (write - read >= PROGRAMMER_SHM_CAPACITY)
+        return 0;
+
+    ring->messages[write & (PROGRAMMER_SHM_CAPACITY - 1u)] = *message;
+    programmer_shm_store_release (&ring->writeIndex, write + 1u);
+    return 1;
+}
+
+/* Consumer (0-Programmer) side. Returns 1 if a message was read, 0 if the ring is empty. */
+static inline int programmer_shm_pop (ProgrammerShmRing* ring, ProgrammerShmMessage* message)
+{
+    const uint32_t read = ring->readIndex;
+    const uint32_t write = programmer_shm_load_acquire (&ring->writeIndex);
+    if (write == read)
+        return 0;
+
+    *message = ring->messages[read & (PROGRAMMER_SHM_CAPACITY - 1u)];
+    programmer_shm_store_release (&ring->readIndex, read + 1u);
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROGRAMMER_SHM_H */
@@ -0,0 +1,260 @@
+#include "RealtimeWatchdog.h"
+
+#if PROGRAMMER_REALTIME_WATCHDOG
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdio>
+#include <map>
+
+namespace RealtimeWatchdog
+{
+    namespace
+    {
+        // Nesting depth of ScopedAudioThread on this thread
+        thread_local int audioThreadDepth = 0;
+
+        // Set while a report is being recorded, so the allocations and locks of the
+        // watchdog itself aren't reported
+        thread_local bool isReporting = false;
+
+        std::atomic<uint64_t> numReports[numHazards] {};
+
+        const char* getHazardName (Hazard hazard)
+        {
+            switch (hazard)
+            {
+                case Hazard::allocation: return "allocation";
+                case Hazard::lock: return "lock";
+                case Hazard::logging: return "logging";
+                case Hazard::blockingCall: return "blocking call";
+            }
+            return "unknown";
+        }
+
+        struct Site
+        {
+            uint64_t count = 0;
+            std::string stackTrace;
+        };
+
+        class Registry
+        {
+        public:
+            ~Registry()
+            {
+                // Report at shutdown
+                if (getNumReports() > 0)
+                    std::fputs (getReport().c_str(), stderr);
+            }
+
+            void add (Hazard hazard, const char* site)
+            {
+                // The stack trace is only captured the first time a site is seen
+                const std::scoped_lock lock (mutex);
+                auto& entry = sites[std::string (getHazardName (hazard)) + ": " + site];
+                if (entry.count++ == 0)
+                    entry.stackTrace = juce::SystemStats::getStackBacktrace().toStdString();
+            }
+
+            std::string getReport()
+            {
+                const std::scoped_lock lock (mutex);
+                std::string text = "Realtime watchdog: " + std::to_string (getNumReports()) + " hazards in processBlock\n";
+                for (const auto& [site, entry] : sites)
+                    text += "  " + std::to_string (entry.count) + "x " + site + "\n" + entry.stackTrace + "\n";
+                return text;
+            }
+
+        private:
+            std::mutex mutex;
+            std::map<std::string, Site> sites;
+        };
+
+        Registry& getRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        class WatchdogLogger : public juce::Logger
+        {
+        public:
+            explicit WatchdogLogger (juce::Logger* previousLogger) : previous (previousLogger) {}
+
+            ~WatchdogLogger() override
+            {
+                if (juce::Logger::getCurrentLogger() == this)
+                    juce::Logger::setCurrentLogger (previous);
+            }
+
+            void logMessage (const juce::String& message) override
+            {
+                report (Hazard::logging, "juce::Logger::writeToLog");
+                if (previous != nullptr)
+                    previous->writeToLog (message);
+                else
+                    juce::Logger::outputDebugString (message);
+            }
+
+        private:
+            juce::Logger* previous;
+        };
+    }
+
+    void enterAudioThread() { ++audioThreadDepth; }
+    void exitAudioThread() { --audioThreadDepth; }
+    bool isAudioThread() { return audioThreadDepth > 0; }
+
+    void report (Hazard hazard, const char* site)
+    {
+        if (audioThreadDepth == 0 || isReporting)
+            return;
+
+        isReporting = true;
+        numReports[static_cast<int> (hazard)].fetch_add (1, std::memory_order_relaxed);
+        getRegistry().add (hazard, site);
+        isReporting = false;
+    }
+
+    uint64_t getNumReports()
+    {
+        uint64_t total = 0;
+        for (const auto& count : numReports)
+            total += count.load (std::memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t getNumReports (Hazard hazard)
+    {
+        return numReports[static_cast<int> (hazard)].load (std::memory_order_relaxed);
+    }
+
+    std::string getReport()
+    {
+        return getRegistry().getReport();
+    }
+
+    void installLogger()
+    {
+        static WatchdogLogger logger (juce::Logger::getCurrentLogger());
+        if (juce::Logger::getCurrentLogger() != &logger)
+            juce::Logger::setCurrentLogger (&logger);
+    }
+}
+
+#endif
+
+#if PROGRAMMER_REALTIME_WATCHDOG || PROGRAMMER_ALLOCATION_HOOK
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace RealtimeWatchdog
+{
+    namespace
+    {
+        std::atomic<void (*)()> allocationHook { nullptr };
+
+        void noteAllocation (const char* site)
+        {
+            if (auto* hook = allocationHook.load (std::memory_order_relaxed))
+                hook();
+            report (Hazard::allocation, site);
+        }
+    }
+
+    void setAllocationHook (void (*hook)())
+    {
+        allocationHook.store (hook);
+    }
+}
+
+//==============================================================================
+// Replacements of the global allocation functions, which call the allocation hook and
+// report to the watchdog. The only replacements in the program: tests hook into these.
+
+namespace
+{
+    void* watchedAlloc (std::size_t size)
+    {
+        RealtimeWatchdog::noteAllocation ("operator new");
+        return std::malloc (size > 0 ? size : 1);
+    }
+
+    void* watchedAlignedAlloc (std::size_t size, std::align_val_t alignment)
+    {
+        RealtimeWatchdog::noteAllocation ("operator new");
+        const auto align = static_cast<std::size_t> (alignment);
+        const auto rounded = (std::max<std::size_t> (size, 1) + align - 1) / align * align;
+       #if JUCE_WINDOWS
+        return _aligned_malloc (rounded, align);
+       #else
+        return std::aligned_alloc (align, rounded);
+       #endif
+    }
+
+    void watchedFree (void* ptr)
+    {
+        if (ptr != nullptr)
+            RealtimeWatchdog::report (RealtimeWatchdog::Hazard::allocation, "operator delete");
+        std::free (ptr);
+    }
+
+    void watchedAlignedFree (void* ptr)
+    {
+        if (ptr != nullptr)
+            RealtimeWatchdog::report (RealtimeWatchdog::Hazard::allocation, "operator delete");
+       #if JUCE_WINDOWS
+        _aligned_free (ptr);
+       #else
+        std::free (ptr);
+       #endif
+    }
+}
+
+void* operator new (std::size_t size)
+{
+    if (auto* ptr = watchedAlloc (size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    if (auto* ptr = watchedAlloc (size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept { return watchedAlloc (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { return watchedAlloc (size); }
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* ptr = watchedAlignedAlloc (size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* ptr = watchedAlignedAlloc (size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete (void* ptr) noexcept { watchedFree (ptr); }
+void operator delete[] (void* ptr) noexcept { watchedFree (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept { watchedFree (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept { watchedFree (ptr); }
+void operator delete (void* ptr, const std::nothrow_t&) noexcept { watchedFree (ptr); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept { watchedFree (ptr); }
+void operator delete (void* ptr, std::align_val_t) noexcept { watchedAlignedFree (ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept { watchedAlignedFree (ptr); }
+void operator delete (void* ptr, std::size_t, std::align_val_t) noexcept { watchedAlignedFree (ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept { watchedAlignedFree (ptr); }
+
+#endif
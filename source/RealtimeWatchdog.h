@@ -0,0 +1,142 @@
+/**
+ * @file RealtimeWatchdog.h
+ * @brief Development build mode which reports blocking calls made from processBlock.
+ *
+ * Build with -DPROGRAMMER_REALTIME_WATCHDOG=ON to enable it. processBlock marks the
+ * audio thread with a ScopedAudioThread, and while it's marked, these are reported:
+ *
+ *  - heap allocations and frees (the global operator new/delete are replaced)
+ *  - blocking on a RealtimeWatchdog::SpinLock (ie. the processor's spin locks, which the
+ *    audio thread must only ever try-lock)
+ *  - juce::Logger::writeToLog (once installLogger() was called)
+ *  - anything annotated with REALTIME_WATCHDOG_BLOCKING_CALL, ie. stopping the journal
+ *
+ * Every report is counted, and the first occurrence of each call site is kept with a
+ * stack trace. The collected reports are printed to stderr at shutdown.
+ *
+ * NOTE: Capturing a stack trace is slow, and takes a lock, so this is only meant for
+ * finding hazards during development. Without the build flag, everything in here
+ * compiles to nothing, and SpinLock only wraps a juce::SpinLock.
+ *
+ * The test build defines PROGRAMMER_ALLOCATION_HOOK instead, which only keeps the
+ * operator new/delete replacements and setAllocationHook(), to count allocations.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <string>
+
+#ifndef PROGRAMMER_REALTIME_WATCHDOG
+    #define PROGRAMMER_REALTIME_WATCHDOG 0
+#endif
+
+#ifndef PROGRAMMER_ALLOCATION_HOOK
+    #define PROGRAMMER_ALLOCATION_HOOK 0
+#endif
+
+namespace RealtimeWatchdog
+{
+    enum class Hazard
+    {
+        allocation,
+        lock,
+        logging,
+        blockingCall
+    };
+
+    inline constexpr int numHazards = 4;
+
+#if PROGRAMMER_REALTIME_WATCHDOG
+    void enterAudioThread();
+    void exitAudioThread();
+    bool isAudioThread();
+
+    /**
+     * @brief Reports a hazard, if the calling thread is inside processBlock.
+     *
+     * @param hazard What kind of hazard.
+     * @param site Where it happened, ie. the name of the lock. Must be a string literal.
+     */
+    void report(Hazard hazard, const char* site);
+
+    uint64_t getNumReports();
+    uint64_t getNumReports(Hazard hazard);
+
+    /**
+     * @brief All call sites reported so far, with how often and a stack trace each.
+     */
+    std::string getReport();
+
+    // Routes juce::Logger::writeToLog through the watchdog. Safe to call more than once.
+    void installLogger();
+#else
+    inline void enterAudioThread() {}
+    inline void exitAudioThread() {}
+    inline bool isAudioThread() { return false; }
+    inline void report(Hazard, const char*) {}
+    inline uint64_t getNumReports() { return 0; }
+    inline uint64_t getNumReports(Hazard) { return 0; }
+    inline std::string getReport() { return {}; }
+    inline void installLogger() {}
+#endif
+
+#if PROGRAMMER_REALTIME_WATCHDOG || PROGRAMMER_ALLOCATION_HOOK
+    // Called for every allocation on any thread, ie. to count allocations in tests.
+    // RealtimeWatchdog.cpp replaces operator new, so nothing else can.
+    void setAllocationHook(void (*hook)());
+#endif
+
+    /**
+     * @class ScopedAudioThread
+     * @brief Marks the calling thread as the audio thread while in scope.
+     */
+    class ScopedAudioThread
+    {
+    public:
+        ScopedAudioThread() { enterAudioThread(); }
+        ~ScopedAudioThread() { exitAudioThread(); }
+
+        ScopedAudioThread(const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+    };
+
+    /**
+     * @class SpinLock
+     * @brief A juce::SpinLock which reports blocking locks made from the audio thread.
+     *
+     * Drop-in for juce::SpinLock. tryEnter never blocks, so it isn't reported.
+     */
+    class SpinLock
+    {
+    public:
+        explicit SpinLock(const char* lockName = "juce::SpinLock") : name(lockName) {}
+
+        void enter() const
+        {
+            report(Hazard::lock, name);
+            lock.enter();
+        }
+
+        bool tryEnter() const noexcept { return lock.tryEnter(); }
+        void exit() const noexcept { lock.exit(); }
+
+        using ScopedLockType = juce::GenericScopedLock<SpinLock>;
+        using ScopedTryLockType = juce::GenericScopedTryLock<SpinLock>;
+
+    private:
+        juce::SpinLock lock;
+        const char* name;
+    };
+}
+
+#define REALTIME_WATCHDOG_STRINGIFY_HELPER(x) #x
+#define REALTIME_WATCHDOG_STRINGIFY(x) REALTIME_WATCHDOG_STRINGIFY_HELPER(x)
+
+/**
+ * Annotates a call which may block, ie. REALTIME_WATCHDOG_BLOCKING_CALL ("MidiSenderThread::stop").
+ * Reported (with the file and line) if it's reached from processBlock.
+ */
+#define REALTIME_WATCHDOG_BLOCKING_CALL(what) \
+    RealtimeWatchdog::report(RealtimeWatchdog::Hazard::blockingCall, what " (" __FILE__ ":" REALTIME_WATCHDOG_STRINGIFY(__LINE__) ")")
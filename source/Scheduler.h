@@ -0,0 +1,179 @@
+/**
+ * @class Scheduler
+ * @brief Clock and periodic callbacks for time-driven (non-realtime) work.
+ *
+ * The editor's tick, and anything else which has to happen every so often, is
+ * scheduled through this instead of owning a juce::Timer. The processor owns the
+ * scheduler (see ProgrammerProcessor::setScheduler), so all its editors share it.
+ *
+ * - JuceScheduler runs the callbacks on the message thread from JUCE timers, against
+ *   the wall clock. It's the default.
+ * - VirtualScheduler only moves when advance() is called, and then runs every
+ *   callback which became due, in time order. Tests and benchmarks use it to run
+ *   minutes of UI (and audio, by scheduling processBlock) in milliseconds, without
+ *   sleeping, and always in the same order.
+ *
+ * NOTE: Call everything from the message thread (or the test's thread).
+ */
+
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+
+class Scheduler
+{
+public:
+    using Callback = std::function<void()>;
+
+    virtual ~Scheduler() = default;
+
+    /**
+     * @brief Calls the callback every intervalMs, starting intervalMs from now.
+     *
+     * @return int An id for cancel(), never 0.
+     */
+    virtual int callEvery (double intervalMs, Callback callback) = 0;
+
+    // Stops a callback. Unknown ids (ie. already cancelled) are ignored.
+    virtual void cancel (int id) = 0;
+
+    // The current time of this scheduler's clock, in milliseconds
+    virtual double getTimeMs() const = 0;
+};
+
+class JuceScheduler : public Scheduler
+{
+public:
+    int callEvery (double intervalMs, Callback callback) override
+    {
+        auto timer = std::make_unique<PeriodicTimer> (*this, nextId, std::move (callback));
+        timer->startTimer (juce::jmax (1, juce::roundToInt (intervalMs)));
+        timers[nextId] = std::move (timer);
+        return nextId++;
+    }
+
+    void cancel (int id) override
+    {
+        // A timer can't be deleted from its own callback, it's erased once that returns
+        if (id == runningId)
+        {
+            if (auto found = timers.find (id); found != timers.end())
+            {
+                found->second->stopTimer();
+                cancelledWhileRunning = true;
+            }
+            return;
+        }
+        timers.erase (id);
+    }
+
+    double getTimeMs() const override
+    {
+        return juce::Time::getMillisecondCounterHiRes();
+    }
+
+private:
+    struct PeriodicTimer : public juce::Timer
+    {
+        PeriodicTimer (JuceScheduler& schedulerToUse, int idToUse, Callback callbackToUse)
+            : scheduler (schedulerToUse), id (idToUse), callback (std::move (callbackToUse)) {}
+        ~PeriodicTimer() override { stopTimer(); }
+        void timerCallback() override { scheduler.run (id); }
+
+        JuceScheduler& scheduler;
+        const int id;
+        Callback callback;
+    };
+
+    void run (int id)
+    {
+        // std::map, so the timer stays put when the callback schedules another one
+        auto& timer = *timers.at (id);
+        runningId = id;
+        cancelledWhileRunning = false;
+        timer.callback();
+        runningId = 0;
+
+        if (cancelledWhileRunning)
+            timers.erase (id);
+    }
+
+    std::map<int, std::unique_ptr<PeriodicTimer>> timers;
+    int nextId = 1;
+    int runningId = 0;
+    bool cancelledWhileRunning = false;
+};
+
+class VirtualScheduler : public Scheduler
+{
+public:
+    int callEvery (double intervalMs, Callback callback) override
+    {
+        jassert (intervalMs > 0.0);
+        entries.push_back ({ nextId, intervalMs, now + intervalMs, std::move (callback) });
+        return nextId++;
+    }
+
+    void cancel (int id) override
+    {
+        // Only marked here, so a callback can cancel (itself) while advance() runs
+        for (auto& entry : entries)
+        {
+            if (entry.id == id)
+                entry.id = 0;
+        }
+    }
+
+    double getTimeMs() const override { return now; }
+
+    /**
+     * @brief Moves the clock forward, running every callback which becomes due on the
+     * way, earliest first (ties in the order they were scheduled). During a callback,
+     * getTimeMs() is its due time.
+     *
+     * Doesn't allocate, unless a callback schedules something new.
+     */
+    void advance (double milliseconds)
+    {
+        const auto end = now + milliseconds;
+        while (auto* entry = findNextDue (end))
+        {
+            now = entry->due;
+            entry->due += entry->interval;
+            entry->callback();
+        }
+        now = end;
+
+        entries.erase (std::remove_if (entries.begin(), entries.end(), [] (const Entry& e) { return e.id == 0; }), entries.end());
+    }
+
+private:
+    struct Entry
+    {
+        int id;
+        double interval;
+        double due;
+        Callback callback;
+    };
+
+    Entry* findNextDue (double end)
+    {
+        Entry* next = nullptr;
+        for (auto& entry : entries)
+        {
+            if (entry.id != 0 && entry.due <= end && (next == nullptr || entry.due < next->due))
+                next = &entry;
+        }
+        return next;
+    }
+
+    // A deque, so entries stay put when a callback schedules another one
+    std::deque<Entry> entries;
+    double now = 0.0;
+    int nextId = 1;
+};
@@ -0,0 +1,175 @@
+#include "SharedControlRing.h"
+
+#if JUCE_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+namespace
+{
+    // Reads the owner fields of an existing segment. False if it can't be read, or is
+    // too small to hold a ring (ie. a creator crashed before setting it up).
+    bool readOwner (const juce::String& name, uint32_t& ownerPid, uint32_t& ownerToken)
+    {
+        const auto fd = shm_open (name.toRawUTF8(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        auto* memory = fstat (fd, &info) == 0 && static_cast<size_t> (info.st_size) >= sizeof (ProgrammerShmRing)
+                           ? mmap (nullptr, sizeof (ProgrammerShmRing), PROT_READ, MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+        ::close (fd);
+        if (memory == MAP_FAILED)
+            return false;
+
+        const auto* ring = static_cast<const ProgrammerShmRing*> (memory);
+        ownerPid = ring->ownerPid;
+        ownerToken = ring->ownerToken;
+        munmap (memory, sizeof (ProgrammerShmRing));
+        return true;
+    }
+
+    bool isOwnedByLiveProcess (const juce::String& name)
+    {
+        uint32_t ownerPid = 0;
+        uint32_t ownerToken = 0;
+        if (! readOwner (name, ownerPid, ownerToken) || ownerPid == 0)
+            return false;
+
+        // EPERM: the process exists, but belongs to another user
+        return kill (static_cast<pid_t> (ownerPid), 0) == 0 || errno == EPERM;
+    }
+}
+#endif
+
+bool SharedControlRing::create (const juce::String& name)
+{
+    close();
+    if (! map (name, true))
+        return false;
+
+   #if JUCE_WINDOWS
+    ring->ownerPid = static_cast<uint32_t> (GetCurrentProcessId());
+   #else
+    ring->ownerPid = static_cast<uint32_t> (getpid());
+   #endif
+    ownerToken = static_cast<uint32_t> (juce::Random::getSystemRandom().nextInt());
+    ring->ownerToken = ownerToken;
+    programmer_shm_init (ring);
+    return true;
+}
+
+bool SharedControlRing::open (const juce::String& name)
+{
+    close();
+    if (! map (name, false))
+        return false;
+
+    if (! programmer_shm_is_valid (ring))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SharedControlRing::map (const juce::String& name, bool shouldCreate)
+{
+    constexpr auto size = sizeof (ProgrammerShmRing);
+
+   #if JUCE_WINDOWS
+    // Windows names can't have a leading slash, and are per session with "Local\"
+    const auto windowsName = "Local\\" + name.trimCharactersAtStart ("/");
+    auto* handle = shouldCreate
+                       ? CreateFileMappingW (INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD> (size), windowsName.toWideCharPointer())
+                       : OpenFileMappingW (FILE_MAP_ALL_ACCESS, FALSE, windowsName.toWideCharPointer());
+    if (handle == nullptr)
+        return false;
+
+    // The mapping of another instance, which must keep its ring to itself
+    if (shouldCreate && GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle (handle);
+        return false;
+    }
+
+    auto* memory = MapViewOfFile (handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (memory == nullptr)
+    {
+        CloseHandle (handle);
+        return false;
+    }
+    mappingHandle = handle;
+   #else
+    auto fd = shm_open (name.toRawUTF8(), shouldCreate ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+
+    // Replace a segment left behind by an instance which is gone, but never one of a
+    // running instance
+    if (fd < 0 && shouldCreate && errno == EEXIST && ! isOwnedByLiveProcess (name))
+    {
+        shm_unlink (name.toRawUTF8());
+        fd = shm_open (name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0)
+        return false;
+
+    if (shouldCreate && ftruncate (fd, static_cast<off_t> (size)) != 0)
+    {
+        ::close (fd);
+        shm_unlink (name.toRawUTF8());
+        return false;
+    }
+
+    auto* memory = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close (fd);
+    if (memory == MAP_FAILED)
+    {
+        if (shouldCreate)
+            shm_unlink (name.toRawUTF8());
+        return false;
+    }
+   #endif
+
+    ring = static_cast<ProgrammerShmRing*> (memory);
+    segmentName = name;
+    isCreator = shouldCreate;
+    return true;
+}
+
+void SharedControlRing::close()
+{
+    if (ring == nullptr)
+        return;
+
+   #if JUCE_WINDOWS
+    // The mapping goes away with its last handle
+    UnmapViewOfFile (ring);
+    CloseHandle (mappingHandle);
+    mappingHandle = nullptr;
+   #else
+    munmap (ring, sizeof (ProgrammerShmRing));
+
+    // Only remove the name if it still refers to our segment. If ours was taken for
+    // stale and replaced, the name belongs to the new owner now.
+    uint32_t ownerPid = 0;
+    uint32_t currentToken = 0;
+    if (isCreator && readOwner (segmentName, ownerPid, currentToken)
+        && ownerPid == static_cast<uint32_t> (getpid()) && currentToken == ownerToken)
+        shm_unlink (segmentName.toRawUTF8());
+   #endif
+
+    ring = nullptr;
+    isCreator = false;
+}
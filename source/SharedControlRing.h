@@ -0,0 +1,133 @@
+/**
+ * @class SharedControlRing
+ * @brief Owns (or attaches to) the named shared memory segment of ProgrammerShm.h.
+ *
+ * The processor creates the segment, and drains it on the audio thread with pop().
+ * A client process attaches to the same name and pushes CC changes into it (see
+ * ProgrammerShm.h for the layout and the C functions).
+ *
+ * Messages are checked on the way out: anything which isn't a CC, or has values
+ * outside the MIDI ranges, is skipped, as the other process can't be trusted to
+ * get it right. The same goes for the write index: if it's more than a ring ahead,
+ * everything in the ring is dropped and reading starts over at the write index.
+ * Valid messages are converted to MidiEvents, the ring keeps its own (wider) C
+ * layout so clients don't depend on MidiEvent.
+ *
+ * NOTE: create() and close() map and unmap memory, so never call them on the audio
+ * thread. pop() is realtime-safe.
+ */
+
+#pragma once
+
+#include "ProgrammerShm.h"
+#include "ThreadSafeMessageQueue.h"
+
+class SharedControlRing
+{
+public:
+    SharedControlRing() = default;
+    ~SharedControlRing() { close(); }
+
+    /**
+     * @brief Creates the segment and sets up an empty ring.
+     *
+     * Fails if another (running) instance owns a segment with the same name. A segment
+     * left behind by an instance which is gone is replaced.
+     *
+     * @param name The name of the segment, PROGRAMMER_SHM_NAME by default.
+     * @return bool True if the segment could be created and mapped, false otherwise.
+     */
+    bool create (const juce::String& name = PROGRAMMER_SHM_NAME);
+
+    /**
+     * @brief Attaches to a segment created by another SharedControlRing, ie. as a client.
+     *
+     * @return bool True if the segment exists and holds a compatible ring, false otherwise.
+     */
+    bool open (const juce::String& name = PROGRAMMER_SHM_NAME);
+
+    // Unmaps the segment. The creator also removes the name, unless it was replaced since.
+    void close();
+
+    bool isOpen() const { return ring != nullptr; }
+    ProgrammerShmRing* getRing() { return ring; }
+
+    // Records ready to read, valid or not. Never more than the ring holds.
+    int getNumReady() const
+    {
+        return ring != nullptr ? static_cast<int> (std::min (programmer_shm_num_ready (ring), PROGRAMMER_SHM_CAPACITY)) : 0;
+    }
+
+    /**
+     * @brief Reads the next valid message, reading no more than budget records (valid
+     * or not). Every record read is taken off budget. Realtime-safe.
+     *
+     * @return bool True if a message was read, false if the ring is empty or the budget is used up.
+     */
+    bool pop (MidiEvent& message, int& budget)
+    {
+        if (ring == nullptr)
+            return false;
+
+        resyncIfCorrupt();
+
+        ProgrammerShmMessage shmMessage;
+        while (budget > 0 && programmer_shm_pop (ring, &shmMessage))
+        {
+            --budget;
+            if (isValid (shmMessage))
+            {
+                message = MidiEvent::controller (shmMessage.value1, shmMessage.value2, shmMessage.value3);
+                return true;
+            }
+            ++numInvalid;
+        }
+        return false;
+    }
+
+    // Reads the next valid message, reading at most one ring's worth of records
+    bool pop (MidiEvent& message)
+    {
+        auto budget = static_cast<int> (PROGRAMMER_SHM_CAPACITY);
+        return pop (message, budget);
+    }
+
+    uint64_t getNumInvalid() const { return numInvalid; }
+
+    // How often the write index was more than a ring ahead
+    uint64_t getNumResyncs() const { return numResyncs; }
+
+private:
+    static bool isValid (const ProgrammerShmMessage& message)
+    {
+        return message.type == PROGRAMMER_SHM_TYPE_CC
+            && message.value1 >= 1 && message.value1 <= 16
+            && message.value2 >= 0 && message.value2 <= 127
+            && message.value3 >= 0 && message.value3 <= 127;
+    }
+
+    void resyncIfCorrupt()
+    {
+        const auto write = programmer_shm_load_acquire (&ring->writeIndex);
+        if (write - ring->readIndex <= PROGRAMMER_SHM_CAPACITY)
+            return;
+
+        programmer_shm_store_release (&ring->readIndex, write);
+        ++numResyncs;
+    }
+
+    bool map (const juce::String& name, bool shouldCreate);
+
+    ProgrammerShmRing* ring = nullptr;
+    juce::String segmentName;
+    bool isCreator = false;
+    uint32_t ownerToken = 0;
+    uint64_t numInvalid = 0;
+    uint64_t numResyncs = 0;
+
+   #if JUCE_WINDOWS
+    void* mappingHandle = nullptr;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (SharedControlRing)
+};
@@ -7,12 +7,16 @@
  * 
  * This is very useful to communicate stuff from the Editor to the Processor.
  *
+ * The queue carries MidiEvents. Sysex messages go through the queue's SysexPool,
+ * see pushSysex().
  */
 
 
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include "MidiEvent.h"
+#include "Trace.h"
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
@@ -20,37 +24,26 @@
 #include <cstring> // For memcpy
 
 
-struct GuiMessage
-{
-    enum Type
-    {
-        cc
-    };
-    Type type;
-    int value1;
-    int value2;
-    int value3;
-};
-
 class ThreadSafeMessageQueue : public juce::AbstractFifo
 {
 public:
-    ThreadSafeMessageQueue(int capacity) : AbstractFifo(capacity), buffer_(static_cast<size_t>(capacity) * sizeof(GuiMessage)) {}
+    ThreadSafeMessageQueue(int capacity) : AbstractFifo(capacity), buffer_(static_cast<size_t>(capacity) * sizeof(MidiEvent)) {}
 
-    bool push(const GuiMessage& message)
+    bool push(const MidiEvent& message)
     {
+        TRACE_SCOPE("ThreadSafeMessageQueue::push");
         //DBG("ThreadSafeMessageQueue::push: getFreeSpace() " << getFreeSpace());
         if (getFreeSpace() > 0)
         {
             // We'll always write one message at a time
             int numItems = 1;
             const auto scope = write (numItems);
-            size_t numBytesToWrite = sizeof(GuiMessage);
+            size_t numBytesToWrite = sizeof(MidiEvent);
 
             // Copy the message into the buffer
             if (scope.blockSize1 > 0)
             {
-                auto* dest = static_cast<GuiMessage*>(buffer_.getData());
+                auto* dest = static_cast<MidiEvent*>(buffer_.getData());
                 std::memcpy(&dest[scope.startIndex1], &message, numBytesToWrite);
             }
             jassert(scope.blockSize2 == 0); // We should never have a second block for a single message
@@ -60,18 +53,19 @@ public:
         return false;
     }
 
-    bool pop(GuiMessage& message)
+    bool pop(MidiEvent& message)
     {
+        TRACE_SCOPE("ThreadSafeMessageQueue::pop");
         if (getNumReady() > 0)
         {
             // We'll always read one message at a time
             int numItems = 1;
             const auto scope = read (numItems);
-            size_t numBytesToRead = sizeof(GuiMessage);
+            size_t numBytesToRead = sizeof(MidiEvent);
 
             if (scope.blockSize1 > 0)
             {
-                auto* src = static_cast<GuiMessage*>(buffer_.getData());
+                auto* src = static_cast<MidiEvent*>(buffer_.getData());
                 std::memcpy(&message, &src[scope.startIndex1], numBytesToRead);
             }
             jassert(scope.blockSize2 == 0); // We should never have a second block for a single message
@@ -80,6 +74,27 @@ public:
         return false;
     }
 
+    /**
+     * @brief Stores a sysex message in the pool and pushes a MidiEvent referring to it.
+     *
+     * @return bool False if the queue is full, no pool slot is free or the message is
+     * longer than SysexPool::maxSize.
+     */
+    bool pushSysex(const uint8_t* data, size_t numBytes, uint8_t port = 0, uint32_t sampleOffset = 0)
+    {
+        const auto slot = sysexPool_.store(data, numBytes);
+        if (slot < 0)
+            return false;
+        if (push(MidiEvent::sysex(slot, port, sampleOffset)))
+            return true;
+
+        sysexPool_.release(slot);
+        return false;
+    }
+
+    // The consumer reads sysex events from here, and releases their slot
+    SysexPool& getSysexPool() { return sysexPool_; }
+
     int getNumReady() const
     {
         return AbstractFifo::getNumReady();
@@ -87,6 +102,7 @@ public:
 
 private:
     juce::MemoryBlock buffer_;
+    SysexPool sysexPool_;
     std::mutex mutex_;
     std::condition_variable dataAvailable_;
 };
@@ -0,0 +1,279 @@
+#include "Trace.h"
+
+#if PROGRAMMER_TRACING
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace Trace
+{
+    namespace
+    {
+        constexpr size_t maxThreads = 32;
+        constexpr size_t numReserved = 4; // Only for threads named with TRACE_RESERVED_THREAD_NAME
+        constexpr uint64_t spansPerThread = 1 << 15; // A power of two
+
+        // Relaxed atomics, as toJson() may read a span while it's overwritten
+        struct Span
+        {
+            std::atomic<const char*> name { nullptr };
+            std::atomic<int64_t> start { 0 };
+            std::atomic<int64_t> end { 0 };
+        };
+
+        /* A ring, written by the thread which claimed it only. Once it's full, the oldest
+         * span is overwritten. numStarted is bumped before a span is written and
+         * numWritten after, so a reader can tell which of the spans it copied were
+         * overwritten meanwhile. */
+        struct ThreadBuffer
+        {
+            std::unique_ptr<Span[]> spans;
+            std::atomic<uint64_t> numStarted { 0 };
+            std::atomic<uint64_t> numWritten { 0 };
+            std::atomic<const char*> name { nullptr };
+            std::atomic<bool> claimed { false };
+            std::atomic<bool> used { false };
+        };
+
+        class Registry
+        {
+        public:
+            // Everything is allocated up front, so threads can start recording at
+            // any time (also the audio thread)
+            Registry() : startTime (now())
+            {
+                for (auto& buffer : buffers)
+                    buffer.spans.reset (new Span[spansPerThread]);
+            }
+
+            ~Registry()
+            {
+                // Write the trace at shutdown
+                if (getNumSpans() == 0)
+                    return;
+
+                const auto* path = std::getenv ("PROGRAMMER_TRACE_FILE");
+                const auto file = path != nullptr ? std::string (path) : (std::filesystem::temp_directory_path() / "0-Programmer-trace.json").string();
+                if (writeJson (file))
+                    std::fprintf (stderr, "Trace: %llu spans written to %s\n", static_cast<unsigned long long> (getNumSpans()), file.c_str());
+            }
+
+            /* Claims a free buffer. Reserved threads try the reserved buffers first, the
+             * others never get those. Buffers nobody used yet go first. A buffer which was
+             * used by a thread that's gone keeps its spans, and the new thread records
+             * after them (the track then shows the new thread's name). */
+            ThreadBuffer* claimBuffer (const char* name, bool reserved)
+            {
+                for (const auto reuse : { false, true })
+                {
+                    for (auto i = reserved ? size_t (0) : numReserved; i < maxThreads; ++i)
+                    {
+                        auto& buffer = buffers[i];
+                        auto expected = false;
+                        if (buffer.used.load (std::memory_order_relaxed) != reuse || buffer.claimed.load (std::memory_order_relaxed)
+                            || ! buffer.claimed.compare_exchange_strong (expected, true, std::memory_order_acquire))
+                            continue;
+
+                        if (name != nullptr)
+                            buffer.name.store (name, std::memory_order_relaxed);
+                        buffer.used.store (true, std::memory_order_release);
+                        return &buffer;
+                    }
+                }
+                return nullptr;
+            }
+
+            void releaseBuffer (ThreadBuffer& buffer) { buffer.claimed.store (false, std::memory_order_release); }
+
+            size_t getNumBuffers() const { return maxThreads; }
+            bool isUsed (size_t index) const { return buffers[index].used.load (std::memory_order_acquire); }
+            const ThreadBuffer& getBuffer (size_t index) const { return buffers[index]; }
+
+            const int64_t startTime;
+            std::atomic<uint64_t> numDropped { 0 };
+            std::atomic<uint64_t> numOverwritten { 0 };
+
+        private:
+            std::array<ThreadBuffer, maxThreads> buffers;
+        };
+
+        // At namespace scope, so it's set up before any thread records a span (and
+        // thread_local slots are released before it goes away)
+        Registry registry;
+
+        // The calling thread's buffer, claimed when it records its first span and
+        // handed back when the thread exits
+        struct ThreadSlot
+        {
+            ThreadBuffer* buffer = nullptr;
+            const char* name = nullptr;
+            bool reserved = false;
+
+            ~ThreadSlot()
+            {
+                if (buffer != nullptr)
+                    registry.releaseBuffer (*buffer);
+            }
+        };
+
+        thread_local ThreadSlot threadSlot;
+
+        ThreadBuffer* getThreadBuffer()
+        {
+            auto& slot = threadSlot;
+            if (slot.buffer == nullptr)
+                slot.buffer = registry.claimBuffer (slot.name, slot.reserved);
+            return slot.buffer;
+        }
+
+        // A span as toJson() copied it out of a ring
+        struct SpanCopy
+        {
+            const char* name;
+            int64_t start;
+            int64_t end;
+        };
+
+        void appendEscaped (std::string& json, const char* text)
+        {
+            for (; *text != 0; ++text)
+            {
+                if (*text == '"' || *text == '\\')
+                    json += '\\';
+                json += *text;
+            }
+        }
+    }
+
+    void addSpan (const char* name, int64_t start, int64_t end)
+    {
+        auto* buffer = getThreadBuffer();
+        if (buffer == nullptr)
+        {
+            ++registry.numDropped;
+            return;
+        }
+
+        const auto index = buffer->numWritten.load (std::memory_order_relaxed);
+        if (index >= spansPerThread)
+            registry.numOverwritten.fetch_add (1, std::memory_order_relaxed);
+
+        buffer->numStarted.store (index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        auto& span = buffer->spans[index & (spansPerThread - 1)];
+        span.name.store (name, std::memory_order_relaxed);
+        span.start.store (start, std::memory_order_relaxed);
+        span.end.store (end, std::memory_order_relaxed);
+        buffer->numWritten.store (index + 1, std::memory_order_release);
+    }
+
+    void setThreadName (const char* name, bool reserved)
+    {
+        auto& slot = threadSlot;
+        slot.name = name;
+        slot.reserved = reserved;
+        if (slot.buffer != nullptr)
+            slot.buffer->name.store (name, std::memory_order_relaxed);
+    }
+
+    uint64_t getNumSpans()
+    {
+        uint64_t numSpans = 0;
+        for (size_t i = 0; i < registry.getNumBuffers(); ++i)
+            numSpans += std::min (registry.getBuffer (i).numWritten.load (std::memory_order_acquire), spansPerThread);
+        return numSpans;
+    }
+
+    uint64_t getNumDropped()
+    {
+        return registry.numDropped.load();
+    }
+
+    uint64_t getNumOverwritten()
+    {
+        return registry.numOverwritten.load();
+    }
+
+    std::string toJson()
+    {
+        // Complete ("X") events in microseconds, one tid per thread buffer
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        char number[96];
+        std::vector<SpanCopy> spans;
+        spans.reserve (spansPerThread);
+
+        for (size_t i = 0; i < registry.getNumBuffers(); ++i)
+        {
+            if (! registry.isUsed (i))
+                continue;
+
+            const auto& buffer = registry.getBuffer (i);
+            const auto tid = static_cast<int> (i + 1);
+
+            json += first ? "\n" : ",\n";
+            first = false;
+            std::snprintf (number, sizeof (number), "%d", tid);
+            json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+            json += number;
+            json += ",\"args\":{\"name\":\"";
+            if (const auto* name = buffer.name.load (std::memory_order_relaxed))
+                appendEscaped (json, name);
+            else
+                json += "Thread " + std::to_string (tid);
+            json += "\"}}";
+
+            // Copy the ring oldest first, then skip what its thread overwrote meanwhile
+            const auto numWritten = buffer.numWritten.load (std::memory_order_acquire);
+            const auto oldest = numWritten > spansPerThread ? numWritten - spansPerThread : 0;
+            spans.clear();
+            for (auto j = oldest; j < numWritten; ++j)
+            {
+                const auto& span = buffer.spans[j & (spansPerThread - 1)];
+                spans.push_back ({ span.name.load (std::memory_order_relaxed),
+                                   span.start.load (std::memory_order_relaxed),
+                                   span.end.load (std::memory_order_relaxed) });
+            }
+            std::atomic_thread_fence (std::memory_order_acquire);
+            const auto numStarted = buffer.numStarted.load (std::memory_order_relaxed);
+            const auto numOverwritten = numStarted > oldest + spansPerThread ? numStarted - oldest - spansPerThread : 0;
+
+            for (auto j = std::min (static_cast<size_t> (numOverwritten), spans.size()); j < spans.size(); ++j)
+            {
+                const auto& span = spans[j];
+                json += ",\n{\"name\":\"";
+                appendEscaped (json, span.name);
+                std::snprintf (number, sizeof (number), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                    static_cast<double> (span.start - registry.startTime) / 1000.0,
+                    static_cast<double> (span.end - span.start) / 1000.0,
+                    tid);
+                json += number;
+            }
+        }
+
+        // Spans the trace is missing, see getNumDropped() and getNumOverwritten()
+        json += "\n],\"otherData\":{\"droppedSpans\":" + std::to_string (getNumDropped())
+              + ",\"overwrittenSpans\":" + std::to_string (getNumOverwritten()) + "}}\n";
+        return json;
+    }
+
+    bool writeJson (const std::string& path)
+    {
+        auto* file = std::fopen (path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        const auto json = toJson();
+        const auto written = std::fwrite (json.data(), 1, json.size(), file) == json.size();
+        return std::fclose (file) == 0 && written;
+    }
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file Trace.h
+ * @brief Opt-in trace spans for the hot paths, written as Chrome trace JSON.
+ *
+ * Build with -DPROGRAMMER_TRACING=ON to enable it. Code marks a span with
+ * TRACE_SCOPE ("Name"), which records the time between the macro and the end of the
+ * scope. Spans are kept per thread, so the editor timer, paint, the queue, processBlock
+ * and the MIDI sender can be followed side by side.
+ *
+ * The trace is written when the app exits (to $PROGRAMMER_TRACE_FILE, or
+ * 0-Programmer-trace.json in the temp directory), or on demand with writeJson(). Open
+ * it in https://ui.perfetto.dev or chrome://tracing.
+ *
+ * Recording a span is lock-free and doesn't allocate, so it's safe on the audio
+ * thread: every thread gets a preallocated buffer the first time it records a span,
+ * and hands it back when it exits (the spans stay, the next thread records after them).
+ * A few buffers are reserved for the threads which matter most (audio, message and
+ * MIDI sender, see TRACE_RESERVED_THREAD_NAME), so a big pool of workers can't take
+ * them all. A buffer is a ring of the last 32768 spans, so a long run keeps its most
+ * recent spans and the oldest are overwritten (getNumOverwritten() counts them).
+ * Running out of buffers drops spans, which getNumDropped() counts. Both counts are
+ * written to the JSON's otherData.
+ *
+ * NOTE: Span names must be string literals, only the pointer is kept. Without the
+ * build flag, TRACE_SCOPE and the TRACE_..._THREAD_NAME macros compile to nothing.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifndef PROGRAMMER_TRACING
+    #define PROGRAMMER_TRACING 0
+#endif
+
+namespace Trace
+{
+#if PROGRAMMER_TRACING
+    inline int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Records a span on the calling thread.
+     *
+     * @param name The name of the span. Must be a string literal.
+     * @param start Start time, from now().
+     * @param end End time, from now().
+     */
+    void addSpan(const char* name, int64_t start, int64_t end);
+
+    /**
+     * @brief Names the calling thread in the trace. Doesn't claim a buffer yet.
+     *
+     * @param name The name of the thread. Must be a string literal.
+     * @param reserved True to record into one of the reserved buffers.
+     */
+    void setThreadName(const char* name, bool reserved = false);
+
+    // The spans kept, in all buffers
+    uint64_t getNumSpans();
+    uint64_t getNumDropped();
+    uint64_t getNumOverwritten();
+
+    /**
+     * @brief The spans recorded so far, as Chrome trace JSON. Spans which are still
+     * being recorded by other threads may be missing.
+     */
+    std::string toJson();
+    bool writeJson(const std::string& path);
+
+    /**
+     * @class ScopedSpan
+     * @brief Records a span from construction to destruction. Use TRACE_SCOPE.
+     */
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(const char* spanName) : name(spanName), start(now()) {}
+        ~ScopedSpan() { addSpan(name, start, now()); }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+#else
+    inline uint64_t getNumSpans() { return 0; }
+    inline uint64_t getNumDropped() { return 0; }
+    inline uint64_t getNumOverwritten() { return 0; }
+    inline std::string toJson() { return {}; }
+    inline bool writeJson(const std::string&) { return false; }
+#endif
+}
+
+#if PROGRAMMER_TRACING
+    #define TRACE_JOIN_HELPER(a, b) a##b
+    #define TRACE_JOIN(a, b) TRACE_JOIN_HELPER(a, b)
+
+    // Records a span from here to the end of the scope, ie. TRACE_SCOPE ("processBlock")
+    #define TRACE_SCOPE(name) const Trace::ScopedSpan TRACE_JOIN(traceSpan, __LINE__)(name)
+    #define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+
+    // For the audio, message and MIDI sender threads, which get a reserved buffer
+    #define TRACE_RESERVED_THREAD_NAME(name) Trace::setThreadName(name, true)
+#else
+    #define TRACE_SCOPE(name)
+    #define TRACE_THREAD_NAME(name)
+    #define TRACE_RESERVED_THREAD_NAME(name)
+#endif
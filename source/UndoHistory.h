@@ -0,0 +1,208 @@
+/**
+ * @class UndoHistory
+ * @brief An undo/redo history of program states, stored as deltas in a preallocated ring.
+ *
+ * A step only records the parameters it changed: one 3 byte Change (parameter index,
+ * value before, value after) per parameter. Most steps move a single widget, so the
+ * default ring of 2048 changes holds the default depth of 1000 steps in 6kB, with
+ * room to spare for steps which change the whole program (ie. loading a preset),
+ * which take numParameters changes.
+ * All memory is allocated in the constructor; recording, undoing and redoing a step
+ * only walks its changes, never a heap allocation.
+ *
+ * When the history is at its maximum depth, or the ring is full, the oldest steps
+ * are dropped until the new step fits.
+ * Recording a new step after undoing discards the steps that could have been redone
+ * (like any text editor).
+ *
+ * NOTE: Not thread-safe. The history is meant to be used from the message thread.
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <cassert>
+#include <vector>
+
+class UndoHistory
+{
+public:
+    /**
+     * @param capacity Size of the ring, in changes.
+     * @param maxSteps The most steps kept, ie. how many times in a row undo works.
+     */
+    explicit UndoHistory(size_t capacity = 2048, size_t maxSteps = 1000) : ring_(capacity), maxSteps_(maxSteps)
+    {
+        assert(capacity >= 1 && maxSteps >= 1);
+        reset(ProgramState::defaults());
+    }
+
+    /**
+     * @brief Clears the history, leaving only the given state.
+     *
+     * @param initialState The state to start from. This state can never be undone.
+     */
+    void reset(const ProgramState& initialState)
+    {
+        first_ = 0;
+        count_ = 0;
+        cursor_ = 0;
+        numSteps_ = 0;
+        numUndoable_ = 0;
+        current_ = initialState;
+    }
+
+    /**
+     * @brief Records a new step. Any steps which could have been redone are discarded.
+     * A state equal to the current one records nothing.
+     *
+     * @param state The new current state.
+     */
+    void push(const ProgramState& state)
+    {
+        size_t numChanges = 0;
+        for (size_t i = 0; i < numParameters; ++i)
+            numChanges += state[i] != current_[i] ? 1 : 0;
+
+        if (numChanges == 0)
+            return;
+
+        // A step that doesn't fit even in an empty ring can't be undone
+        if (numChanges > ring_.size())
+        {
+            reset(state);
+            return;
+        }
+
+        // Drop the redo tail, then the oldest steps until the new one fits
+        count_ = cursor_;
+        numSteps_ = numUndoable_;
+        while (numSteps_ >= maxSteps_ || ring_.size() - count_ < numChanges)
+            dropOldestStep();
+
+        auto firstOfStep = true;
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (state[i] == current_[i])
+                continue;
+
+            ring_[slot(count_++)] = { static_cast<uint8_t>(i | (firstOfStep ? stepStart : 0)), current_[i], state[i] };
+            firstOfStep = false;
+        }
+
+        cursor_ = count_;
+        ++numSteps_;
+        numUndoable_ = numSteps_;
+        current_ = state;
+    }
+
+    /**
+     * @brief Steps back in the history.
+     *
+     * @param state Receives the state to go back to.
+     * @return bool True if there was a step to undo, false otherwise.
+     */
+    bool undo(ProgramState& state)
+    {
+        if (! canUndo())
+            return false;
+
+        for (;;)
+        {
+            const auto& change = ring_[slot(--cursor_)];
+            current_[change.getIndex()] = change.before;
+            if (change.isStepStart())
+                break;
+        }
+
+        --numUndoable_;
+        state = current_;
+        return true;
+    }
+
+    /**
+     * @brief Steps forward in the history, after an undo.
+     *
+     * @param state Receives the state to go forward to.
+     * @return bool True if there was a step to redo, false otherwise.
+     */
+    bool redo(ProgramState& state)
+    {
+        if (! canRedo())
+            return false;
+
+        do
+        {
+            const auto& change = ring_[slot(cursor_++)];
+            current_[change.getIndex()] = change.after;
+        } while (cursor_ < count_ && ! ring_[slot(cursor_)].isStepStart());
+
+        ++numUndoable_;
+        state = current_;
+        return true;
+    }
+
+    bool canUndo() const { return cursor_ > 0; }
+    bool canRedo() const { return cursor_ < count_; }
+
+    /**
+     * @brief Retrieves the state at the current position in the history.
+     */
+    ProgramState getCurrent() const { return current_; }
+
+    /**
+     * @brief Number of states held, including the oldest one (which can't be undone)
+     * and the ones that can be redone.
+     */
+    size_t getNumSteps() const { return numSteps_ + 1; }
+
+    /**
+     * @brief Size of the ring, in changes (not steps).
+     */
+    size_t getCapacity() const { return ring_.size(); }
+
+    /**
+     * @brief The most steps kept, not counting the oldest state (which can't be undone).
+     */
+    size_t getMaxSteps() const { return maxSteps_; }
+
+private:
+    static constexpr uint8_t stepStart = 0x80;
+    static_assert(numParameters <= stepStart, "Parameter index must fit in 7 bits");
+
+    struct Change
+    {
+        uint8_t indexAndFlags; // Parameter index, stepStart on the first change of a step
+        uint8_t before;
+        uint8_t after;
+
+        size_t getIndex() const { return indexAndFlags & (stepStart - 1); }
+        bool isStepStart() const { return (indexAndFlags & stepStart) != 0; }
+    };
+    static_assert(sizeof(Change) == 3);
+
+    size_t slot(size_t position) const { return (first_ + position) % ring_.size(); }
+
+    // Only called with the redo tail already dropped, so all changes are undoable
+    void dropOldestStep()
+    {
+        do
+        {
+            first_ = (first_ + 1) % ring_.size();
+            --count_;
+            --cursor_;
+        } while (count_ > 0 && ! ring_[first_].isStepStart());
+
+        --numSteps_;
+        --numUndoable_;
+    }
+
+    std::vector<Change> ring_;
+    size_t first_ = 0;  // Ring index of the oldest change
+    size_t count_ = 0;  // Number of changes held
+    size_t cursor_ = 0; // Number of changes applied to reach current_, from first_
+    const size_t maxSteps_;
+    size_t numSteps_ = 0;    // Number of steps held, undoable and redoable
+    size_t numUndoable_ = 0; // Number of steps before the cursor
+    ProgramState current_;
+};
@@ -0,0 +1,266 @@
+/**
+ * @class ZeroCoastSimulator
+ * @brief A software stand-in for a 0-Coast on the other end of a DIN MIDI cable.
+ *
+ * Feed it the processor's MIDI output, block by block, and it works out what a real
+ * 0-Coast would end up doing with it:
+ * - The interface sends bytes one after the other at 31.25 kbaud, 10 bits per byte,
+ *   so every byte takes 320µs on the wire. Messages which are due while the line is
+ *   busy wait in the interface. Running status is used like most interfaces do: a
+ *   channel message with the same status as the one before goes out without it.
+ * - The device receives bytes into a buffer of limited size. The firmware takes
+ *   messages out of it, and can be given a processing time per message. When it
+ *   can't keep up, the buffer fills and further bytes are lost, as on the hardware.
+ * - Program page CCs on the device's channel set the parameter values (clamped to
+ *   the parameter range), which getState() returns. Everything else is counted and
+ *   otherwise ignored.
+ *
+ * Time is simulated, so minutes of traffic run in microseconds. Tests use it to check
+ * the device ends up in the intended state, benchmarks to measure wire time of bursts
+ * and syncs.
+ *
+ * NOTE: Not thread-safe, and not meant for the audio thread (the interface queue grows).
+ */
+
+#pragma once
+
+#include "ProgramState.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+class ZeroCoastSimulator
+{
+public:
+    static constexpr double baudRate = 31250.0;
+    static constexpr double byteTimeMs = 10.0 * 1000.0 / baudRate; // Start bit, 8 data bits, stop bit
+
+    struct Config
+    {
+        int channel = MIDI_CHANNEL;
+        size_t receiveBufferSize = 128; // Bytes
+        double processingTimeMs = 0.0;  // Per complete message, 0 keeps up with the wire
+        bool useRunningStatus = true;
+    };
+
+    ZeroCoastSimulator() : ZeroCoastSimulator (Config {}) {}
+    explicit ZeroCoastSimulator (const Config& configToUse) : config (configToUse) {}
+
+    /**
+     * @brief Sends one block of processor output, and runs the simulation to the end
+     * of the block. Events go on the wire at their sample position.
+     */
+    void processBlock (const juce::MidiBuffer& midiMessages, int numSamples, double sampleRate)
+    {
+        const auto blockStartMs = nowMs;
+        for (const auto metadata : midiMessages)
+            send (metadata.data, metadata.numBytes, blockStartMs + metadata.samplePosition * 1000.0 / sampleRate);
+
+        advanceTo (blockStartMs + numSamples * 1000.0 / sampleRate);
+    }
+
+    /**
+     * @brief Queues one MIDI message in the interface, to go on the wire at timeMs
+     * (or as soon as the line is free).
+     */
+    void send (const uint8_t* data, int numBytes, double timeMs)
+    {
+        if (numBytes <= 0)
+            return;
+
+        const auto status = data[0];
+        auto first = 0;
+        if (status < 0xF0)
+        {
+            if (config.useRunningStatus && status == sendRunningStatus)
+                first = 1;
+            sendRunningStatus = status;
+        }
+        else if (status < 0xF8)
+        {
+            // System common and sysex cancel running status, realtime doesn't
+            sendRunningStatus = 0;
+        }
+
+        for (auto i = first; i < numBytes; ++i)
+            interfaceQueue.push_back ({ data[i], std::max (timeMs, nowMs) });
+    }
+
+    /**
+     * @brief Runs the wire and the device up to timeMs.
+     */
+    void advanceTo (double timeMs)
+    {
+        constexpr auto never = std::numeric_limits<double>::infinity();
+        for (;;)
+        {
+            const auto nextArrival = interfaceQueue.empty() ? never : std::max (interfaceQueue.front().timeMs, lineFreeMs) + byteTimeMs;
+            const auto nextProcessing = receiveBuffer.empty() ? never : std::max (deviceBusyMs, nowMs);
+            if (std::min (nextArrival, nextProcessing) > timeMs)
+                break;
+
+            if (nextProcessing <= nextArrival)
+            {
+                nowMs = nextProcessing;
+                const auto byte = receiveBuffer.front();
+                receiveBuffer.pop_front();
+                if (parse (byte))
+                    deviceBusyMs = nowMs + config.processingTimeMs;
+            }
+            else
+            {
+                nowMs = nextArrival;
+                lineFreeMs = nowMs;
+                lastByteMs = nowMs;
+                const auto byte = interfaceQueue.front().byte;
+                interfaceQueue.pop_front();
+                ++numBytesReceived;
+
+                if (receiveBuffer.size() < config.receiveBufferSize)
+                {
+                    receiveBuffer.push_back (byte);
+                    receiveBufferPeak = std::max (receiveBufferPeak, receiveBuffer.size());
+                }
+                else
+                    ++numBytesLost;
+            }
+        }
+        nowMs = std::max (nowMs, timeMs);
+    }
+
+    // Runs until everything sent was received and handled. Returns the time then.
+    double flush()
+    {
+        while (! isIdle())
+        {
+            const auto nextArrival = interfaceQueue.empty() ? nowMs : std::max (interfaceQueue.front().timeMs, lineFreeMs) + byteTimeMs;
+            advanceTo (std::max ({ nextArrival, deviceBusyMs, nowMs }));
+        }
+        return nowMs;
+    }
+
+    bool isIdle() const { return interfaceQueue.empty() && receiveBuffer.empty(); }
+
+    const ProgramState& getState() const { return state; }
+    double getTimeMs() const { return nowMs; }
+
+    // When the last byte arrived at the device, ie. to measure how long a burst took
+    double getLastByteTimeMs() const { return lastByteMs; }
+
+    // Counters
+    uint64_t getNumBytesReceived() const { return numBytesReceived; } // Bytes which came over the wire
+    uint64_t getNumBytesLost() const { return numBytesLost; }         // Bytes which didn't fit in the receive buffer
+    uint64_t getNumMessages() const { return numMessages; }           // Complete messages handled by the device
+    uint64_t getNumCcsApplied() const { return numCcsApplied; }       // Program page CCs which set a parameter
+    uint64_t getNumIgnored() const { return numIgnored; }             // Complete messages the device ignored
+    size_t getReceiveBufferPeak() const { return receiveBufferPeak; }
+
+private:
+    struct QueuedByte
+    {
+        uint8_t byte;
+        double timeMs;
+    };
+
+    // Feeds one byte to the device's MIDI parser. Returns true when a message completed.
+    bool parse (uint8_t byte)
+    {
+        if (byte >= 0xF8)
+            return handle (byte, 0, 0); // Realtime, can come between any two bytes
+
+        if (byte == 0xF7 && inSysex)
+        {
+            inSysex = false;
+            currentStatus = 0;
+            return handle (0xF0, 0, 0);
+        }
+
+        if (byte >= 0x80)
+        {
+            inSysex = byte == 0xF0;
+            receiveRunningStatus = byte < 0xF0 ? byte : 0;
+            currentStatus = byte;
+            numData = 0;
+            if (byte >= 0xF0 && dataBytesFor (byte) == 0 && ! inSysex)
+            {
+                currentStatus = 0;
+                return handle (byte, 0, 0);
+            }
+            return false;
+        }
+
+        if (inSysex)
+            return false;
+
+        if (numData == 0 && currentStatus == 0)
+        {
+            // A data byte without a status byte. Running status, or garbage after lost bytes.
+            if (receiveRunningStatus == 0)
+                return false;
+            currentStatus = receiveRunningStatus;
+        }
+
+        dataBytes[numData++] = byte;
+        if (numData < dataBytesFor (currentStatus))
+            return false;
+
+        const auto complete = currentStatus;
+        numData = 0;
+        currentStatus = 0;
+        return handle (complete, dataBytes[0], dataBytes[1]);
+    }
+
+    bool handle (uint8_t messageStatus, uint8_t data1, uint8_t data2)
+    {
+        ++numMessages;
+        if ((messageStatus & 0xF0) == 0xB0 && (messageStatus & 0x0F) + 1 == config.channel)
+        {
+            const auto index = findParameterIndexByCc (data1);
+            if (index >= 0)
+            {
+                const auto& definition = parameterDefinitions[static_cast<size_t> (index)];
+                state[static_cast<size_t> (index)] = static_cast<uint8_t> (std::clamp (static_cast<int> (data2), definition.minValue, definition.maxValue));
+                ++numCcsApplied;
+                return true;
+            }
+        }
+        ++numIgnored;
+        return true;
+    }
+
+    static int dataBytesFor (uint8_t messageStatus)
+    {
+        if (messageStatus < 0xF0)
+            return (messageStatus & 0xE0) == 0xC0 ? 1 : 2;
+        if (messageStatus == 0xF1 || messageStatus == 0xF3)
+            return 1;
+        return messageStatus == 0xF2 ? 2 : 0;
+    }
+
+    const Config config;
+    ProgramState state = ProgramState::defaults();
+    double nowMs = 0.0;
+
+    // Interface side
+    std::deque<QueuedByte> interfaceQueue;
+    uint8_t sendRunningStatus = 0;
+    double lineFreeMs = 0.0;
+    double lastByteMs = 0.0;
+
+    // Device side
+    std::deque<uint8_t> receiveBuffer;
+    double deviceBusyMs = 0.0;
+    uint8_t receiveRunningStatus = 0;
+    uint8_t currentStatus = 0;
+    uint8_t dataBytes[2] {};
+    int numData = 0;
+    bool inSysex = false;
+
+    uint64_t numBytesReceived = 0;
+    uint64_t numBytesLost = 0;
+    uint64_t numMessages = 0;
+    uint64_t numCcsApplied = 0;
+    uint64_t numIgnored = 0;
+    size_t receiveBufferPeak = 0;
+};
@@ -0,0 +1,141 @@
+#include <PluginProcessor.h>
+#include <PluginEditor.h>
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+
+/* Counts the heap allocations made by the current thread while in scope.
+ *
+ * The test build replaces the global operator new/delete in RealtimeWatchdog.cpp
+ * (PROGRAMMER_ALLOCATION_HOOK), and the counter is hooked into those. Allocations
+ * count into the innermost counter of the calling thread. Allocations made by other
+ * threads, or outside any counter, are not counted.
+ */
+class ScopedAllocationCounter
+{
+public:
+    ScopedAllocationCounter() : previous (current) { current = this; }
+    ~ScopedAllocationCounter() { current = previous; }
+
+    int getNumAllocations() const { return numAllocations; }
+
+    static void countAllocation()
+    {
+        if (current != nullptr)
+            ++current->numAllocations;
+    }
+
+private:
+    static thread_local ScopedAllocationCounter* current;
+    ScopedAllocationCounter* previous;
+    int numAllocations = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedAllocationCounter)
+};
+
+thread_local ScopedAllocationCounter* ScopedAllocationCounter::current = nullptr;
+
+[[maybe_unused]] static const bool allocationHookInstalled = [] {
+    RealtimeWatchdog::setAllocationHook (&ScopedAllocationCounter::countAllocation);
+    return true;
+}();
+
+TEST_CASE("Allocation counter functionality", "[Allocations]")
+{
+    SECTION("Counts allocations in scope only")
+    {
+        auto* before = new int (1);
+        int numAllocations = 0;
+        {
+            ScopedAllocationCounter counter;
+            auto* inside = new int (2);
+            delete inside;
+            std::vector<int> vector (16);
+            numAllocations = counter.getNumAllocations();
+        }
+        delete before;
+        REQUIRE(numAllocations == 2);
+    }
+
+    SECTION("Nested counters count into the innermost one")
+    {
+        int numInner = 0;
+        int numOuter = 0;
+        {
+            ScopedAllocationCounter outer;
+            {
+                ScopedAllocationCounter inner;
+                delete new int (3);
+                numInner = inner.getNumAllocations();
+            }
+            numOuter = outer.getNumAllocations();
+        }
+        REQUIRE(numInner == 1);
+        REQUIRE(numOuter == 0);
+    }
+}
+
+TEST_CASE("Steady state editor ticks and blocks don't allocate", "[Allocations]")
+{
+    ProgrammerProcessor processor;
+    auto& scheduler = useVirtualTime (processor);
+    ProgrammerEditor editor (processor);
+    juce::AudioBuffer<float> buffer (2, 512);
+    juce::MidiBuffer midiBuffer;
+    processor.setRateAndBufferSizeDetails (48000, 512);
+    processor.prepareToPlay (48000, 512);
+
+    // Hosts hand us a MIDI buffer with room to spare, so do the same here
+    midiBuffer.ensureSize (4096);
+
+    // Warm up: one tick and one block
+    scheduler.advance (ProgrammerEditor::tickIntervalMs);
+    processor.processBlock (buffer, midiBuffer);
+    midiBuffer.clear();
+
+    SECTION("Editor tick without changes")
+    {
+        ScopedAllocationCounter counter;
+        scheduler.advance (100 * ProgrammerEditor::tickIntervalMs);
+        REQUIRE(counter.getNumAllocations() == 0);
+    }
+
+    SECTION("Editor tick which sends a CC")
+    {
+        editor.testEnableArp();
+
+        ScopedAllocationCounter counter;
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        REQUIRE(counter.getNumAllocations() == 0);
+        REQUIRE(processor.messageQueue->getNumReady() == 1);
+    }
+
+    SECTION("processBlock with queued CCs")
+    {
+        for (int i = 0; i < 18; ++i)
+            processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, PORTAMENTO_CC, i));
+
+        ScopedAllocationCounter counter;
+        for (int i = 0; i < 100; ++i)
+        {
+            processor.processBlock (buffer, midiBuffer);
+            midiBuffer.clear();
+        }
+        REQUIRE(counter.getNumAllocations() == 0);
+    }
+
+    SECTION("processBlock while morphing")
+    {
+        auto to = ProgramState::defaults();
+        to[parameterIndex (PORTAMENTO_NAME)] = 127;
+        processor.startMorph (ProgramState::defaults(), to, 1.0);
+
+        ScopedAllocationCounter counter;
+        for (int i = 0; i < 1000 && processor.isMorphing(); ++i)
+        {
+            processor.processBlock (buffer, midiBuffer);
+            midiBuffer.clear();
+        }
+        REQUIRE(counter.getNumAllocations() == 0);
+        REQUIRE_FALSE(processor.isMorphing());
+    }
+}
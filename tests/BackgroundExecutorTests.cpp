@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/BackgroundExecutor.h"
+
+TEST_CASE("BackgroundExecutor functionality", "[BackgroundExecutor]")
+{
+    SECTION("Jobs run on the workers")
+    {
+        BackgroundExecutor executor (2);
+        REQUIRE(executor.getNumThreads() == 2);
+
+        std::atomic<int> numRun { 0 };
+        juce::WaitableEvent allDone;
+        for (int i = 0; i < 100; ++i)
+        {
+            executor.submit ([&] {
+                if (++numRun == 100)
+                    allDone.signal();
+            });
+        }
+        REQUIRE(allDone.wait (5000));
+        REQUIRE(numRun == 100);
+    }
+
+    SECTION("Cancelled jobs are skipped")
+    {
+        BackgroundExecutor executor (1);
+
+        // Keep the only worker busy, so the next job is still queued when cancelled
+        juce::WaitableEvent release;
+        juce::WaitableEvent done;
+        executor.submit ([&] { release.wait (5000); });
+
+        BackgroundExecutor::CancellationToken token;
+        bool ran = false;
+        executor.submit ([&] { ran = true; }, BackgroundExecutor::Priority::normal, token);
+        executor.submit ([&] { done.signal(); });
+        token.cancel();
+        REQUIRE(token.isCancelled());
+
+        release.signal();
+        REQUIRE(done.wait (5000));
+        REQUIRE_FALSE(ran);
+    }
+
+    SECTION("Higher priorities go first")
+    {
+        BackgroundExecutor executor (1);
+
+        juce::WaitableEvent started;
+        juce::WaitableEvent release;
+        juce::WaitableEvent done;
+        executor.submit ([&] {
+            started.signal();
+            release.wait (5000);
+        });
+        REQUIRE(started.wait (5000));
+
+        // Only touched by the one worker
+        std::vector<BackgroundExecutor::Priority> order;
+        for (auto priority : { BackgroundExecutor::Priority::low, BackgroundExecutor::Priority::normal, BackgroundExecutor::Priority::high })
+            executor.submit ([&order, priority] { order.push_back (priority); }, priority);
+        executor.submit ([&] { done.signal(); }, BackgroundExecutor::Priority::low);
+        REQUIRE(executor.getNumQueued() == 4);
+
+        release.signal();
+        REQUIRE(done.wait (5000));
+        REQUIRE(order.size() == 3);
+        REQUIRE(order[0] == BackgroundExecutor::Priority::high);
+        REQUIRE(order[1] == BackgroundExecutor::Priority::normal);
+        REQUIRE(order[2] == BackgroundExecutor::Priority::low);
+    }
+
+    SECTION("Idle workers steal queued jobs")
+    {
+        BackgroundExecutor executor (2);
+
+        // Jobs submitted from a job go to the same worker. That worker waits for
+        // them, so they only run if the other worker steals them.
+        juce::WaitableEvent done;
+        executor.submit ([&] {
+            std::atomic<int> numStolen { 0 };
+            juce::WaitableEvent stolen;
+            for (int i = 0; i < 2; ++i)
+            {
+                executor.submit ([&] {
+                    if (++numStolen == 2)
+                        stolen.signal();
+                });
+            }
+            if (stolen.wait (5000))
+                done.signal();
+        });
+        REQUIRE(done.wait (5000));
+    }
+
+    SECTION("parallelFor runs every chunk once")
+    {
+        BackgroundExecutor executor (4);
+        std::vector<std::atomic<int>> counts (1000);
+        executor.parallelFor (counts.size(), [&] (size_t chunk) { ++counts[chunk]; });
+
+        bool allOnce = true;
+        for (auto& count : counts)
+            allOnce = allOnce && count == 1;
+        REQUIRE(allOnce);
+
+        // Nothing to do
+        executor.parallelFor (0, [] (size_t) {});
+    }
+
+    SECTION("parallelFor from a job")
+    {
+        BackgroundExecutor executor (2);
+        std::atomic<int> sum { 0 };
+        juce::WaitableEvent done;
+        executor.submit ([&] {
+            executor.parallelFor (100, [&] (size_t chunk) { sum += static_cast<int> (chunk); });
+            done.signal();
+        });
+        REQUIRE(done.wait (5000));
+        REQUIRE(sum == 4950);
+    }
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/CcDecimator.h"
+
+TEST_CASE("CcDecimator functionality", "[CcDecimator]")
+{
+    CcDecimator decimator;
+    const auto portamento = static_cast<size_t> (findParameterIndexByName (PORTAMENTO_NAME));
+
+    SECTION("Default values are not sent")
+    {
+        // The decimator assumes the device starts with the default values
+        REQUIRE_FALSE(decimator.update(portamento, PORTAMENTO_VALUE));
+        REQUIRE(decimator.getLastSent(portamento) == PORTAMENTO_VALUE);
+    }
+
+    SECTION("Changed values are sent once")
+    {
+        REQUIRE(decimator.update(portamento, 64.0f));
+        REQUIRE(decimator.getLastSent(portamento) == 64);
+
+        // Same value again should not be sent
+        REQUIRE_FALSE(decimator.update(portamento, 64.0f));
+    }
+
+    SECTION("Changes within the same 7-bit step are not sent")
+    {
+        REQUIRE(decimator.update(portamento, 10.0f));
+        REQUIRE_FALSE(decimator.update(portamento, 10.2f));
+        REQUIRE_FALSE(decimator.update(portamento, 9.8f));
+        REQUIRE(decimator.update(portamento, 10.6f));
+        REQUIRE(decimator.getLastSent(portamento) == 11);
+    }
+
+    SECTION("Values are clamped to 7 bits")
+    {
+        REQUIRE(decimator.update(portamento, 500.0f));
+        REQUIRE(decimator.getLastSent(portamento) == 127);
+        REQUIRE(decimator.update(portamento, -3.0f));
+        REQUIRE(decimator.getLastSent(portamento) == 0);
+    }
+
+    SECTION("Values sent through other paths are respected")
+    {
+        // Something else (ie. the editor) sent 100
+        decimator.noteSent(portamento, 100);
+
+        // A still-standing automation value must not override it
+        REQUIRE_FALSE(decimator.update(portamento, PORTAMENTO_VALUE));
+
+        // Automation moving to the value the device already has is not sent either
+        REQUIRE_FALSE(decimator.update(portamento, 100.0f));
+
+        // But a new automation value is
+        REQUIRE(decimator.update(portamento, 20.0f));
+        REQUIRE(decimator.getLastSent(portamento) == 20);
+    }
+
+    SECTION("Reset returns to default values")
+    {
+        REQUIRE(decimator.update(portamento, 64.0f));
+        decimator.reset();
+        REQUIRE(decimator.getLastSent(portamento) == PORTAMENTO_VALUE);
+    }
+}
@@ -0,0 +1,155 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+struct JournalEvent
+{
+    int64_t samplePosition;
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+// Runs blocks and collects the events, with absolute sample positions
+static std::vector<JournalEvent> runBlocks (ProgrammerProcessor& processor, int numBlocks, int blockSize, const std::function<void (int)>& beforeBlock = {})
+{
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midiBuffer;
+    std::vector<JournalEvent> events;
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        if (beforeBlock)
+            beforeBlock (block);
+        processor.processBlock (buffer, midiBuffer);
+        for (const auto metadata : midiBuffer)
+        {
+            events.push_back ({ int64_t (block) * blockSize + metadata.samplePosition,
+                metadata.data[0],
+                metadata.data[1],
+                metadata.data[2] });
+        }
+        midiBuffer.clear();
+    }
+    return events;
+}
+
+TEST_CASE("CcJournal functionality", "[CcJournal]")
+{
+    auto file = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("CcJournalTests.ccj");
+
+    SECTION("Records are written and read back")
+    {
+        CcJournalWriter writer;
+        REQUIRE(writer.start (file, 44100.0));
+        REQUIRE(writer.isRecording());
+
+        // More records than the ring holds, and than the first chunk of the file
+        // holds, written in bursts the writer thread can keep up with
+        const auto numRecords = static_cast<int> (CcJournalWriter::recordsPerChunk) + 1000;
+        const auto ticks = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numRecords; ++i)
+        {
+            const uint8_t bytes[] = { 0xB0, static_cast<uint8_t> (i % 128), static_cast<uint8_t> ((i / 128) % 128) };
+            writer.record (ticks, i, bytes);
+            if (i % 1000 == 999)
+                juce::Thread::sleep (20);
+        }
+        writer.stop();
+        REQUIRE(! writer.isRecording());
+        REQUIRE(writer.getNumDropped() == 0);
+
+        CcJournalReader reader;
+        REQUIRE(reader.open (file));
+        REQUIRE(reader.size() == static_cast<size_t> (numRecords));
+        REQUIRE(reader.getSampleRate() == 44100.0);
+        for (size_t i = 0; i < reader.size(); ++i)
+        {
+            const auto& record = reader[i];
+            REQUIRE(record.samplePosition == static_cast<int64_t> (i));
+            REQUIRE(record.status == 0xB0);
+            REQUIRE(record.data1 == i % 128);
+            REQUIRE(record.data2 == (i / 128) % 128);
+        }
+
+        // Trimmed to the records written
+        REQUIRE(file.getSize() == static_cast<int64_t> (sizeof (CcJournalHeader) + reader.size() * sizeof (CcJournalRecord)));
+    }
+
+    SECTION("Invalid files are rejected")
+    {
+        REQUIRE(file.replaceWithText ("Not a journal, but long enough to hold a header"));
+        CcJournalReader reader;
+        REQUIRE(! reader.open (file));
+        REQUIRE(! reader.open (file.getSiblingFile ("DoesNotExist.ccj")));
+    }
+
+    SECTION("Replay reproduces the recorded stream")
+    {
+        constexpr int blockSize = 256;
+        std::vector<JournalEvent> recorded;
+        {
+            ProgrammerProcessor processor;
+            processor.setRateAndBufferSizeDetails (48000, blockSize);
+            processor.prepareToPlay (48000, blockSize);
+            auto* portamento = processor.parameters.getParameter (PORTAMENTO_NAME);
+
+            REQUIRE(processor.ccJournal.start (file, 48000));
+            recorded = runBlocks (processor, 100, blockSize, [&] (int block) {
+                if (block % 7 == 3)
+                    portamento->setValueNotifyingHost (portamento->convertTo0to1 (static_cast<float> (block)));
+                if (block % 11 == 5)
+                    processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, ENABLE_ARP_CC, (block / 11) % 2));
+            });
+            processor.ccJournal.stop();
+        }
+        REQUIRE(recorded.size() > 10);
+
+        // Replay as fast as possible into a fresh processor, which starts later
+        ProgrammerProcessor processor;
+        processor.setRateAndBufferSizeDetails (48000, blockSize);
+        processor.prepareToPlay (48000, blockSize);
+        runBlocks (processor, 3, blockSize);
+
+        REQUIRE(processor.startReplay (file));
+        REQUIRE(processor.isReplaying());
+        auto replayed = runBlocks (processor, 120, blockSize);
+        REQUIRE(! processor.isReplaying());
+
+        // Same messages, same distances between them
+        REQUIRE(replayed.size() == recorded.size());
+        for (size_t i = 0; i < recorded.size(); ++i)
+        {
+            REQUIRE(replayed[i].samplePosition - replayed[0].samplePosition == recorded[i].samplePosition - recorded[0].samplePosition);
+            REQUIRE(replayed[i].status == recorded[i].status);
+            REQUIRE(replayed[i].data1 == recorded[i].data1);
+            REQUIRE(replayed[i].data2 == recorded[i].data2);
+        }
+    }
+
+    SECTION("Host input passed through isn't recorded")
+    {
+        {
+            ProgrammerProcessor processor;
+            processor.setRateAndBufferSizeDetails (48000, 256);
+            processor.prepareToPlay (48000, 256);
+            REQUIRE(processor.ccJournal.start (file, 48000));
+
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midiBuffer;
+            midiBuffer.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, 1, 64), 10);
+            midiBuffer.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 3), 20);
+            processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, ENABLE_ARP_CC, 1));
+            processor.processBlock (buffer, midiBuffer);
+
+            // The host's messages still go out, next to ours
+            REQUIRE(midiBuffer.getNumEvents() == 3);
+            processor.ccJournal.stop();
+        }
+
+        CcJournalReader reader;
+        REQUIRE(reader.open (file));
+        REQUIRE(reader.size() == 1);
+        REQUIRE(reader[0].data1 == ENABLE_ARP_CC);
+    }
+
+    file.deleteFile();
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/MessageQueueProducer.h"
+
+static std::vector<MidiEvent> popAll (ThreadSafeMessageQueue& queue)
+{
+    std::vector<MidiEvent> messages;
+    MidiEvent message;
+    while (queue.pop (message))
+        messages.push_back (message);
+    return messages;
+}
+
+TEST_CASE("MessageQueueProducer functionality", "[MessageQueueProducer]")
+{
+    // NOTE: Actual Capacity for AbstractFifo is capacity-1!
+    constexpr int capacity = 4;
+    ThreadSafeMessageQueue queue(capacity);
+
+    SECTION("Pushes straight into the queue while there is room")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::rejectNew);
+        REQUIRE(producer.push(MidiEvent::controller(1, 10, 1)));
+        REQUIRE(queue.getNumReady() == 1);
+        REQUIRE(producer.getNumPushed() == 1);
+        REQUIRE(producer.getNumPending() == 0);
+        REQUIRE(producer.getNumLost() == 0);
+    }
+
+    SECTION("Reject new")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::rejectNew);
+        for (int i = 0; i < capacity-1; ++i)
+            REQUIRE(producer.push(MidiEvent::controller(1, 10 + i, 1)));
+
+        REQUIRE_FALSE(producer.push(MidiEvent::controller(1, 20, 1)));
+        REQUIRE(producer.getNumRejected() == 1);
+        REQUIRE(producer.getNumLost() == 1);
+        REQUIRE(producer.getNumPending() == 0);
+    }
+
+    SECTION("Drop oldest keeps the newest pending messages")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::dropOldest, 2);
+        for (int i = 0; i < 6; ++i)
+            REQUIRE(producer.push(MidiEvent::controller(1, 10 + i, 1)));
+
+        // 3 in the queue, 2 pending, 1 dropped
+        REQUIRE(producer.getNumPending() == 2);
+        REQUIRE(producer.getNumDroppedOldest() == 1);
+        REQUIRE(producer.getNumLost() == 1);
+
+        auto messages = popAll (queue);
+        producer.flush();
+        auto rest = popAll (queue);
+        messages.insert (messages.end(), rest.begin(), rest.end());
+
+        const std::vector<int> expected { 10, 11, 12, 14, 15 };
+        REQUIRE(messages.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            REQUIRE(messages[i].getControllerNumber() == expected[i]);
+        REQUIRE(producer.getNumPending() == 0);
+    }
+
+    SECTION("Coalesce by CC keeps the latest value")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::coalesceByCc);
+        for (int i = 0; i < capacity-1; ++i)
+            REQUIRE(producer.push(MidiEvent::controller(1, 10, i)));
+
+        // Queue is full, these wait. The second CC 20 replaces the first.
+        REQUIRE(producer.push(MidiEvent::controller(1, 20, 1)));
+        REQUIRE(producer.push(MidiEvent::controller(1, 21, 1)));
+        REQUIRE(producer.push(MidiEvent::controller(1, 20, 2)));
+        REQUIRE(producer.push(MidiEvent::controller(2, 20, 3))); // Other channel, not merged
+        REQUIRE(producer.getNumPending() == 3);
+        REQUIRE(producer.getNumCoalesced() == 1);
+        REQUIRE(producer.getNumLost() == 0);
+
+        popAll (queue);
+        producer.flush();
+        const auto messages = popAll (queue);
+        REQUIRE(messages.size() == 3);
+        REQUIRE(messages[0].getControllerNumber() == 20);
+        REQUIRE(messages[0].getControllerValue() == 2);
+        REQUIRE(messages[1].getControllerNumber() == 21);
+        REQUIRE(messages[2].getChannel() == 2);
+        REQUIRE(messages[2].getControllerValue() == 3);
+    }
+
+    SECTION("Spill keeps everything, in order")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::spill);
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(producer.push(MidiEvent::controller(1, i, 1)));
+
+        REQUIRE(producer.getNumSpilled() == 100 - (capacity-1));
+        REQUIRE(producer.getNumLost() == 0);
+
+        std::vector<MidiEvent> messages;
+        while (messages.size() < 100)
+        {
+            auto popped = popAll (queue);
+            REQUIRE_FALSE(popped.empty());
+            messages.insert (messages.end(), popped.begin(), popped.end());
+            producer.flush();
+        }
+        for (size_t i = 0; i < messages.size(); ++i)
+            REQUIRE(messages[i].getControllerNumber() == static_cast<int> (i));
+        REQUIRE(producer.getNumPushed() == 100);
+    }
+
+    SECTION("Pending messages go before new ones")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::spill);
+        for (int i = 0; i < capacity; ++i)
+            producer.push(MidiEvent::controller(1, i, 1));
+
+        // Room for one, but the pending message must go first
+        MidiEvent message;
+        queue.pop (message);
+        producer.push(MidiEvent::controller(1, 99, 1));
+
+        const auto messages = popAll (queue);
+        REQUIRE(messages.back().getControllerNumber() == capacity-1);
+        REQUIRE(producer.getNumPending() == 1);
+    }
+
+    SECTION("Dropped sysex messages give their pool slot back")
+    {
+        MessageQueueProducer producer(queue, MessageQueueProducer::OverflowPolicy::dropOldest, 1);
+        auto& pool = queue.getSysexPool();
+        const uint8_t sysex[] = { 0xF0, 0x01, 0xF7 };
+        for (int i = 0; i < capacity + 1; ++i)
+            REQUIRE(producer.push(MidiEvent::sysex(pool.store(sysex, sizeof(sysex)))));
+
+        // 3 in the queue, 1 pending, 1 dropped
+        REQUIRE(producer.getNumDroppedOldest() == 1);
+        REQUIRE(pool.getNumInUse() == capacity);
+    }
+}
@@ -0,0 +1,92 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Metrics functionality", "[Metrics]")
+{
+    Metrics metrics;
+
+    SECTION("Every metric has its own cache line")
+    {
+        STATIC_REQUIRE(alignof (Metrics::Counter) == Metrics::cacheLineSize);
+        STATIC_REQUIRE(alignof (Metrics::DurationStats) == Metrics::cacheLineSize);
+        const auto distance = reinterpret_cast<const char*> (&metrics.ccsEmitted) - reinterpret_cast<const char*> (&metrics.messagesPopped);
+        REQUIRE(distance >= static_cast<std::ptrdiff_t> (Metrics::cacheLineSize));
+    }
+
+    SECTION("Counters, gauges and durations")
+    {
+        metrics.messagesPopped.add (3);
+        metrics.messagesPopped.add();
+        metrics.maxQueueDepth.update (5);
+        metrics.maxQueueDepth.update (2);
+
+        const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1000000;
+        metrics.processBlock.record (10 * ticksPerMicrosecond);
+        metrics.processBlock.record (30 * ticksPerMicrosecond);
+
+        metrics.messagesPoppedBySender.add (2);
+
+        const auto snapshot = metrics.getSnapshot (7, 1);
+        REQUIRE(snapshot.messagesPushed == 7);
+        REQUIRE(snapshot.messagesDropped == 1);
+        REQUIRE(snapshot.messagesPopped == 6);
+        REQUIRE(snapshot.maxQueueDepth == 5);
+        REQUIRE(snapshot.processBlock.count == 2);
+        REQUIRE(std::abs (snapshot.processBlock.minMicroseconds - 10.0) < 1.0e-6);
+        REQUIRE(std::abs (snapshot.processBlock.meanMicroseconds - 20.0) < 1.0e-6);
+        REQUIRE(std::abs (snapshot.processBlock.maxMicroseconds - 30.0) < 1.0e-6);
+        REQUIRE(snapshot.editorTick.count == 0);
+    }
+
+    SECTION("CC rate is measured between snapshots")
+    {
+        metrics.getSnapshot (0, 0);
+        metrics.ccsEmitted.add (100);
+        juce::Thread::sleep (100);
+        const auto snapshot = metrics.getSnapshot (0, 0);
+        REQUIRE(snapshot.ccsEmitted == 100);
+        REQUIRE(snapshot.ccsPerSecond > 0.0);
+        REQUIRE(snapshot.ccsPerSecond <= 1000.0);
+    }
+
+    SECTION("Snapshots export to CSV")
+    {
+        auto file = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("MetricsTests.csv");
+        file.deleteFile();
+        REQUIRE(metrics.getSnapshot (1, 0).appendToCsv (file));
+        REQUIRE(metrics.getSnapshot (2, 0).appendToCsv (file));
+
+        juce::StringArray lines;
+        file.readLines (lines);
+        lines.removeEmptyStrings();
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[0].startsWith ("uptime_s,pushed"));
+        REQUIRE(lines[2].upToFirstOccurrenceOf (",", false, false).isNotEmpty());
+        REQUIRE(lines[2].fromFirstOccurrenceOf (",", false, false).startsWith ("2,"));
+        file.deleteFile();
+    }
+
+    SECTION("processBlock updates the metrics")
+    {
+        ProgrammerProcessor processor;
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        processor.prepareToPlay (48000, 512);
+
+        processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, ENABLE_ARP_CC, 1));
+        processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, PORTAMENTO_CC, 10));
+
+        // Host input passed through isn't counted as emitted
+        midiBuffer.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, 1, 64), 0);
+        processor.processBlock (buffer, midiBuffer);
+        midiBuffer.clear();
+        processor.processBlock (buffer, midiBuffer);
+
+        const auto snapshot = processor.getMetricsSnapshot();
+        REQUIRE(snapshot.messagesPopped == 2);
+        REQUIRE(snapshot.maxQueueDepth == 2);
+        REQUIRE(snapshot.ccsEmitted == 2);
+        REQUIRE(snapshot.processBlock.count == 2);
+        REQUIRE(snapshot.processBlock.maxMicroseconds >= snapshot.processBlock.minMicroseconds);
+    }
+}
@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/MidiEvent.h"
+
+TEST_CASE("MidiEvent functionality", "[MidiEvent]")
+{
+    SECTION("Short messages are packed into 8 bytes")
+    {
+        const auto cc = MidiEvent::controller (16, 74, 127, 2, 100);
+        REQUIRE(cc.getStatus() == 0xBF);
+        REQUIRE(cc.isController());
+        REQUIRE(cc.getChannel() == 16);
+        REQUIRE(cc.getControllerNumber() == 74);
+        REQUIRE(cc.getControllerValue() == 127);
+        REQUIRE(cc.port == 2);
+        REQUIRE(cc.sampleOffset == 100);
+        REQUIRE(cc.getSize() == 3);
+
+        const auto programChange = MidiEvent::programChange (1, 5);
+        REQUIRE(programChange.isProgramChange());
+        REQUIRE(programChange.getProgramChangeNumber() == 5);
+        REQUIRE(programChange.getSize() == 2);
+
+        REQUIRE(MidiEvent::noteOn (1, 60, 100).getSize() == 3);
+        REQUIRE(MidiEvent::system (0xF8).getSize() == 1);
+        REQUIRE(MidiEvent::system (0xF2).getSize() == 3);
+    }
+
+    SECTION("Channel voice messages")
+    {
+        const auto bend = MidiEvent::pitchBend (3, 12345);
+        REQUIRE(bend.getStatus() == 0xE2);
+        REQUIRE(bend.getPitchBendValue() == 12345);
+        REQUIRE(bend.getSize() == 3);
+        REQUIRE(MidiEvent::pitchBend (1, 8192).bytes[1] == 0);
+        REQUIRE(MidiEvent::pitchBend (1, 8192).bytes[2] == 64);
+
+        const auto channelPressure = MidiEvent::channelPressure (1, 90);
+        REQUIRE(channelPressure.getStatus() == 0xD0);
+        REQUIRE(channelPressure.bytes[1] == 90);
+        REQUIRE(channelPressure.getSize() == 2);
+
+        const auto polyPressure = MidiEvent::polyPressure (2, 60, 70);
+        REQUIRE(polyPressure.getStatus() == 0xA1);
+        REQUIRE(polyPressure.bytes[1] == 60);
+        REQUIRE(polyPressure.bytes[2] == 70);
+        REQUIRE(polyPressure.getSize() == 3);
+    }
+
+    SECTION("System common messages carry their data bytes")
+    {
+        const auto quarterFrame = MidiEvent::quarterFrame (7, 0x0B);
+        REQUIRE(quarterFrame.getStatus() == 0xF1);
+        REQUIRE(quarterFrame.bytes[1] == 0x7B);
+        REQUIRE(quarterFrame.getSize() == 2);
+
+        const auto songPosition = MidiEvent::songPosition (1000, 1, 32);
+        REQUIRE(songPosition.getStatus() == 0xF2);
+        REQUIRE(songPosition.getSongPosition() == 1000);
+        REQUIRE(songPosition.port == 1);
+        REQUIRE(songPosition.sampleOffset == 32);
+        REQUIRE(songPosition.getSize() == 3);
+
+        const auto songSelect = MidiEvent::songSelect (9);
+        REQUIRE(songSelect.getStatus() == 0xF3);
+        REQUIRE(songSelect.bytes[1] == 9);
+        REQUIRE(songSelect.getSize() == 2);
+        REQUIRE_FALSE(songSelect.isSysex());
+    }
+
+    SECTION("Data bytes are kept to 7 bits")
+    {
+        const auto cc = MidiEvent::controller (1, 200, 128);
+        REQUIRE(cc.getControllerNumber() < 128);
+        REQUIRE(cc.getControllerValue() == 0);
+    }
+
+    SECTION("Sysex refers to a pool slot")
+    {
+        SysexPool pool;
+        const uint8_t sysex[] = { 0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7 };
+        const auto slot = pool.store (sysex, sizeof (sysex));
+        REQUIRE(slot >= 0);
+
+        const auto event = MidiEvent::sysex (slot);
+        REQUIRE(event.isSysex());
+        REQUIRE(event.getSysexSlot() == slot);
+        REQUIRE(event.getSize() == 0);
+
+        juce::MidiBuffer buffer;
+        addMidiEvent (buffer, event, pool);
+        REQUIRE(pool.getNumInUse() == 0);
+        REQUIRE(buffer.getNumEvents() == 1);
+        for (const auto metadata : buffer)
+            REQUIRE(metadata.getMessage().isSysEx());
+    }
+
+    SECTION("The pool runs out of slots instead of allocating")
+    {
+        SysexPool pool;
+        const uint8_t sysex[] = { 0xF0, 0x01, 0xF7 };
+        for (int i = 0; i < SysexPool::numSlots; ++i)
+            REQUIRE(pool.store (sysex, sizeof (sysex)) == i);
+        REQUIRE(pool.store (sysex, sizeof (sysex)) == -1);
+
+        pool.release (3);
+        REQUIRE(pool.store (sysex, sizeof (sysex)) == 3);
+
+        std::vector<uint8_t> tooLong (SysexPool::maxSize + 1, 0);
+        REQUIRE(SysexPool().store (tooLong.data(), tooLong.size()) == -1);
+    }
+}
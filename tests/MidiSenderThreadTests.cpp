@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/MidiSenderThread.h"
+#include <thread>
+
+TEST_CASE("QueueOwnership functionality", "[QueueOwnership]")
+{
+    QueueOwnership ownership;
+
+    SECTION("Audio thread owns the queue by default")
+    {
+        REQUIRE(! ownership.isDirectOutput());
+        REQUIRE(ownership.audioThreadEnter());
+        ownership.audioThreadExit();
+    }
+
+    SECTION("Audio thread skips the queue while the sender owns it")
+    {
+        ownership.acquireForSender();
+        REQUIRE(ownership.isDirectOutput());
+        REQUIRE_FALSE(ownership.audioThreadEnter());
+
+        ownership.releaseFromSender();
+        REQUIRE(ownership.audioThreadEnter());
+        ownership.audioThreadExit();
+    }
+
+    SECTION("Queue is never consumed by both threads at once")
+    {
+        // Both threads pop from the same queue, handing it back and forth. Each
+        // side marks itself as inside while it owns the queue.
+        std::atomic<int> numInside { 0 };
+        std::atomic<bool> overlap { false };
+        std::atomic<bool> done { false };
+
+        std::thread audio ([&] {
+            while (! done)
+            {
+                if (ownership.audioThreadEnter())
+                {
+                    if (++numInside > 1)
+                        overlap = true;
+                    --numInside;
+                    ownership.audioThreadExit();
+                }
+            }
+        });
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            ownership.acquireForSender();
+            if (++numInside > 1)
+                overlap = true;
+            --numInside;
+            ownership.releaseFromSender();
+        }
+        done = true;
+        audio.join();
+
+        REQUIRE_FALSE(overlap);
+    }
+}
@@ -0,0 +1,108 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <set>
+
+TEST_CASE("OscControlServer functionality", "[OscControlServer]")
+{
+    ThreadSafeMessageQueue queue (4);
+    OscControlServer server (queue);
+    MidiEvent message;
+
+    SECTION("Int arguments are raw parameter values")
+    {
+        REQUIRE(server.handleMessage (juce::OSCMessage ("/0coast/MidiAChannel", 3)));
+        REQUIRE(queue.pop (message));
+        REQUIRE(message.isController());
+        REQUIRE(message.getChannel() == MIDI_CHANNEL);
+        REQUIRE(message.getControllerNumber() == MIDI_A_CHANNEL_CC);
+        REQUIRE(message.getControllerValue() == 3);
+    }
+
+    SECTION("Float arguments are normalised over the parameter range")
+    {
+        REQUIRE(server.handleMessage (juce::OSCMessage ("/0coast/Portamento", 1.0f)));
+        REQUIRE(queue.pop (message));
+        REQUIRE(message.getControllerNumber() == PORTAMENTO_CC);
+        REQUIRE(message.getControllerValue() == PORTAMENTO_MAX_VALUE);
+
+        REQUIRE(server.handleMessage (juce::OSCMessage ("/0coast/Portamento", 0.0f)));
+        REQUIRE(queue.pop (message));
+        REQUIRE(message.getControllerValue() == PORTAMENTO_MIN_VALUE);
+    }
+
+    SECTION("Values are clamped to the parameter range")
+    {
+        REQUIRE(server.handleMessage (juce::OSCMessage ("/0coast/EnableArp", 5)));
+        REQUIRE(queue.pop (message));
+        REQUIRE(message.getControllerValue() == ENABLE_ARP_MAX_VALUE);
+    }
+
+    SECTION("Unknown addresses and arguments are rejected")
+    {
+        REQUIRE_FALSE(server.handleMessage (juce::OSCMessage ("/0coast/NoSuchParameter", 1)));
+        REQUIRE_FALSE(server.handleMessage (juce::OSCMessage ("/0coast/Portamento", juce::String ("64"))));
+        REQUIRE_FALSE(server.handleMessage (juce::OSCMessage ("/0coast/Portamento")));
+        REQUIRE(server.getNumRejected() == 3);
+        REQUIRE(queue.getNumReady() == 0);
+    }
+
+    SECTION("Wildcard patterns set every parameter they match")
+    {
+        REQUIRE(server.handleMessage (juce::OSCMessage ("/0coast/{Portamento,EnableArp}", 1.0f)));
+        REQUIRE(server.getNumAccepted() == 2);
+
+        std::set<int> ccs;
+        while (queue.pop (message))
+        {
+            ccs.insert (message.getControllerNumber());
+            REQUIRE(message.getControllerValue() == (message.getControllerNumber() == PORTAMENTO_CC ? PORTAMENTO_MAX_VALUE : ENABLE_ARP_MAX_VALUE));
+        }
+        REQUIRE(ccs == std::set<int> { PORTAMENTO_CC, ENABLE_ARP_CC });
+    }
+
+    SECTION("A full queue drops messages")
+    {
+        // A queue of 4 holds 3 messages
+        for (int i = 0; i < 4; ++i)
+            server.handleMessage (juce::OSCMessage ("/0coast/Portamento", i));
+        REQUIRE(server.getNumAccepted() == 3);
+        REQUIRE(server.getNumDropped() == 1);
+    }
+
+    SECTION("Messages sent over UDP end up in processBlock")
+    {
+        ProgrammerProcessor processor;
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        processor.prepareToPlay (48000, 512);
+
+        // Any free port, so parallel runs don't collide
+        REQUIRE(processor.startOscServer (0));
+        REQUIRE(processor.isOscServerRunning());
+        const auto port = processor.getOscServerPort();
+        REQUIRE(port > 0);
+
+        juce::OSCSender sender;
+        REQUIRE(sender.connect ("127.0.0.1", port));
+        REQUIRE(sender.send ("/0coast/MidiBVelocityScale", 100));
+
+        // Give the network thread up to a second
+        bool received = false;
+        for (int i = 0; i < 100 && ! received; ++i)
+        {
+            juce::Thread::sleep (10);
+            processor.processBlock (buffer, midiBuffer);
+            for (const auto metadata : midiBuffer)
+            {
+                const auto midiMessage = metadata.getMessage();
+                if (midiMessage.getControllerNumber() == MIDI_B_VELOCITY_CC && midiMessage.getControllerValue() == 100)
+                    received = true;
+            }
+            midiBuffer.clear();
+        }
+        REQUIRE(received);
+
+        processor.stopOscServer();
+        REQUIRE_FALSE(processor.isOscServerRunning());
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/ParameterState.h"
+#include <thread>
+
+TEST_CASE("ParameterState functionality", "[ParameterState]")
+{
+    ParameterState state;
+    constexpr auto portamento = parameterIndex (PORTAMENTO_NAME);
+
+    SECTION("Starts with the defaults")
+    {
+        REQUIRE(state.getSnapshot() == ProgramState::defaults());
+    }
+
+    SECTION("Single values")
+    {
+        state.set (portamento, 64);
+        REQUIRE(state.get (portamento) == 64);
+        REQUIRE(state.getSnapshot()[portamento] == 64);
+    }
+
+    SECTION("Whole states")
+    {
+        ProgramState newState;
+        for (size_t i = 0; i < numParameters; ++i)
+            newState[i] = static_cast<uint8_t> ((i * 37) % 128);
+
+        state.set (newState);
+        REQUIRE(state.getSnapshot() == newState);
+    }
+
+    SECTION("Readers only see values which were written")
+    {
+        std::thread writer ([&state, portamento] {
+            for (int i = 0; i < 100000; ++i)
+                state.set (portamento, static_cast<uint8_t> (i % 2 == 0 ? 10 : 20));
+        });
+
+        bool valid = true;
+        for (int i = 0; i < 100000; ++i)
+        {
+            const auto value = state.get (portamento);
+            valid = valid && (value == 10 || value == 20 || value == PORTAMENTO_VALUE);
+        }
+        writer.join();
+        REQUIRE(valid);
+    }
+}
@@ -1,6 +1,9 @@
 #include "helpers/test_helpers.h"
 #include <PluginProcessor.h>
 #include <PluginEditor.h>
+#include <ZeroCoastSimulator.h>
+#include <configuration.h>
+#include <thread>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
@@ -32,6 +35,7 @@ TEST_CASE ("IPP version", "[ipp]")
 TEST_CASE("Processor/Editor End2End Test", "[Send ControllerChange on button press]")
 {
     ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
     ProgrammerEditor testPluginEditor(testPlugin);
     // -- Setup of properties and buffers
     // Properties
@@ -66,9 +70,8 @@ TEST_CASE("Processor/Editor End2End Test", "[Send ControllerChange on button pre
     // -- Test 2 --
     // Simulate button press
     testPluginEditor.testEnableArp();
-    // Wait a bit (1sec) so timer can trigger. NOTE: Doesn't work - Fire callback manually instead?
-    //juce::Thread::sleep(2000);
-    testPluginEditor.testTimerCallback();
+    // Let one editor tick go by
+    scheduler.advance (ProgrammerEditor::tickIntervalMs);
     
     // Run another block
     testPlugin.processBlock (myBuffer, myMidiBuffer);
@@ -104,6 +107,381 @@ TEST_CASE("Processor/Editor End2End Test", "[Send ControllerChange on button pre
 
 }
 
+TEST_CASE("Host automation is sent as decimated CCs", "[Send ControllerChange on automation]")
+{
+    ProgrammerProcessor testPlugin;
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+
+    auto* portamento = testPlugin.parameters.getParameter (PORTAMENTO_NAME);
+    REQUIRE (portamento != nullptr);
+
+    // -- Test 1 --
+    // Automate portamento to 64
+    portamento->setValueNotifyingHost (portamento->convertTo0to1 (64.0f));
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+
+    CHECK( myMidiBuffer.getNumEvents() == 1);
+    for (const auto metadata : myMidiBuffer ) {
+      auto midiMessage = metadata.getMessage();
+      CHECK( midiMessage.isController() == true );
+      CHECK( midiMessage.getChannel() == MIDI_CHANNEL );
+      CHECK( midiMessage.getControllerNumber() == PORTAMENTO_CC );
+      CHECK( midiMessage.getControllerValue() == 64 );
+    }
+    myMidiBuffer.clear();
+
+    // -- Test 2 --
+    // Same value, lots of blocks. Nothing should be sent.
+    for (int i = 0; i < 10; ++i)
+    {
+        portamento->setValueNotifyingHost (portamento->convertTo0to1 (64.0f));
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+    }
+    CHECK( myMidiBuffer.isEmpty() == true );
+}
+
+TEST_CASE("Automation after a direct output edit is sent", "[Send ControllerChange with direct output]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    ProgrammerEditor testPluginEditor (testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+    constexpr auto portamentoIndex = parameterIndex (PORTAMENTO_NAME);
+    auto* portamento = testPlugin.parameters.getParameter (PORTAMENTO_NAME);
+
+    // Virtual outputs aren't available everywhere (ie. Windows)
+    auto output = juce::MidiOutput::createNewDevice ("0-Programmer Test");
+    if (output == nullptr)
+    {
+        WARN ("No virtual MIDI output, skipped");
+        return;
+    }
+
+    // Automation sends 64
+    portamento->setValueNotifyingHost (portamento->convertTo0to1 (64.0f));
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 1 );
+    myMidiBuffer.clear();
+
+    // The editor sends 10 over direct output. Once the queue is empty, the sender sent it.
+    REQUIRE( testPlugin.startDirectOutput (std::move (output)) );
+    auto widgetState = testPluginEditor.testGetWidgetState();
+    widgetState[portamentoIndex] = 10;
+    testPluginEditor.testSetWidgetState (widgetState);
+    scheduler.advance (ProgrammerEditor::tickIntervalMs);
+    for (int i = 0; i < 1000 && testPlugin.messageQueue->getNumReady() > 0; ++i)
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    REQUIRE( testPlugin.messageQueue->getNumReady() == 0 );
+
+    // The host parameter follows, which sends nothing
+    scheduler.advance (ProgrammerProcessor::hostSyncIntervalMs);
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.isEmpty() == true );
+
+    // Automation goes back to 64, which the device doesn't have anymore
+    portamento->setValueNotifyingHost (portamento->convertTo0to1 (64.0f));
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 1 );
+    for (const auto metadata : myMidiBuffer )
+        CHECK( metadata.getMessage().getControllerValue() == 64 );
+
+    testPlugin.stopDirectOutput();
+}
+
+TEST_CASE("Undo and redo only send the differing CCs", "[Send ControllerChange on undo]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    ProgrammerEditor testPluginEditor(testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+
+    // Enable arp, and let it go out
+    testPluginEditor.testEnableArp();
+    scheduler.advance (ProgrammerEditor::tickIntervalMs);
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 1);
+    myMidiBuffer.clear();
+
+    // -- Test 1 --
+    // Undo. Arp is switched off again, and nothing else is sent.
+    testPluginEditor.undo();
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 1);
+    for (const auto metadata : myMidiBuffer ) {
+      auto midiMessage = metadata.getMessage();
+      CHECK( midiMessage.getControllerNumber() == ENABLE_ARP_CC );
+      CHECK( midiMessage.getControllerValue() == 0 );
+    }
+    myMidiBuffer.clear();
+
+    // -- Test 2 --
+    // Redo. Arp is switched on again.
+    testPluginEditor.redo();
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 1);
+    for (const auto metadata : myMidiBuffer ) {
+      auto midiMessage = metadata.getMessage();
+      CHECK( midiMessage.getControllerNumber() == ENABLE_ARP_CC );
+      CHECK( midiMessage.getControllerValue() == 1 );
+    }
+}
+
+TEST_CASE("Morphing between program states", "[Send ControllerChange on morph]")
+{
+    ProgrammerProcessor testPlugin;
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.setRateAndBufferSizeDetails (48000, 512);
+    testPlugin.prepareToPlay (48000, 512);
+
+    auto from = ProgramState::defaults();
+    auto to = ProgramState::defaults();
+    to[parameterIndex (PORTAMENTO_NAME)] = 127;
+    to[parameterIndex (ENABLE_ARP_NAME)] = 1;
+
+    // No playhead in the test, so 1 bar is 2 seconds (120bpm 4/4)
+    testPlugin.startMorph (from, to, 1.0);
+    CHECK( testPlugin.isMorphing() == true );
+
+    int numBlocks = 0;
+    int numPortamentoMessages = 0;
+    int numArpMessages = 0;
+    int lastPortamento = -1;
+    while (testPlugin.isMorphing() && numBlocks < 1000)
+    {
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        for (const auto metadata : myMidiBuffer ) {
+          auto midiMessage = metadata.getMessage();
+          if (midiMessage.getControllerNumber() == PORTAMENTO_CC)
+          {
+              // Every message must be a new value
+              CHECK( midiMessage.getControllerValue() != lastPortamento );
+              lastPortamento = midiMessage.getControllerValue();
+              ++numPortamentoMessages;
+          }
+          if (midiMessage.getControllerNumber() == ENABLE_ARP_CC)
+              ++numArpMessages;
+        }
+        myMidiBuffer.clear();
+        ++numBlocks;
+    }
+
+    // 96000 samples in blocks of 512
+    CHECK( numBlocks == 188 );
+    CHECK( lastPortamento == 127 );
+    CHECK( numPortamentoMessages <= 127 );
+    CHECK( numArpMessages == 1 );
+}
+
+TEST_CASE("Editors are views on the processor's parameter state", "[Parameter state]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+    constexpr auto arpIndex = parameterIndex (ENABLE_ARP_NAME);
+    constexpr auto portamentoIndex = parameterIndex (PORTAMENTO_NAME);
+
+    // -- Test 1 --
+    // Headless. Automation ends up in the parameter state.
+    auto* portamento = testPlugin.parameters.getParameter (PORTAMENTO_NAME);
+    portamento->setValueNotifyingHost (portamento->convertTo0to1 (64.0f));
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( testPlugin.parameterState.get (portamentoIndex) == 64 );
+    myMidiBuffer.clear();
+
+    // -- Test 2 --
+    // An edit in the editor goes to the parameter state right away
+    {
+        ProgrammerEditor testPluginEditor (testPlugin);
+        CHECK( testPluginEditor.testGetWidgetState()[portamentoIndex] == 64 );
+
+        testPluginEditor.testEnableArp();
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        CHECK( testPlugin.parameterState.get (arpIndex) == 1 );
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        CHECK( myMidiBuffer.getNumEvents() == 1 );
+        myMidiBuffer.clear();
+    }
+
+    // -- Test 3 --
+    // A reopened editor shows the current values, and sends nothing
+    {
+        ProgrammerEditor testPluginEditor (testPlugin);
+        CHECK( testPluginEditor.testGetWidgetState() == testPlugin.parameterState.getSnapshot() );
+
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        CHECK( myMidiBuffer.isEmpty() == true );
+    }
+
+    // -- Test 4 --
+    // Two editors on the same state. An edit in one shows up in the other, and is
+    // only sent once.
+    {
+        testPlugin.parameterState.set (arpIndex, 0);
+        ProgrammerEditor firstEditor (testPlugin);
+        ProgrammerEditor secondEditor (testPlugin);
+
+        // Both tick at the same time, the first editor first
+        firstEditor.testEnableArp();
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        CHECK( secondEditor.testGetWidgetState()[arpIndex] == 1 );
+
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        CHECK( myMidiBuffer.getNumEvents() == 1 );
+        myMidiBuffer.clear();
+
+        // Changes from automation show up in both
+        portamento->setValueNotifyingHost (portamento->convertTo0to1 (100.0f));
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+        CHECK( firstEditor.testGetWidgetState()[portamentoIndex] == 100 );
+        CHECK( secondEditor.testGetWidgetState()[portamentoIndex] == 100 );
+        myMidiBuffer.clear();
+
+        // Following a change is not an edit, so nothing is sent back
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        CHECK( myMidiBuffer.isEmpty() == true );
+    }
+}
+
+TEST_CASE("Edits in the editor reach the host and the saved state", "[Plugin state]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+    constexpr auto arpIndex = parameterIndex (ENABLE_ARP_NAME);
+    constexpr auto portamentoIndex = parameterIndex (PORTAMENTO_NAME);
+
+    ProgrammerEditor testPluginEditor (testPlugin);
+    auto widgetState = testPluginEditor.testGetWidgetState();
+    widgetState[portamentoIndex] = 42;
+    widgetState[arpIndex] = 1;
+    testPluginEditor.testSetWidgetState (widgetState);
+    scheduler.advance (ProgrammerEditor::tickIntervalMs);
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.getNumEvents() == 2 );
+    myMidiBuffer.clear();
+
+    // -- Test 1 --
+    // The host parameters follow the edit, and following it sends nothing
+    scheduler.advance (ProgrammerProcessor::hostSyncIntervalMs);
+    CHECK( testPlugin.parameters.getRawParameterValue (PORTAMENTO_NAME)->load() == 42.0f );
+    CHECK( testPlugin.parameters.getRawParameterValue (ENABLE_ARP_NAME)->load() == 1.0f );
+    testPlugin.processBlock (myBuffer, myMidiBuffer);
+    CHECK( myMidiBuffer.isEmpty() == true );
+
+    // -- Test 2 --
+    // Saved and loaded into a new instance, which sends the edit to the device
+    {
+        juce::MemoryBlock stateData;
+        testPlugin.getStateInformation (stateData);
+
+        ProgrammerProcessor reloadedPlugin;
+        reloadedPlugin.prepareToPlay (48000, 512);
+        reloadedPlugin.setStateInformation (stateData.getData(), static_cast<int> (stateData.getSize()));
+        CHECK( reloadedPlugin.parameters.getRawParameterValue (PORTAMENTO_NAME)->load() == 42.0f );
+
+        reloadedPlugin.processBlock (myBuffer, myMidiBuffer);
+        CHECK( myMidiBuffer.getNumEvents() == 2 );
+        CHECK( reloadedPlugin.parameterState.get (portamentoIndex) == 42 );
+        CHECK( reloadedPlugin.parameterState.get (arpIndex) == 1 );
+        myMidiBuffer.clear();
+    }
+
+    // -- Test 3 --
+    // An edit saved before the host parameters caught up is saved too
+    {
+        widgetState[portamentoIndex] = 7;
+        testPluginEditor.testSetWidgetState (widgetState);
+        scheduler.advance (ProgrammerEditor::tickIntervalMs);
+
+        juce::MemoryBlock stateData;
+        testPlugin.getStateInformation (stateData);
+
+        ProgrammerProcessor reloadedPlugin;
+        reloadedPlugin.setStateInformation (stateData.getData(), static_cast<int> (stateData.getSize()));
+        CHECK( reloadedPlugin.parameters.getRawParameterValue (PORTAMENTO_NAME)->load() == 7.0f );
+    }
+}
+
+TEST_CASE("Twenty minutes of UI and audio in virtual time", "[Virtual time]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    ProgrammerEditor testPluginEditor (testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+    constexpr auto arpIndex = parameterIndex (ENABLE_ARP_NAME);
+
+    // The audio device calls processBlock every 512 samples
+    int numBlocks = 0;
+    int numArpMessages = 0;
+    scheduler.callEvery (512.0 * 1000.0 / 48000.0, [&] {
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        for (const auto metadata : myMidiBuffer ) {
+          if (metadata.getMessage().getControllerNumber() == ENABLE_ARP_CC)
+              ++numArpMessages;
+        }
+        myMidiBuffer.clear();
+        ++numBlocks;
+    });
+
+    // The user flips arp every 10 seconds
+    scheduler.callEvery (10000.0, [&] {
+        auto state = testPluginEditor.testGetWidgetState();
+        state[arpIndex] = state[arpIndex] == 0 ? 1 : 0;
+        testPluginEditor.testSetWidgetState (state);
+    });
+
+    // Two more seconds, so the last flip gets a tick and a block
+    scheduler.advance ((20 * 60 + 2) * 1000.0);
+
+    CHECK( numBlocks == 112687 );
+    CHECK( numArpMessages == 120 );
+    CHECK( testPlugin.parameterState.get (arpIndex) == 0 );
+}
+
+TEST_CASE("The simulated 0-Coast ends up in the program set in the editor", "[ZeroCoastSimulator]")
+{
+    ProgrammerProcessor testPlugin;
+    auto& scheduler = useVirtualTime (testPlugin);
+    ProgrammerEditor testPluginEditor (testPlugin);
+    juce::AudioBuffer<float> myBuffer (2, 512);
+    juce::MidiBuffer myMidiBuffer;
+    testPlugin.prepareToPlay (48000, 512);
+
+    // Everything processBlock sends goes over the (simulated) wire to the device
+    ZeroCoastSimulator device;
+    scheduler.callEvery (512.0 * 1000.0 / 48000.0, [&] {
+        testPlugin.processBlock (myBuffer, myMidiBuffer);
+        device.processBlock (myMidiBuffer, 512, 48000);
+        myMidiBuffer.clear();
+    });
+
+    auto state = ProgramState::defaults();
+    for (size_t i = 0; i < numParameters; ++i)
+        state[i] = static_cast<uint8_t> (parameterDefinitions[i].maxValue);
+    testPluginEditor.testSetWidgetState (state);
+    scheduler.advance (2 * ProgrammerEditor::tickIntervalMs);
+
+    CHECK( device.getState() == state );
+    CHECK( device.getNumBytesLost() == 0 );
+}
+
 TEST_CASE("Screenshot", "[Take a screenshot of the main window]")
 {
     runWithinPluginEditor ([&] (ProgrammerProcessor& plugin) {
@@ -0,0 +1,93 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include "../source/PresetImporter.h"
+#include "../source/ProgramExporter.h"
+
+TEST_CASE("PresetImporter functionality", "[PresetImporter]")
+{
+    auto directory = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("PresetImporterTests");
+    directory.deleteRecursively();
+    REQUIRE(directory.createDirectory());
+
+    // A MIDI file with two programs, and a raw dump in a subdirectory with one
+    // new program and one duplicate
+    PresetBank midiBank;
+    midiBank.add ("One", makeProgramState (1));
+    midiBank.add ("Two", makeProgramState (2));
+    REQUIRE(ProgramExporter::exportBank (midiBank, directory.getChildFile ("library.mid"), ProgramExporter::Format::standardMidiFile));
+
+    PresetBank rawBank;
+    rawBank.add ("Three", makeProgramState (3));
+    rawBank.add ("Two again", makeProgramState (2));
+    REQUIRE(directory.getChildFile ("sub").createDirectory());
+    REQUIRE(ProgramExporter::exportBank (rawBank, directory.getChildFile ("sub/dump.syx"), ProgramExporter::Format::rawDump));
+
+    SECTION("Import a directory tree")
+    {
+        PresetBank bank;
+        auto result = PresetImporter::importDirectory (directory, bank);
+
+        REQUIRE(result.numFiles == 2);
+        REQUIRE(result.numRejectedFiles == 0);
+        REQUIRE(result.numPresetsFound == 4);
+        REQUIRE(result.numDuplicates == 1);
+        REQUIRE(result.numImported == 3);
+
+        // Files are merged in path order, names come from markers or the file name
+        REQUIRE(bank.size() == 3);
+        REQUIRE(bank.getName (0) == "One");
+        REQUIRE(bank.getState (0) == makeProgramState (1));
+        REQUIRE(bank.getName (1) == "Two");
+        REQUIRE(bank.getName (2) == "dump");
+        REQUIRE(bank.getState (2) == makeProgramState (3));
+    }
+
+    SECTION("Presets already in the bank are duplicates")
+    {
+        PresetBank bank;
+        bank.add ("Existing", makeProgramState (1));
+        BackgroundExecutor executor (2);
+        auto result = PresetImporter::importDirectory (directory, bank, executor);
+        REQUIRE(result.numDuplicates == 2);
+        REQUIRE(bank.size() == 3);
+    }
+
+    SECTION("Files with out of range values are rejected")
+    {
+        // EnableArp only goes to 1
+        const uint8_t invalid[] = { 0xB0, ENABLE_ARP_CC, 5, 0xB0, PORTAMENTO_CC, 10 };
+        REQUIRE(directory.getChildFile ("invalid.syx").replaceWithData (invalid, sizeof (invalid)));
+
+        PresetBank bank;
+        auto result = PresetImporter::importDirectory (directory, bank);
+        REQUIRE(result.numFiles == 3);
+        REQUIRE(result.numRejectedFiles == 1);
+        REQUIRE(result.errors.size() == 1);
+        REQUIRE(bank.size() == 3);
+    }
+
+    SECTION("Other files are ignored")
+    {
+        REQUIRE(directory.getChildFile ("readme.txt").replaceWithText ("Not a preset"));
+
+        PresetBank bank;
+        auto result = PresetImporter::importDirectory (directory, bank);
+        REQUIRE(result.numFiles == 2);
+    }
+
+    SECTION("Raw dumps with running status and SysEx")
+    {
+        const uint8_t data[] = { 0xF0, 0x00, 0x01, 0xF7, 0xB0, PORTAMENTO_CC, 20, MIDI_A_PITCH_CC, 30 };
+        auto file = directory.getChildFile ("running.bin");
+        REQUIRE(file.replaceWithData (data, sizeof (data)));
+
+        std::vector<PresetImporter::ParsedPreset> presets;
+        juce::String error;
+        REQUIRE(PresetImporter::parseFile (file, presets, error));
+        REQUIRE(presets.size() == 1);
+        REQUIRE(presets[0].state[parameterIndex (PORTAMENTO_NAME)] == 20);
+        REQUIRE(presets[0].state[parameterIndex (MIDI_A_PITCH_NAME)] == 30);
+    }
+
+    directory.deleteRecursively();
+}
@@ -0,0 +1,110 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include "../source/PresetIndex.h"
+
+static bool matches (const ProgramState& record, const PresetIndex::Query& query)
+{
+    for (const auto& term : query.terms)
+    {
+        if (record[term.parameter] < term.low || record[term.parameter] > term.high)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("PresetIndex functionality", "[PresetIndex]")
+{
+    constexpr auto arpEnable = parameterIndex (ENABLE_ARP_NAME);
+    constexpr auto legatoEnable = parameterIndex (ENABLE_LEGATO_NAME);
+    constexpr auto midiACV = parameterIndex (MIDI_A_CV_NAME);
+    constexpr auto midiBChannel = parameterIndex (MIDI_B_CHANNEL_NAME);
+    constexpr auto portamento = parameterIndex (PORTAMENTO_NAME);
+
+    PresetIndex index;
+
+    SECTION("Empty index finds nothing")
+    {
+        REQUIRE(index.find (PresetIndex::Query().equals (arpEnable, 1)).count() == 0);
+    }
+
+    SECTION("Discrete terms")
+    {
+        auto on = ProgramState::defaults();
+        on[arpEnable] = 1;
+        index.add (ProgramState::defaults());
+        index.add (on);
+        index.add (on);
+
+        auto result = index.find (PresetIndex::Query().equals (arpEnable, 1));
+        REQUIRE(result.count() == 2);
+        REQUIRE_FALSE(result.contains (0));
+        REQUIRE(result.contains (1));
+        REQUIRE(result.contains (2));
+
+        // Values outside the parameter range never match
+        REQUIRE(index.find (PresetIndex::Query().equals (arpEnable, 5)).count() == 0);
+    }
+
+    SECTION("Slider ranges are exact, also inside buckets")
+    {
+        for (int value = 0; value < 128; ++value)
+        {
+            auto record = ProgramState::defaults();
+            record[portamento] = static_cast<uint8_t> (value);
+            index.add (record);
+        }
+
+        REQUIRE(index.find (PresetIndex::Query().range (portamento, 10, 20)).count() == 11);
+        REQUIRE(index.find (PresetIndex::Query().range (portamento, 16, 23)).count() == 8);
+        REQUIRE(index.find (PresetIndex::Query().equals (portamento, 77)).count() == 1);
+        REQUIRE(index.find (PresetIndex::Query().range (portamento, 0, 127)).count() == 128);
+        REQUIRE(index.find (PresetIndex::Query().range (portamento, 20, 10)).count() == 0);
+    }
+
+    SECTION("Combined queries match a brute force scan")
+    {
+        auto records = makeRandomProgramStates (5000);
+        index.rebuild (records);
+        REQUIRE(index.size() == records.size());
+
+        // "arpeggiator on, legato off, MIDI A CV = LFO, MIDI B channel = All"
+        auto query = PresetIndex::Query()
+                         .equals (arpEnable, 1)
+                         .equals (legatoEnable, 0)
+                         .equals (midiACV, 3)
+                         .equals (midiBChannel, 16);
+        auto withRange = PresetIndex::Query().equals (arpEnable, 1).range (portamento, 13, 99);
+
+        for (const auto* q : { &query, &withRange })
+        {
+            auto result = index.find (*q);
+            size_t expected = 0;
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                REQUIRE(result.contains (i) == matches (records[i], *q));
+                expected += matches (records[i], *q) ? 1u : 0u;
+            }
+            REQUIRE(result.count() == expected);
+        }
+    }
+
+    SECTION("Incremental adds show up in results")
+    {
+        auto records = makeRandomProgramStates (100);
+        index.rebuild (records);
+        auto before = index.find (PresetIndex::Query().equals (arpEnable, 1)).count();
+
+        auto on = ProgramState::defaults();
+        on[arpEnable] = 1;
+        index.add (on);
+
+        auto result = index.find (PresetIndex::Query().equals (arpEnable, 1));
+        REQUIRE(result.count() == before + 1);
+        REQUIRE(result.contains (100));
+
+        std::vector<size_t> found;
+        result.forEach ([&] (size_t preset) { found.push_back (preset); });
+        REQUIRE(found.size() == result.count());
+        REQUIRE(found.back() == 100);
+    }
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/PresetMorph.h"
+
+TEST_CASE("PresetMorph functionality", "[PresetMorph]")
+{
+    PresetMorph morph;
+    ProgramState state;
+
+    constexpr auto portamento = parameterIndex (PORTAMENTO_NAME);
+    constexpr auto arpEnable = parameterIndex (ENABLE_ARP_NAME);
+
+    auto from = ProgramState::defaults();
+    auto to = ProgramState::defaults();
+    from[portamento] = 0;
+    to[portamento] = 100;
+    from[arpEnable] = 0;
+    to[arpEnable] = 1;
+
+    SECTION("Nothing is produced when not running")
+    {
+        REQUIRE_FALSE(morph.isRunning());
+        REQUIRE_FALSE(morph.process(512, state));
+    }
+
+    SECTION("Continuous parameters are interpolated")
+    {
+        morph.start(from, to, 1000);
+
+        REQUIRE(morph.process(250, state));
+        REQUIRE(state[portamento] == 25);
+
+        REQUIRE(morph.process(250, state));
+        REQUIRE(state[portamento] == 50);
+
+        REQUIRE(morph.process(500, state));
+        REQUIRE(state[portamento] == 100);
+        REQUIRE_FALSE(morph.isRunning());
+    }
+
+    SECTION("Morphing down works as well")
+    {
+        morph.start(to, from, 100);
+        REQUIRE(morph.process(50, state));
+        REQUIRE(state[portamento] == 50);
+        REQUIRE(morph.process(50, state));
+        REQUIRE(state[portamento] == 0);
+    }
+
+    SECTION("Discrete parameters switch at the switch point")
+    {
+        morph.start(from, to, 1000, 0.75f);
+
+        REQUIRE(morph.process(700, state));
+        REQUIRE(state[arpEnable] == 0);
+
+        REQUIRE(morph.process(100, state));
+        REQUIRE(state[arpEnable] == 1);
+    }
+
+    SECTION("Morph never overshoots the target")
+    {
+        morph.start(from, to, 1000);
+        REQUIRE(morph.process(5000, state));
+        REQUIRE(state == to);
+        REQUIRE_FALSE(morph.isRunning());
+    }
+
+    SECTION("Zero length jumps straight to the target")
+    {
+        morph.start(from, to, 0);
+        REQUIRE(morph.process(1, state));
+        REQUIRE(state == to);
+    }
+
+    SECTION("Stopping a morph")
+    {
+        morph.start(from, to, 1000);
+        REQUIRE(morph.process(100, state));
+        morph.stop();
+        REQUIRE_FALSE(morph.process(100, state));
+    }
+}
@@ -0,0 +1,128 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include "../source/PresetSimilarity.h"
+
+TEST_CASE("PresetSimilarity functionality", "[PresetSimilarity]")
+{
+    constexpr auto portamento = parameterIndex (PORTAMENTO_NAME);
+    constexpr auto arpEnable = parameterIndex (ENABLE_ARP_NAME);
+    constexpr auto midiBVelocity = parameterIndex (MIDI_B_VELOCITY_NAME);
+
+    SECTION("Default weights")
+    {
+        const auto weights = PresetSimilarity::getDefaultWeights();
+        REQUIRE(weights[portamento] == 1);
+        REQUIRE(weights[arpEnable] == 127);
+        for (auto weight : weights)
+            REQUIRE(weight <= 127);
+    }
+
+    SECTION("Scalar kernel is always available")
+    {
+        REQUIRE(PresetSimilarity::isKernelAvailable (PresetSimilarity::Kernel::scalar));
+        REQUIRE(PresetSimilarity::isKernelAvailable (PresetSimilarity::getBestKernel()));
+    }
+
+    SECTION("Every available kernel matches the scalar kernel")
+    {
+        // Odd count, so kernels working on several records at a time hit their tail
+        const auto records = makeRandomProgramStates (1001, 99);
+        const auto target = makeRandomProgramStates (1, 7)[0];
+
+        // Maximum weights and differences, to catch overflow in the narrow lanes
+        PresetSimilarity::Weights maxWeights;
+        maxWeights.fill (127);
+        const auto extremes = [&] {
+            auto result = records;
+            for (size_t r = 0; r < result.size(); ++r)
+                result[r].values.fill (r % 2 == 0 ? 0 : 127);
+            return result;
+        }();
+
+        for (const auto& weights : { PresetSimilarity::getDefaultWeights(), maxWeights })
+        {
+            for (const auto* set : { &records, &extremes })
+            {
+                std::vector<uint32_t> expected (set->size());
+                PresetSimilarity::computeDistances (set->data(), set->size(), target, weights, expected.data(), PresetSimilarity::Kernel::scalar);
+
+                for (auto kernel : { PresetSimilarity::Kernel::ssse3, PresetSimilarity::Kernel::avx2, PresetSimilarity::Kernel::neon })
+                {
+                    if (! PresetSimilarity::isKernelAvailable (kernel))
+                        continue;
+
+                    INFO(PresetSimilarity::getKernelName (kernel));
+                    std::vector<uint32_t> distances (set->size());
+                    PresetSimilarity::computeDistances (set->data(), set->size(), target, weights, distances.data(), kernel);
+                    REQUIRE(distances == expected);
+                }
+            }
+        }
+    }
+
+    SECTION("Distance is the weighted sum of differences")
+    {
+        auto target = ProgramState::defaults();
+        auto record = target;
+        record[portamento] = static_cast<uint8_t> (record[portamento] + 10);
+        record[midiBVelocity] = static_cast<uint8_t> (record[midiBVelocity] + 3);
+
+        uint32_t distance = 0;
+        PresetSimilarity::computeDistances (&record, 1, target, PresetSimilarity::getDefaultWeights(), &distance, PresetSimilarity::getBestKernel());
+        REQUIRE(distance == 13);
+    }
+
+    SECTION("Finds the closest records, closest first")
+    {
+        const auto target = ProgramState::defaults();
+        std::vector<ProgramState> records (5, target);
+        records[0][portamento] = 100; // Far away
+        records[1][portamento] = static_cast<uint8_t> (target[portamento] + 2);
+        records[2][arpEnable] = 1; // Counts as a full slider sweep
+        records[3][portamento] = static_cast<uint8_t> (target[portamento] + 1);
+        // records[4] is the target itself
+
+        const auto matches = PresetSimilarity::findSimilar (records, target, 3);
+        REQUIRE(matches.size() == 3);
+        REQUIRE(matches[0].index == 4);
+        REQUIRE(matches[0].distance == 0);
+        REQUIRE(matches[1].index == 3);
+        REQUIRE(matches[2].index == 1);
+    }
+
+    SECTION("Ties are in bank order")
+    {
+        const auto target = ProgramState::defaults();
+        const std::vector<ProgramState> records (10, target);
+        const auto matches = PresetSimilarity::findSimilar (records, target, 4);
+        REQUIRE(matches.size() == 4);
+        for (size_t i = 0; i < matches.size(); ++i)
+            REQUIRE(matches[i].index == i);
+    }
+
+    SECTION("Fewer records than results")
+    {
+        const auto records = makeRandomProgramStates (3, 5);
+        REQUIRE(PresetSimilarity::findSimilar (records, ProgramState::defaults(), 10).size() == 3);
+        REQUIRE(PresetSimilarity::findSimilar (records, ProgramState::defaults(), 0).empty());
+        REQUIRE(PresetSimilarity::findSimilar ({}, ProgramState::defaults(), 10).empty());
+    }
+
+    SECTION("Threaded scan finds the same matches")
+    {
+        const auto records = makeRandomProgramStates (20000, 3);
+        const auto target = records[1234];
+        const auto weights = PresetSimilarity::getDefaultWeights();
+        const auto kernel = PresetSimilarity::getBestKernel();
+
+        const auto single = PresetSimilarity::findSimilar (records, target, 50, weights, kernel, 1);
+        const auto threaded = PresetSimilarity::findSimilar (records, target, 50, weights, kernel, 4);
+        REQUIRE(single.size() == threaded.size());
+        REQUIRE(single[0].index == 1234);
+        for (size_t i = 0; i < single.size(); ++i)
+        {
+            REQUIRE(single[i].index == threaded[i].index);
+            REQUIRE(single[i].distance == threaded[i].distance);
+        }
+    }
+}
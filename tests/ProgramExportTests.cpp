@@ -0,0 +1,86 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "../source/ProgramExporter.h"
+
+TEST_CASE("ProgramExporter functionality", "[ProgramExporter]")
+{
+    PresetBank bank;
+    bank.add ("First", makeSweepProgramState (0));
+    bank.add ("Second", makeSweepProgramState (50));
+
+    SECTION("Raw dump holds one complete CC per parameter")
+    {
+        juce::MemoryOutputStream stream;
+        {
+            ProgramExporter exporter (stream, ProgramExporter::Format::rawDump);
+            exporter.writeBank (bank);
+            REQUIRE(exporter.finish());
+        }
+
+        REQUIRE(stream.getDataSize() == bank.size() * numParameters * 3);
+        auto* bytes = static_cast<const uint8_t*> (stream.getData());
+        for (size_t preset = 0; preset < bank.size(); ++preset)
+        {
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                auto* message = bytes + (preset * numParameters + i) * 3;
+                REQUIRE(message[0] == 0xB0 + MIDI_CHANNEL - 1);
+                REQUIRE(message[1] == parameterDefinitions[i].cc);
+                REQUIRE(message[2] == bank.getState (preset)[i]);
+            }
+        }
+    }
+
+    SECTION("MIDI file can be read back")
+    {
+        juce::MemoryOutputStream stream;
+        {
+            ProgramExporter exporter (stream, ProgramExporter::Format::standardMidiFile);
+            exporter.writeBank (bank);
+            REQUIRE(exporter.finish());
+        }
+
+        juce::MemoryInputStream input (stream.getData(), stream.getDataSize(), false);
+        juce::MidiFile midiFile;
+        REQUIRE(midiFile.readFrom (input));
+        REQUIRE(midiFile.getNumTracks() == 1);
+        REQUIRE(midiFile.getTimeFormat() == ProgramExporter::ticksPerQuarterNote);
+
+        // Collect markers and CCs
+        juce::StringArray markers;
+        std::vector<juce::MidiMessage> ccs;
+        const auto* track = midiFile.getTrack (0);
+        for (const auto* event : *track)
+        {
+            if (event->message.isTextMetaEvent() && event->message.getMetaEventType() == 0x06)
+                markers.add (event->message.getTextFromTextMetaEvent());
+            if (event->message.isController())
+                ccs.push_back (event->message);
+        }
+
+        REQUIRE(markers == juce::StringArray ("First", "Second"));
+        REQUIRE(ccs.size() == bank.size() * numParameters);
+        for (size_t preset = 0; preset < bank.size(); ++preset)
+        {
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                const auto& message = ccs[preset * numParameters + i];
+                REQUIRE(message.getChannel() == MIDI_CHANNEL);
+                REQUIRE(message.getControllerNumber() == parameterDefinitions[i].cc);
+                REQUIRE(message.getControllerValue() == bank.getState (preset)[i]);
+            }
+        }
+
+        // Second program starts one bar later
+        REQUIRE(ccs.back().getTimeStamp() == ProgramExporter::ticksBetweenPrograms);
+    }
+
+    SECTION("Exporting a bank to a file")
+    {
+        auto file = juce::File::createTempFile (".mid");
+        REQUIRE(ProgramExporter::exportBank (bank, file, ProgramExporter::Format::standardMidiFile));
+        REQUIRE(file.getSize() > 0);
+        file.deleteFile();
+    }
+}
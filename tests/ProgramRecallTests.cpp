@@ -0,0 +1,199 @@
+#include "helpers/test_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+
+// Runs the recall refresh until the build on the executor is published
+static bool waitForRecall (ProgrammerProcessor& processor, VirtualScheduler& scheduler)
+{
+    for (int i = 0; i < 2000 && ! processor.isRecallUpToDate(); ++i)
+    {
+        scheduler.advance (ProgrammerProcessor::recallRefreshIntervalMs);
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    }
+    return processor.isRecallUpToDate();
+}
+
+TEST_CASE("ProgramRecall functionality", "[ProgramRecall]")
+{
+    const auto basis = ProgramState::defaults();
+    const std::vector<ProgramState> presets { makeProgramState (10, 0), makeProgramState (20, 1), basis };
+
+    SECTION("Bursts only hold the CCs which differ from the basis")
+    {
+        ProgramRecall::Table table;
+        REQUIRE(ProgramRecall::build (table, nullptr, presets, basis) == 3);
+        REQUIRE(table.numPresets == 3);
+
+        const auto* burst = table.getBurst (1, basis);
+        REQUIRE(burst != nullptr);
+        REQUIRE(burst->numCcs == 2);
+        REQUIRE(burst->ccs[0].index == 0);
+        REQUIRE(burst->ccs[0].value == 1);
+        REQUIRE(burst->ccs[1].index == 3);
+        REQUIRE(burst->ccs[1].value == 20);
+
+        REQUIRE(table.getBurst (2, basis)->numCcs == 0);
+        REQUIRE(table.getBurst (3, basis) == nullptr);
+    }
+
+    SECTION("A device which moved away from the basis gets the full program")
+    {
+        ProgramRecall::Table table;
+        ProgramRecall::build (table, nullptr, presets, basis);
+
+        const auto* burst = table.getBurst (0, makeProgramState (99, 1));
+        REQUIRE(burst->numCcs == numParameters);
+        REQUIRE(burst->ccs[3].value == 10);
+    }
+
+    SECTION("Unchanged slots are reused")
+    {
+        ProgramRecall::Table first;
+        ProgramRecall::build (first, nullptr, presets, basis);
+
+        auto changed = presets;
+        changed[1] = makeProgramState (30, 1);
+        ProgramRecall::Table second;
+        REQUIRE(ProgramRecall::build (second, &first, changed, basis) == 1);
+        REQUIRE(second.getBurst (1, basis)->ccs[1].value == 30);
+
+        // A new basis changes every diff
+        ProgramRecall::Table third;
+        REQUIRE(ProgramRecall::build (third, &second, changed, makeProgramState (10, 0)) == 3);
+        REQUIRE(third.getBurst (0, makeProgramState (10, 0))->numCcs == 0);
+    }
+
+    SECTION("Only the first 128 presets get a slot")
+    {
+        ProgramRecall::Table table;
+        ProgramRecall::build (table, nullptr, std::vector<ProgramState> (200, basis), basis);
+        REQUIRE(table.numPresets == ProgramRecall::numSlots);
+    }
+}
+
+TEST_CASE("Program changes recall presets in processBlock", "[ProgramRecall]")
+{
+    ProgrammerProcessor processor;
+    auto& scheduler = useVirtualTime (processor);
+    processor.prepareToPlay (48000, 512);
+    juce::AudioBuffer<float> buffer (2, 512);
+    juce::MidiBuffer midi;
+
+    PresetBank bank;
+    bank.add ("First", makeProgramState (10, 0));
+    bank.add ("Second", makeProgramState (20, 1));
+    processor.setRecallBank (bank);
+    REQUIRE(waitForRecall (processor, scheduler));
+
+    SECTION("Only the differing CCs are sent, at the program change, which isn't passed through")
+    {
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 1), 100);
+        processor.processBlock (buffer, midi);
+
+        REQUIRE(midi.getNumEvents() == 2);
+        for (const auto metadata : midi)
+        {
+            REQUIRE(metadata.getMessage().isController());
+            REQUIRE(metadata.samplePosition == 100);
+        }
+        REQUIRE(processor.parameterState.getSnapshot() == makeProgramState (20, 1));
+    }
+
+    SECTION("The bursts follow the device state")
+    {
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 1), 0);
+        processor.processBlock (buffer, midi);
+        REQUIRE_FALSE(processor.isRecallUpToDate());
+        REQUIRE(waitForRecall (processor, scheduler));
+
+        // From preset 1 to 0 is two CCs again, against the new device state
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 0), 0);
+        processor.processBlock (buffer, midi);
+        REQUIRE(midi.getNumEvents() == 2);
+        REQUIRE(processor.parameterState.getSnapshot() == makeProgramState (10, 0));
+    }
+
+    SECTION("Before the bursts are rebuilt, the full program is sent")
+    {
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 1), 0);
+        processor.processBlock (buffer, midi);
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 0), 0);
+        processor.processBlock (buffer, midi);
+        REQUIRE(midi.getNumEvents() == static_cast<int> (numParameters));
+        REQUIRE(processor.parameterState.getSnapshot() == makeProgramState (10, 0));
+    }
+
+    SECTION("Empty slots and other channels are ignored, and passed through")
+    {
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 5), 0);
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL + 1, 1), 0);
+        processor.processBlock (buffer, midi);
+        REQUIRE(midi.getNumEvents() == 2);
+        REQUIRE(processor.parameterState.getSnapshot() == ProgramState::defaults());
+    }
+
+    SECTION("The bank is saved with the plugin state")
+    {
+        juce::MemoryBlock stateData;
+        processor.getStateInformation (stateData);
+
+        ProgrammerProcessor reloaded;
+        auto& reloadedScheduler = useVirtualTime (reloaded);
+        reloaded.prepareToPlay (48000, 512);
+        reloaded.setStateInformation (stateData.getData(), static_cast<int> (stateData.getSize()));
+        REQUIRE(reloaded.getRecallBank().size() == 2);
+        REQUIRE(reloaded.getRecallBank().getName (1) == "Second");
+        REQUIRE(reloaded.getRecallBank().getStates() == bank.getStates());
+        REQUIRE(waitForRecall (reloaded, reloadedScheduler));
+
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 1), 0);
+        reloaded.processBlock (buffer, midi);
+        REQUIRE(reloaded.parameterState.getSnapshot() == makeProgramState (20, 1));
+    }
+
+    SECTION("An empty bank switches recall off")
+    {
+        processor.setRecallBank ({});
+        REQUIRE(waitForRecall (processor, scheduler));
+
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 1), 0);
+        processor.processBlock (buffer, midi);
+        REQUIRE(midi.getNumEvents() == 1);
+        REQUIRE(processor.parameterState.getSnapshot() == ProgramState::defaults());
+    }
+}
+
+TEST_CASE("Program changes before the first bursts are built pass through", "[ProgramRecall]")
+{
+    ProgrammerProcessor processor;
+    auto& scheduler = useVirtualTime (processor);
+    processor.prepareToPlay (48000, 512);
+    juce::AudioBuffer<float> buffer (2, 512);
+    juce::MidiBuffer midi;
+
+    PresetBank bank;
+    bank.add ("First", makeProgramState (10, 0));
+    processor.setRecallBank (bank);
+
+    // Not published yet, so nothing is recalled, and the Program Change isn't lost
+    midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 0), 0);
+    processor.processBlock (buffer, midi);
+    REQUIRE(midi.getNumEvents() == 1);
+    REQUIRE((*midi.begin()).getMessage().isProgramChange());
+    REQUIRE(processor.parameterState.getSnapshot() == ProgramState::defaults());
+
+    // Nor recalled later on
+    midi.clear();
+    REQUIRE(waitForRecall (processor, scheduler));
+    processor.processBlock (buffer, midi);
+    REQUIRE(midi.isEmpty());
+
+    // Once published, it's recalled
+    midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 0), 0);
+    processor.processBlock (buffer, midi);
+    REQUIRE(midi.getNumEvents() == 1);
+    REQUIRE(processor.parameterState.getSnapshot() == makeProgramState (10, 0));
+}
@@ -0,0 +1,94 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("RealtimeWatchdog functionality", "[RealtimeWatchdog]")
+{
+    SECTION("SpinLock locks like a juce::SpinLock")
+    {
+        RealtimeWatchdog::SpinLock spinLock { "Test" };
+        {
+            const RealtimeWatchdog::SpinLock::ScopedLockType lock (spinLock);
+            const RealtimeWatchdog::SpinLock::ScopedTryLockType tryLock (spinLock);
+            REQUIRE_FALSE(tryLock.isLocked());
+        }
+        const RealtimeWatchdog::SpinLock::ScopedTryLockType tryLock (spinLock);
+        REQUIRE(tryLock.isLocked());
+    }
+
+#if PROGRAMMER_REALTIME_WATCHDOG
+    // Nothing is asserted inside a ScopedAudioThread, as Catch may allocate
+
+    SECTION("Hazards outside of the audio thread are ignored")
+    {
+        const auto before = RealtimeWatchdog::getNumReports();
+        delete new int (1);
+        REALTIME_WATCHDOG_BLOCKING_CALL ("Test");
+        REQUIRE(RealtimeWatchdog::getNumReports() == before);
+    }
+
+    SECTION("Allocations, locks and blocking calls on the audio thread are reported")
+    {
+        const auto allocations = RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::allocation);
+        const auto locks = RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::lock);
+        const auto blockingCalls = RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::blockingCall);
+
+        RealtimeWatchdog::SpinLock spinLock { "TestLock" };
+        {
+            const RealtimeWatchdog::ScopedAudioThread audioThread;
+            delete new int (1);
+            {
+                const RealtimeWatchdog::SpinLock::ScopedTryLockType tryLock (spinLock);
+            }
+            {
+                const RealtimeWatchdog::SpinLock::ScopedLockType lock (spinLock);
+            }
+            REALTIME_WATCHDOG_BLOCKING_CALL ("Test");
+        }
+
+        // new + delete, and only the blocking lock
+        REQUIRE(RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::allocation) == allocations + 2);
+        REQUIRE(RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::lock) == locks + 1);
+        REQUIRE(RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::blockingCall) == blockingCalls + 1);
+        REQUIRE(RealtimeWatchdog::getReport().find ("lock: TestLock") != std::string::npos);
+    }
+
+    SECTION("Logging on the audio thread is reported")
+    {
+        RealtimeWatchdog::installLogger();
+        const juce::String message ("Logged from the audio thread");
+        const auto before = RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::logging);
+        {
+            const RealtimeWatchdog::ScopedAudioThread audioThread;
+            juce::Logger::writeToLog (message);
+        }
+        REQUIRE(RealtimeWatchdog::getNumReports (RealtimeWatchdog::Hazard::logging) == before + 1);
+    }
+
+    SECTION("Steady state processBlock is hazard free")
+    {
+        ProgrammerProcessor processor;
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        midiBuffer.ensureSize (4096);
+        processor.prepareToPlay (48000, 512);
+        processor.processBlock (buffer, midiBuffer);
+        midiBuffer.clear();
+
+        processor.messageQueue->push (MidiEvent::controller (MIDI_CHANNEL, PORTAMENTO_CC, 10));
+        const auto before = RealtimeWatchdog::getNumReports();
+        for (int i = 0; i < 10; ++i)
+        {
+            processor.processBlock (buffer, midiBuffer);
+            midiBuffer.clear();
+        }
+        REQUIRE(RealtimeWatchdog::getNumReports() == before);
+    }
+#else
+    SECTION("Nothing is reported without the watchdog build")
+    {
+        const RealtimeWatchdog::ScopedAudioThread audioThread;
+        REALTIME_WATCHDOG_BLOCKING_CALL ("Test");
+        REQUIRE(RealtimeWatchdog::getNumReports() == 0);
+    }
+#endif
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/Scheduler.h"
+#include <vector>
+
+TEST_CASE("VirtualScheduler functionality", "[Scheduler]")
+{
+    VirtualScheduler scheduler;
+    std::vector<int> calls;
+
+    SECTION("Nothing runs until time is advanced")
+    {
+        scheduler.callEvery (10.0, [&] { calls.push_back (1); });
+        REQUIRE(calls.empty());
+        REQUIRE(scheduler.getTimeMs() == 0.0);
+
+        scheduler.advance (9.0);
+        REQUIRE(calls.empty());
+        scheduler.advance (1.0);
+        REQUIRE(calls.size() == 1);
+        REQUIRE(scheduler.getTimeMs() == 10.0);
+    }
+
+    SECTION("Callbacks run in time order, ties in the order they were scheduled")
+    {
+        scheduler.callEvery (20.0, [&] { calls.push_back (20); });
+        scheduler.callEvery (10.0, [&] { calls.push_back (10); });
+
+        scheduler.advance (40.0);
+        REQUIRE(calls == std::vector<int> { 10, 20, 10, 10, 20, 10 });
+    }
+
+    SECTION("The clock is at the due time during a callback")
+    {
+        std::vector<double> times;
+        scheduler.callEvery (2.5, [&] { times.push_back (scheduler.getTimeMs()); });
+        scheduler.advance (10.0);
+        REQUIRE(times == std::vector<double> { 2.5, 5.0, 7.5, 10.0 });
+    }
+
+    SECTION("Cancelled callbacks stop, also from within a callback")
+    {
+        const auto id = scheduler.callEvery (10.0, [&] { calls.push_back (1); });
+        int selfId = 0;
+        selfId = scheduler.callEvery (5.0, [&] {
+            calls.push_back (2);
+            scheduler.cancel (selfId);
+        });
+
+        scheduler.advance (10.0);
+        scheduler.cancel (id);
+        scheduler.advance (100.0);
+        REQUIRE(calls == std::vector<int> { 2, 1 });
+
+        // Unknown ids are ignored
+        scheduler.cancel (id);
+        scheduler.cancel (12345);
+    }
+
+    SECTION("Callbacks can schedule more callbacks")
+    {
+        scheduler.callEvery (10.0, [&] {
+            calls.push_back (1);
+            if (calls.size() == 1)
+                scheduler.callEvery (1.0, [&] { calls.push_back (2); });
+        });
+
+        scheduler.advance (12.0);
+        REQUIRE(calls == std::vector<int> { 1, 2, 2 });
+    }
+
+    SECTION("An hour of ticks in one call")
+    {
+        int numTicks = 0;
+        scheduler.callEvery (1000.0 / 60.0, [&] { ++numTicks; });
+        scheduler.advance (60.0 * 60.0 * 1000.0);
+        REQUIRE(numTicks == 60 * 60 * 60);
+    }
+}
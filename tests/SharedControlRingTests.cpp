@@ -0,0 +1,151 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("SharedControlRing functionality", "[SharedControlRing]")
+{
+    // Not the default name, so a running 0-Programmer isn't disturbed
+    const juce::String name ("/0-programmer-tests");
+    SharedControlRing server;
+    SharedControlRing client;
+    REQUIRE(server.create (name));
+    REQUIRE(client.open (name));
+
+    MidiEvent message;
+    ProgrammerShmMessage cc { PROGRAMMER_SHM_TYPE_CC, MIDI_CHANNEL, PORTAMENTO_CC, 64 };
+
+    SECTION("Messages pushed by the client are popped by the server")
+    {
+        REQUIRE(programmer_shm_push (client.getRing(), &cc));
+        REQUIRE(server.getNumReady() == 1);
+        REQUIRE(server.pop (message));
+        REQUIRE(message.isController());
+        REQUIRE(message.getChannel() == MIDI_CHANNEL);
+        REQUIRE(message.getControllerNumber() == PORTAMENTO_CC);
+        REQUIRE(message.getControllerValue() == 64);
+        REQUIRE_FALSE(server.pop (message));
+    }
+
+    SECTION("Invalid messages are skipped")
+    {
+        ProgrammerShmMessage badChannel { PROGRAMMER_SHM_TYPE_CC, 0, PORTAMENTO_CC, 64 };
+        ProgrammerShmMessage badValue { PROGRAMMER_SHM_TYPE_CC, MIDI_CHANNEL, PORTAMENTO_CC, 128 };
+        ProgrammerShmMessage badType { 7, MIDI_CHANNEL, PORTAMENTO_CC, 64 };
+        programmer_shm_push (client.getRing(), &badChannel);
+        programmer_shm_push (client.getRing(), &badValue);
+        programmer_shm_push (client.getRing(), &badType);
+        programmer_shm_push (client.getRing(), &cc);
+
+        REQUIRE(server.pop (message));
+        REQUIRE(message.getControllerValue() == 64);
+        REQUIRE(server.getNumInvalid() == 3);
+    }
+
+    SECTION("A full ring rejects pushes, and wraps around")
+    {
+        for (uint32_t i = 0; i < PROGRAMMER_SHM_CAPACITY; ++i)
+            REQUIRE(programmer_shm_push (client.getRing(), &cc));
+        REQUIRE_FALSE(programmer_shm_push (client.getRing(), &cc));
+
+        int numPopped = 0;
+        while (server.pop (message))
+            ++numPopped;
+        REQUIRE(numPopped == static_cast<int> (PROGRAMMER_SHM_CAPACITY));
+        REQUIRE(programmer_shm_push (client.getRing(), &cc));
+    }
+
+    SECTION("A corrupt write index is bounded and resynced")
+    {
+        // A client which writes garbage into the write index
+        auto* ring = client.getRing();
+        programmer_shm_store_release (&ring->writeIndex, ring->readIndex + 0x80000000u);
+        REQUIRE(server.getNumReady() == static_cast<int> (PROGRAMMER_SHM_CAPACITY));
+
+        auto budget = server.getNumReady();
+        REQUIRE_FALSE(server.pop (message, budget));
+        REQUIRE(server.getNumResyncs() == 1);
+        REQUIRE(server.getNumReady() == 0);
+
+        // Back to normal from the write index on
+        REQUIRE(programmer_shm_push (ring, &cc));
+        REQUIRE(server.pop (message));
+        REQUIRE(message.getControllerValue() == 64);
+    }
+
+    SECTION("Invalid records count against the budget")
+    {
+        ProgrammerShmMessage badType { 7, MIDI_CHANNEL, PORTAMENTO_CC, 64 };
+        for (int i = 0; i < 10; ++i)
+            programmer_shm_push (client.getRing(), &badType);
+        programmer_shm_push (client.getRing(), &cc);
+
+        auto budget = 5;
+        REQUIRE_FALSE(server.pop (message, budget));
+        REQUIRE(budget == 0);
+        REQUIRE(server.getNumReady() == 6);
+    }
+
+    SECTION("A second instance can't take over a live segment")
+    {
+        SharedControlRing second;
+        REQUIRE_FALSE(second.create (name));
+        second.close();
+
+        // The first instance's segment is untouched
+        REQUIRE(programmer_shm_push (client.getRing(), &cc));
+        REQUIRE(server.pop (message));
+        SharedControlRing lateClient;
+        REQUIRE(lateClient.open (name));
+    }
+
+   #if ! JUCE_WINDOWS
+    SECTION("A stale segment is replaced, and closing it leaves the new one")
+    {
+        // As if the owner crashed
+        server.getRing()->ownerPid = 0;
+
+        SharedControlRing second;
+        REQUIRE(second.create (name));
+        server.close();
+
+        SharedControlRing lateClient;
+        REQUIRE(lateClient.open (name));
+        REQUIRE(programmer_shm_push (lateClient.getRing(), &cc));
+        REQUIRE(second.pop (message));
+    }
+   #endif
+
+    SECTION("Clients can't attach once the server closed")
+    {
+        server.close();
+        SharedControlRing lateClient;
+        REQUIRE_FALSE(lateClient.open (name));
+    }
+
+    SECTION("processBlock drains the ring")
+    {
+        server.close();
+        client.close();
+
+        ProgrammerProcessor processor;
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midiBuffer;
+        processor.prepareToPlay (48000, 512);
+        REQUIRE(processor.startSharedControl (name));
+        REQUIRE(client.open (name));
+
+        cc.value3 = 100;
+        REQUIRE(programmer_shm_push (client.getRing(), &cc));
+        processor.processBlock (buffer, midiBuffer);
+
+        REQUIRE(midiBuffer.getNumEvents() == 1);
+        for (const auto metadata : midiBuffer)
+        {
+            const auto midiMessage = metadata.getMessage();
+            REQUIRE(midiMessage.getControllerNumber() == PORTAMENTO_CC);
+            REQUIRE(midiMessage.getControllerValue() == 100);
+        }
+
+        processor.stopSharedControl();
+        REQUIRE_FALSE(processor.isSharedControlActive());
+    }
+}
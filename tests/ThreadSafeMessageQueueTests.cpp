@@ -9,8 +9,8 @@ TEST_CASE("ThreadSafeMessageQueue functionality", "[ThreadSafeMessageQueue]")
 
     SECTION("Push and pop single message")
     {
-        GuiMessage messageToPush{GuiMessage::cc, 1, 2, 3};
-        GuiMessage messagePopped;
+        MidiEvent messageToPush = MidiEvent::controller(1, 2, 3);
+        MidiEvent messagePopped;
 
         REQUIRE(queue.push(messageToPush)); // Push should succeed
         REQUIRE(queue.getNumReady() == 1); // One message should be ready
@@ -19,15 +19,12 @@ TEST_CASE("ThreadSafeMessageQueue functionality", "[ThreadSafeMessageQueue]")
         REQUIRE(queue.getNumReady() == 0); // No messages should be left
 
         // Verify the message content
-        REQUIRE(messagePopped.type == messageToPush.type);
-        REQUIRE(messagePopped.value1 == messageToPush.value1);
-        REQUIRE(messagePopped.value2 == messageToPush.value2);
-        REQUIRE(messagePopped.value3 == messageToPush.value3);
+        REQUIRE(messagePopped == messageToPush);
     }
 
     SECTION("Push until full")
     {
-        GuiMessage messageToPush{GuiMessage::cc, 1, 2, 3};
+        MidiEvent messageToPush = MidiEvent::controller(1, 2, 3);
 
         // NOTE: Actual Capacity for AbstractFifo is capacity-1!
         for (int i = 0; i < capacity-1; ++i)
@@ -41,38 +38,61 @@ TEST_CASE("ThreadSafeMessageQueue functionality", "[ThreadSafeMessageQueue]")
 
     SECTION("Pop from empty queue")
     {
-        GuiMessage messagePopped;
+        MidiEvent messagePopped;
         REQUIRE_FALSE(queue.pop(messagePopped)); // Pop should fail when queue is empty
     }
 
     SECTION("Push and pop multiple messages")
     {
-        GuiMessage messageToPush1{GuiMessage::cc, 1, 2, 3};
-        GuiMessage messageToPush2{GuiMessage::cc, 4, 5, 6};
-        GuiMessage messagePopped;
+        MidiEvent messageToPush1 = MidiEvent::controller(1, 2, 3);
+        MidiEvent messageToPush2 = MidiEvent::controller(4, 5, 6);
+        MidiEvent messagePopped;
 
         REQUIRE(queue.push(messageToPush1)); // Push first message
         REQUIRE(queue.push(messageToPush2)); // Push second message
         REQUIRE(queue.getNumReady() == 2);   // Two messages should be ready
 
         REQUIRE(queue.pop(messagePopped)); // Pop first message
-        REQUIRE(messagePopped.type == messageToPush1.type);
-        REQUIRE(messagePopped.value1 == messageToPush1.value1);
-        REQUIRE(messagePopped.value2 == messageToPush1.value2);
-        REQUIRE(messagePopped.value3 == messageToPush1.value3);
+        REQUIRE(messagePopped == messageToPush1);
 
         REQUIRE(queue.pop(messagePopped)); // Pop second message
-        REQUIRE(messagePopped.type == messageToPush2.type);
-        REQUIRE(messagePopped.value1 == messageToPush2.value1);
-        REQUIRE(messagePopped.value2 == messageToPush2.value2);
-        REQUIRE(messagePopped.value3 == messageToPush2.value3);
+        REQUIRE(messagePopped == messageToPush2);
 
         REQUIRE(queue.getNumReady() == 0); // Queue should be empty
     }
 
+    SECTION("Sysex goes through the pool")
+    {
+        const uint8_t sysex[] = { 0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7 };
+        REQUIRE(queue.pushSysex(sysex, sizeof(sysex)));
+        REQUIRE(queue.getSysexPool().getNumInUse() == 1);
+
+        MidiEvent messagePopped;
+        REQUIRE(queue.pop(messagePopped));
+        REQUIRE(messagePopped.isSysex());
+        const auto slot = messagePopped.getSysexSlot();
+        REQUIRE(queue.getSysexPool().getSize(slot) == sizeof(sysex));
+        REQUIRE(std::memcmp(queue.getSysexPool().getData(slot), sysex, sizeof(sysex)) == 0);
+
+        queue.getSysexPool().release(slot);
+        REQUIRE(queue.getSysexPool().getNumInUse() == 0);
+    }
+
+    SECTION("Sysex doesn't keep a slot when the queue is full")
+    {
+        for (int i = 0; i < capacity-1; ++i)
+        {
+            REQUIRE(queue.push(MidiEvent::controller(1, 2, 3)));
+        }
+
+        const uint8_t sysex[] = { 0xF0, 0x01, 0xF7 };
+        REQUIRE_FALSE(queue.pushSysex(sysex, sizeof(sysex)));
+        REQUIRE(queue.getSysexPool().getNumInUse() == 0);
+    }
+
     SECTION("Concurrent push and pop")
     {
-        GuiMessage messageToPush{GuiMessage::cc, 1, 2, 3};
+        MidiEvent messageToPush = MidiEvent::controller(1, 2, 3);
         std::atomic<bool> producerDone{false};
         std::atomic<int> messagesPopped{0};
 
@@ -87,7 +107,7 @@ TEST_CASE("ThreadSafeMessageQueue functionality", "[ThreadSafeMessageQueue]")
 
         // Consumer thread
         std::thread consumer([&]() {
-            GuiMessage messagePopped;
+            MidiEvent messagePopped;
             while (!producerDone || queue.getNumReady() > 0)
             {
                 if (queue.pop(messagePopped))
@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../source/Trace.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Trace functionality", "[Trace]")
+{
+    SECTION("Spans compile in both build modes")
+    {
+        {
+            TRACE_SCOPE ("Test span");
+            TRACE_THREAD_NAME ("Test Thread");
+        }
+        REQUIRE(Trace::getNumDropped() == 0);
+    }
+
+#if PROGRAMMER_TRACING
+    SECTION("Spans are recorded per thread")
+    {
+        const auto before = Trace::getNumSpans();
+        {
+            TRACE_SCOPE ("Outer span");
+            TRACE_SCOPE ("Inner span");
+        }
+        std::thread other ([] {
+            TRACE_THREAD_NAME ("Other \"Thread\"");
+            TRACE_SCOPE ("Span on another thread");
+        });
+        other.join();
+        REQUIRE(Trace::getNumSpans() == before + 3);
+    }
+
+    SECTION("Threads hand their buffer back when they exit")
+    {
+        // More threads than buffers, one after the other
+        const auto droppedBefore = Trace::getNumDropped();
+        for (int i = 0; i < 64; ++i)
+        {
+            std::thread worker ([] { TRACE_SCOPE ("Short lived thread"); });
+            worker.join();
+        }
+        REQUIRE(Trace::getNumDropped() == droppedBefore);
+    }
+
+    SECTION("Reserved threads get a buffer while all others are taken")
+    {
+        // Workers which take every unreserved buffer, and keep them until released
+        std::atomic<bool> release { false };
+        std::atomic<int> numStarted { 0 };
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 40; ++i)
+        {
+            workers.emplace_back ([&] {
+                TRACE_THREAD_NAME ("Busy Worker");
+                { TRACE_SCOPE ("Worker span"); }
+                ++numStarted;
+                while (! release)
+                    std::this_thread::yield();
+            });
+        }
+        while (numStarted < 40)
+            std::this_thread::yield();
+
+        const auto droppedBefore = Trace::getNumDropped();
+        std::thread audio ([] {
+            TRACE_RESERVED_THREAD_NAME ("Reserved Thread");
+            TRACE_SCOPE ("Reserved span");
+        });
+        audio.join();
+        REQUIRE(Trace::getNumDropped() == droppedBefore);
+
+        release = true;
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    SECTION("Spans are written as Chrome trace JSON")
+    {
+        const auto start = Trace::now();
+        Trace::addSpan ("Manual span", start, start + 2000);
+        std::thread other ([] {
+            TRACE_THREAD_NAME ("Other \"Thread\"");
+            TRACE_SCOPE ("Span on another thread");
+        });
+        other.join();
+
+        const auto json = Trace::toJson();
+        REQUIRE(json.rfind ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+        REQUIRE(json.find ("{\"name\":\"Manual span\",\"ph\":\"X\"") != std::string::npos);
+        REQUIRE(json.find (",\"dur\":2.000,") != std::string::npos);
+        REQUIRE(json.find ("\"args\":{\"name\":\"Other \\\"Thread\\\"\"}") != std::string::npos);
+        REQUIRE(json.find ("\n],\"otherData\":{\"droppedSpans\":") != std::string::npos);
+        REQUIRE(json.substr (json.size() - 3) == "}}\n");
+    }
+
+    SECTION("A full buffer overwrites its oldest spans")
+    {
+        // Twice the size of a buffer, so only the newer half is kept
+        constexpr int spansPerThread = 1 << 15;
+        const auto overwrittenBefore = Trace::getNumOverwritten();
+        std::thread other ([] {
+            for (int i = 0; i < spansPerThread; ++i)
+                TRACE_SCOPE ("Old ring span");
+            for (int i = 0; i < spansPerThread; ++i)
+                TRACE_SCOPE ("New ring span");
+        });
+        other.join();
+
+        REQUIRE(Trace::getNumOverwritten() >= overwrittenBefore + spansPerThread);
+        const auto json = Trace::toJson();
+        REQUIRE(json.find ("\"New ring span\"") != std::string::npos);
+        REQUIRE(json.find ("\"Old ring span\"") == std::string::npos);
+    }
+#else
+    SECTION("Nothing is recorded without the build flag")
+    {
+        REQUIRE(Trace::getNumSpans() == 0);
+        REQUIRE(Trace::toJson().empty());
+        REQUIRE_FALSE(Trace::writeJson ("trace.json"));
+    }
+#endif
+}
@@ -0,0 +1,184 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include "../source/UndoHistory.h"
+
+TEST_CASE("PackedProgramState functionality", "[PackedProgramState]")
+{
+    SECTION("Pack and unpack round trip")
+    {
+        ProgramState state;
+        for (size_t i = 0; i < numParameters; ++i)
+            state[i] = static_cast<uint8_t> ((i * 37) % 128);
+
+        REQUIRE(PackedProgramState::pack(state).unpack() == state);
+    }
+
+    SECTION("Extreme values")
+    {
+        ProgramState state;
+        state.values.fill(127);
+        REQUIRE(PackedProgramState::pack(state).unpack() == state);
+        state.values.fill(0);
+        REQUIRE(PackedProgramState::pack(state).unpack() == state);
+    }
+}
+
+TEST_CASE("UndoHistory functionality", "[UndoHistory]")
+{
+    UndoHistory history(8);
+    ProgramState state;
+
+    SECTION("Nothing to undo or redo initially")
+    {
+        REQUIRE_FALSE(history.canUndo());
+        REQUIRE_FALSE(history.canRedo());
+        REQUIRE_FALSE(history.undo(state));
+        REQUIRE_FALSE(history.redo(state));
+        REQUIRE(history.getCurrent() == ProgramState::defaults());
+    }
+
+    SECTION("Undo and redo a single step")
+    {
+        history.push(makeProgramState(10));
+        REQUIRE(history.getCurrent() == makeProgramState(10));
+
+        REQUIRE(history.undo(state));
+        REQUIRE(state == ProgramState::defaults());
+        REQUIRE(history.getCurrent() == ProgramState::defaults());
+
+        REQUIRE(history.redo(state));
+        REQUIRE(state == makeProgramState(10));
+        REQUIRE_FALSE(history.canRedo());
+    }
+
+    SECTION("Pushing after undo discards the redo steps")
+    {
+        history.push(makeProgramState(10));
+        history.push(makeProgramState(20));
+        REQUIRE(history.undo(state));
+        REQUIRE(state == makeProgramState(10));
+
+        history.push(makeProgramState(30));
+        REQUIRE_FALSE(history.canRedo());
+        REQUIRE(history.getNumSteps() == 3);
+
+        REQUIRE(history.undo(state));
+        REQUIRE(state == makeProgramState(10));
+    }
+
+    SECTION("Full ring drops the oldest steps")
+    {
+        // Capacity is 8 changes and every step changes one parameter, so pushing
+        // 20 steps keeps the last 8
+        for (uint8_t i = 1; i <= 20; ++i)
+            history.push(makeProgramState(i));
+
+        REQUIRE(history.getNumSteps() == history.getCapacity() + 1);
+
+        int numUndos = 0;
+        while (history.undo(state))
+            ++numUndos;
+
+        REQUIRE(numUndos == 8);
+        REQUIRE(state == makeProgramState(12));
+    }
+
+    SECTION("A step changing several parameters is undone and redone at once")
+    {
+        auto edited = makeProgramState(10);
+        edited[parameterIndex(PORTAMENTO_NAME) + 1] ^= 1;
+        history.push(edited);
+        REQUIRE(history.getNumSteps() == 2);
+
+        REQUIRE(history.undo(state));
+        REQUIRE(state == ProgramState::defaults());
+        REQUIRE_FALSE(history.canUndo());
+
+        REQUIRE(history.redo(state));
+        REQUIRE(state == edited);
+    }
+
+    SECTION("Dropping a step for room keeps whole steps")
+    {
+        // 3 single-change steps, then a 7 change step needs room for 7 of the 8 changes
+        for (uint8_t i = 1; i <= 3; ++i)
+            history.push(makeProgramState(i));
+
+        auto big = makeProgramState(3);
+        for (size_t i = 0, numChanged = 0; numChanged < 7; ++i)
+        {
+            if (i == parameterIndex(PORTAMENTO_NAME))
+                continue;
+            big[i] ^= 1;
+            ++numChanged;
+        }
+        history.push(big);
+
+        // Steps 1 and 2 were dropped
+        REQUIRE(history.getNumSteps() == 3);
+        REQUIRE(history.undo(state));
+        REQUIRE(state == makeProgramState(3));
+        REQUIRE(history.undo(state));
+        REQUIRE(state == makeProgramState(2));
+        REQUIRE_FALSE(history.undo(state));
+    }
+
+    SECTION("A step larger than the ring resets the history")
+    {
+        ProgramState everything = ProgramState::defaults();
+        for (size_t i = 0; i < numParameters; ++i)
+            everything[i] ^= 1;
+
+        history.push(makeProgramState(10));
+        history.push(everything);
+        REQUIRE_FALSE(history.canUndo());
+        REQUIRE(history.getCurrent() == everything);
+    }
+
+    SECTION("Pushing the current state records nothing")
+    {
+        history.push(makeProgramState(10));
+        history.push(makeProgramState(10));
+        REQUIRE(history.getNumSteps() == 2);
+    }
+
+    SECTION("Default history keeps its maximum depth in a few kilobytes")
+    {
+        UndoHistory defaultHistory;
+        REQUIRE(defaultHistory.getCapacity() * 3 <= 6 * 1024);
+        REQUIRE(defaultHistory.getMaxSteps() == 1000);
+
+        for (int i = 0; i < 3000; ++i)
+            defaultHistory.push(makeProgramState(static_cast<uint8_t>(i % 2 == 0 ? 1 : 2)));
+        REQUIRE(defaultHistory.getNumSteps() == defaultHistory.getMaxSteps() + 1);
+    }
+
+    SECTION("Steps beyond the maximum depth drop the oldest")
+    {
+        UndoHistory shallowHistory(8, 3);
+        for (uint8_t i = 1; i <= 5; ++i)
+            shallowHistory.push(makeProgramState(i));
+        REQUIRE(shallowHistory.getNumSteps() == 4);
+
+        // Undoing and pushing again doesn't count the dropped redo steps
+        REQUIRE(shallowHistory.undo(state));
+        REQUIRE(shallowHistory.undo(state));
+        shallowHistory.push(makeProgramState(10));
+        REQUIRE(shallowHistory.getNumSteps() == 3);
+
+        int numUndos = 0;
+        while (shallowHistory.undo(state))
+            ++numUndos;
+
+        REQUIRE(numUndos == 2);
+        REQUIRE(state == makeProgramState(2));
+    }
+
+    SECTION("Reset clears the history")
+    {
+        history.push(makeProgramState(10));
+        history.reset(makeProgramState(50));
+        REQUIRE_FALSE(history.canUndo());
+        REQUIRE(history.getCurrent() == makeProgramState(50));
+    }
+}
@@ -0,0 +1,138 @@
+#include "helpers/test_helpers.h"
+#include <catch2/catch_test_macros.hpp>
+#include "../source/ZeroCoastSimulator.h"
+#include <cmath>
+
+static bool isAbout (double time, double expected)
+{
+    return std::abs (time - expected) < 1e-9;
+}
+
+TEST_CASE("ZeroCoastSimulator functionality", "[ZeroCoastSimulator]")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480; // 10ms
+
+    SECTION("Starts in the default state")
+    {
+        ZeroCoastSimulator device;
+        REQUIRE(device.getState() == ProgramState::defaults());
+        REQUIRE(device.isIdle());
+    }
+
+    SECTION("A CC takes three bytes on the wire")
+    {
+        ZeroCoastSimulator device;
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, PORTAMENTO_CC, 64), 0);
+        device.processBlock (midi, blockSize, sampleRate);
+
+        REQUIRE(device.getState()[3] == 64);
+        REQUIRE(device.getNumBytesReceived() == 3);
+        REQUIRE(isAbout (device.getLastByteTimeMs(), 3 * ZeroCoastSimulator::byteTimeMs));
+    }
+
+    SECTION("Events go on the wire at their sample position")
+    {
+        ZeroCoastSimulator device;
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, PORTAMENTO_CC, 64), 240);
+        device.processBlock (midi, blockSize, sampleRate);
+        REQUIRE(isAbout (device.getLastByteTimeMs(), 5.0 + 3 * ZeroCoastSimulator::byteTimeMs));
+    }
+
+    SECTION("A whole program burst uses running status")
+    {
+        const auto state = makeSweepProgramState (1);
+        ZeroCoastSimulator device;
+        device.processBlock (makeProgramBurst (state), blockSize, sampleRate);
+        device.flush();
+
+        REQUIRE(device.getState() == state);
+        REQUIRE(device.getNumCcsApplied() == numParameters);
+        REQUIRE(device.getNumBytesReceived() == 3 + 2 * (numParameters - 1));
+        REQUIRE(isAbout (device.getLastByteTimeMs(), static_cast<double> (3 + 2 * (numParameters - 1)) * ZeroCoastSimulator::byteTimeMs));
+    }
+
+    SECTION("Without running status, every CC takes three bytes")
+    {
+        ZeroCoastSimulator::Config config;
+        config.useRunningStatus = false;
+        ZeroCoastSimulator device (config);
+        device.processBlock (makeProgramBurst (makeSweepProgramState (1)), blockSize, sampleRate);
+        device.flush();
+        REQUIRE(device.getNumBytesReceived() == 3 * numParameters);
+    }
+
+    SECTION("Bursts longer than a block keep going in the next blocks")
+    {
+        ZeroCoastSimulator device;
+        juce::MidiBuffer midi;
+        for (int i = 0; i < 100; ++i)
+            midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, PORTAMENTO_CC, i), 0);
+
+        // 201 bytes take 64.3ms
+        device.processBlock (midi, blockSize, sampleRate);
+        REQUIRE_FALSE(device.isIdle());
+        REQUIRE(device.getState()[3] < 99);
+
+        midi.clear();
+        for (int block = 0; block < 6; ++block)
+            device.processBlock (midi, blockSize, sampleRate);
+        REQUIRE(device.isIdle());
+        REQUIRE(device.getState()[3] == 99);
+    }
+
+    SECTION("Values are clamped, other channels and CCs are ignored")
+    {
+        ZeroCoastSimulator device;
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, ENABLE_ARP_CC, 127), 0);
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL + 1, PORTAMENTO_CC, 64), 0);
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, 1, 64), 0);
+        midi.addEvent (juce::MidiMessage::programChange (MIDI_CHANNEL, 3), 0);
+        device.processBlock (midi, blockSize, sampleRate);
+
+        REQUIRE(device.getState()[0] == ENABLE_ARP_MAX_VALUE);
+        REQUIRE(device.getState()[3] == PORTAMENTO_VALUE);
+        REQUIRE(device.getNumMessages() == 4);
+        REQUIRE(device.getNumIgnored() == 3);
+    }
+
+    SECTION("Realtime bytes don't break running status")
+    {
+        ZeroCoastSimulator device;
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, PORTAMENTO_CC, 10), 0);
+        midi.addEvent (juce::MidiMessage::midiClock(), 0);
+        midi.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, PORTAMENTO_CC, 20), 0);
+        device.processBlock (midi, blockSize, sampleRate);
+
+        REQUIRE(device.getNumBytesReceived() == 6);
+        REQUIRE(device.getState()[3] == 20);
+    }
+
+    SECTION("A slow device loses bytes when its buffer is full")
+    {
+        ZeroCoastSimulator::Config config;
+        config.receiveBufferSize = 8;
+        config.processingTimeMs = 2.0;
+        ZeroCoastSimulator device (config);
+        device.processBlock (makeProgramBurst (makeSweepProgramState (1)), blockSize, sampleRate);
+        device.flush();
+
+        REQUIRE(device.getNumBytesLost() > 0);
+        REQUIRE(device.getReceiveBufferPeak() == 8);
+        REQUIRE(device.getState() != makeSweepProgramState (1));
+    }
+
+    SECTION("A device which keeps up never needs more than a byte of buffer")
+    {
+        ZeroCoastSimulator device;
+        device.processBlock (makeProgramBurst (makeSweepProgramState (1)), blockSize, sampleRate);
+        device.flush();
+        REQUIRE(device.getState() == makeSweepProgramState (1));
+        REQUIRE(device.getNumBytesLost() == 0);
+        REQUIRE(device.getReceiveBufferPeak() == 1);
+    }
+}
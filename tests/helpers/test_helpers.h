@@ -1,5 +1,6 @@
 #pragma once
 #include <PluginProcessor.h>
+#include <random>
 
 /* This is a helper function to run tests within the context of a plugin editor.
  *
@@ -29,3 +30,74 @@
     plugin.editorBeingDeleted (editor);
     delete editor;
 }
+
+/* Switches the processor to virtual time. Call it before creating an editor, then
+ * run editor ticks (and anything else on the scheduler) with advance(), ie.
+ *
+  auto& scheduler = useVirtualTime (plugin);
+  ProgrammerEditor editor (plugin);
+  scheduler.advance (ProgrammerEditor::tickIntervalMs);
+
+ */
+[[maybe_unused]] static VirtualScheduler& useVirtualTime (ProgrammerProcessor& plugin)
+{
+    auto scheduler = std::make_unique<VirtualScheduler>();
+    auto& virtualScheduler = *scheduler;
+    plugin.setScheduler (std::move (scheduler));
+    return virtualScheduler;
+}
+
+/* A program state with the default value for every parameter but portamento (and
+ * optionally the arpeggiator), ie. to tell states apart in history, preset and recall
+ * tests.
+ */
+[[maybe_unused]] static ProgramState makeProgramState (uint8_t portamento, uint8_t arp = ENABLE_ARP_VALUE)
+{
+    auto state = ProgramState::defaults();
+    state[parameterIndex (PORTAMENTO_NAME)] = portamento;
+    state[parameterIndex (ENABLE_ARP_NAME)] = arp;
+    return state;
+}
+
+/* A program state with every parameter set to offset + its index, wrapped into the
+ * parameter's range. Each offset gives another state, ie. for bursts and exports.
+ */
+[[maybe_unused]] static ProgramState makeSweepProgramState (int offset)
+{
+    auto state = ProgramState::defaults();
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        const auto& definition = parameterDefinitions[i];
+        state[i] = static_cast<uint8_t> (definition.minValue + (offset + static_cast<int> (i)) % (definition.maxValue - definition.minValue + 1));
+    }
+    return state;
+}
+
+/* A CC for every parameter of the state in one block, like processBlock sends a
+ * preset load.
+ */
+[[maybe_unused]] static juce::MidiBuffer makeProgramBurst (const ProgramState& state)
+{
+    juce::MidiBuffer burst;
+    for (size_t i = 0; i < numParameters; ++i)
+        burst.addEvent (juce::MidiMessage::controllerEvent (MIDI_CHANNEL, parameterDefinitions[i].cc, state[i]), 0);
+    return burst;
+}
+
+/* A library of random program states, every value within its parameter's range. The
+ * same seed always gives the same library, so failures can be reproduced.
+ */
+[[maybe_unused]] static std::vector<ProgramState> makeRandomProgramStates (size_t numStates, unsigned int seed = 1234)
+{
+    std::mt19937 random (seed);
+    std::vector<ProgramState> states (numStates);
+    for (auto& state : states)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            std::uniform_int_distribution<int> distribution (parameterDefinitions[i].minValue, parameterDefinitions[i].maxValue);
+            state[i] = static_cast<uint8_t> (distribution (random));
+        }
+    }
+    return states;
+}